@@ -29,9 +29,16 @@
 #include <cstdlib>
 #include <cmath> 
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <vector>
+#include <array>
+#include <list>
 #include <map>
+#include <unordered_map>
+#include <memory>
+#include <new>
+#include <tuple>
 #include <algorithm>
 #include <chrono>
 #include <iostream>
@@ -40,6 +47,19 @@
 #include <thread>
 #include <future>
 #include <mutex> 
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <climits>
+#include <cfloat>
+
+// SIMD intrinsics used by the software blend kernels (MSVC on x86/x64 only)
+// > MSVC lets the AVX2 kernels be compiled without target attributes, and they are only called once DetectSimdLevel has found AVX2
+#if defined(_M_X64) || defined(_M_IX86)
+#define PLAY_SIMD_X86
+#include <intrin.h>
+#include <immintrin.h>
+#endif
 
 // Exclude rarely-used content from the Windows headers
 #ifndef WIN32_LEAN_AND_MEAN
@@ -875,12 +895,25 @@ namespace Play
 	const Pixel PIX_GREY{ 0x80, 0x80, 0x80 };
 	const Pixel PIX_TRANS{ 0x00, 0x00, 0x00, 0x00 };
 
+	// The ways the pixels of a PixelData can be stored
+	enum PixelFormat
+	{
+		PIXEL_ARGB8888 = 0, // 32 bits per pixel: alpha<<24 | red<<16 | green<<8 | blue
+		PIXEL_RGB565, // 16 bits per pixel: red<<11 | green<<5 | blue (two to each Pixel of storage), which can be drawn into but not drawn from
+	};
+
+	inline int GetBytesPerPixel( PixelFormat format )
+	{
+		return format == PIXEL_RGB565 ? 2 : 4;
+	}
+
 	struct PixelData
 	{
 		int width{ 0 };
 		int height{ 0 };
 		Pixel* pPixels{ nullptr };
 		bool preMultiplied = false;
+		PixelFormat format{ PIXEL_ARGB8888 };
 	};
 
 	struct BlendColour
@@ -917,7 +950,7 @@ namespace Play
 // File:		PlayWindow.h
 // Description:	Platform specific code to provide a window to draw into
 // Platform:	Windows
-// Notes:		Uses a 32-bit ARGB display buffer
+// Notes:		Uses a 32-bit ARGB or 16-bit RGB565 display buffer
 //********************************************************************************************************************************
 
 // The target frame rate
@@ -949,6 +982,9 @@ namespace Play::Window
 	// Copies the display buffer pixels to the window
 	// > Returns the time taken for the present in seconds
 	double Present();
+	// Copies only the given rectangles of the display buffer (in pixels from the top left) to the window
+	// > The whole buffer is copied if the window needs repainting
+	double PresentRects( const RECT* pRects, int numRects );
 	// Sets the pointer to write mouse input data to
 	void RegisterMouse(Play::MouseData* pMouseData);
 
@@ -983,7 +1019,25 @@ int SavePNGImage( std::string& fileAndPath, const Play::PixelData& sourceImage )
 //********************************************************************************************************************************
 namespace Play::Render
 {
-	// The pre-multiplied alpha buffers store the number of subsequent pixels which are also transparent 
+	// The instruction sets which the blend policies can use to process a row of pixels
+	enum class SimdLevel
+	{
+		SCALAR = 0,
+		SSE2,
+		AVX2,
+	};
+
+	// Returns the best instruction set supported by the processor
+	SimdLevel DetectSimdLevel();
+	// Returns the instruction set currently used by the row blending functions
+	SimdLevel GetSimdLevel();
+	// Restricts the instruction set used by the row blending functions (e.g. SCALAR for reference output)
+	// > Requests for an instruction set the processor doesn't support fall back to the best supported one
+	void SetSimdLevel( SimdLevel level );
+
+	extern SimdLevel m_simdLevel;
+
+	// The pre-multiplied alpha buffers store the number of subsequent pixels which are also transparent
 	// so they can be skipped. This works for any blend mode which uses the pre-multiplied alpha buffer. 
 	inline void Skip(uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd)
 	{
@@ -996,6 +1050,75 @@ namespace Play::Render
 		++destPixels += skip;
 	}
 
+	// Which parts of a global multiply actually change anything, so that blend functions can leave out the others at compile time
+	enum class MultiplyType
+	{
+		ALPHA = 0,	// A global alpha, with every colour multiplied by the same amount of 1 or less (e.g. fading out)
+		TINT,		// Colours multiplied by different amounts, with no global alpha (e.g. a hit flash)
+		TINT_ALPHA,	// Both of the above at once
+	};
+
+	// A global multiply converted into integers once per draw, so that the blend functions don't need any floating point arithmetic
+	// > The default values are the same as a { 1, 1, 1, 1 } global multiply
+	struct BlendFactors
+	{
+		uint32_t alpha{ 0xFF };		// The global alpha out of 255
+		uint32_t red{ 0x100 };		// Each colour multiplied by the global alpha, in 8.8 fixed point
+		uint32_t green{ 0x100 };
+		uint32_t blue{ 0x100 };
+		uint32_t redTint{ 0x100 };	// Each colour on its own, in 8.8 fixed point
+		uint32_t greenTint{ 0x100 };
+		uint32_t blueTint{ 0x100 };
+		MultiplyType type{ MultiplyType::TINT };
+		bool inRange{ true };		// Every multiplier is in the range 0-1, which the vector versions need for their products to fit into 16 bits
+	};
+
+	// Converts a global multiply into fixed point blend factors
+	inline BlendFactors GetBlendFactors( BlendColour globalMultiply )
+	{
+		auto toInteger = []( float value, float scale, float limit ) { return static_cast<uint32_t>( std::clamp( ( value * scale ) + 0.5f, 0.0f, limit ) ); };
+
+		BlendFactors factors;
+		factors.alpha = toInteger( globalMultiply.alpha, 255.0f, 255.0f );
+		factors.red = toInteger( globalMultiply.alpha * globalMultiply.red, 256.0f, 65535.0f );
+		factors.green = toInteger( globalMultiply.alpha * globalMultiply.green, 256.0f, 65535.0f );
+		factors.blue = toInteger( globalMultiply.alpha * globalMultiply.blue, 256.0f, 65535.0f );
+		factors.redTint = toInteger( globalMultiply.red, 256.0f, 65535.0f );
+		factors.greenTint = toInteger( globalMultiply.green, 256.0f, 65535.0f );
+		factors.blueTint = toInteger( globalMultiply.blue, 256.0f, 65535.0f );
+
+		if( factors.alpha == 0xFF )
+			factors.type = MultiplyType::TINT;
+		else if( factors.red == factors.green && factors.red == factors.blue && factors.red <= 0x100 )
+			factors.type = MultiplyType::ALPHA;
+		else
+			factors.type = MultiplyType::TINT_ALPHA;
+
+		factors.inRange = globalMultiply.alpha >= 0.0f && globalMultiply.alpha <= 1.0f && globalMultiply.red >= 0.0f && globalMultiply.red <= 1.0f &&
+			globalMultiply.green >= 0.0f && globalMultiply.green <= 1.0f && globalMultiply.blue >= 0.0f && globalMultiply.blue <= 1.0f;
+		return factors;
+	}
+
+	// Divides a product of two 8-bit values by 255 with correct rounding (exact for every value up to 0xFF * 0xFF)
+	inline uint32_t DivideBy255( uint32_t value )
+	{
+		value += 0x80;
+		return ( value + ( value >> 8 ) ) >> 8;
+	}
+
+#ifdef PLAY_SIMD_X86
+	// Vector versions of DivideBy255 for every 16-bit value, where the divide is a single high multiply
+	inline __m128i DivideBy255SSE2( __m128i value )
+	{
+		return _mm_mulhi_epu16( _mm_add_epi16( value, _mm_set1_epi16( 0x80 ) ), _mm_set1_epi16( 257 ) );
+	}
+
+	inline __m256i DivideBy255AVX2( __m256i value )
+	{
+		return _mm256_mulhi_epu16( _mm256_add_epi16( value, _mm256_set1_epi16( 0x80 ) ), _mm256_set1_epi16( 257 ) );
+	}
+#endif
+
 	class AlphaBlendPolicy
 	{
 	public:
@@ -1011,48 +1134,161 @@ namespace Play::Render
 		}
 
 		// Standard alpha blending, but with an additional global alpha multiply
-		static inline void BlendSkip( uint32_t*& srcPixels, uint32_t*& destPixels, BlendColour globalMultiply, const uint32_t* destRowEnd )
+		static inline void BlendSkip( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
 		{
 			// A slower blend calculation is required for semi-transparent pixels with a global multiply
 			// Fully transparent pixels can be skipped in the optimal way using the Skip function above   
-			if( Blend( srcPixels, destPixels, globalMultiply ) )
+			if( Blend( srcPixels, destPixels, factors ) )
 				srcPixels++, destPixels++;
 			else
 				Skip( srcPixels, destPixels, destRowEnd );
 		}
 
+		// Blends a whole row using BlendFast, processing several pixels at once when the processor supports it
+		static inline void BlendFastRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			if( m_simdLevel == SimdLevel::AVX2 )
+				BlendFastRowAVX2( srcPixels, destPixels, destRowEnd );
+			else if( m_simdLevel == SimdLevel::SSE2 )
+				BlendFastRowSSE2( srcPixels, destPixels, destRowEnd );
+#endif
+			// Any pixels left over at the end of the row are blended one at a time
+			while( destPixels < destRowEnd )
+				BlendFastSkip( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Blends a whole row using BlendUnit, processing several pixels at once when the processor supports it
+		// > Slower than BlendFastRow, but exactly the same as the Blend which TransformPixels uses without a global multiply
+		static inline void BlendUnitRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			if( m_simdLevel == SimdLevel::AVX2 )
+				BlendUnitRowAVX2( srcPixels, destPixels, destRowEnd );
+			else if( m_simdLevel == SimdLevel::SSE2 )
+				BlendUnitRowSSE2( srcPixels, destPixels, destRowEnd );
+#endif
+			while( destPixels < destRowEnd )
+			{
+				if( BlendUnit( srcPixels, destPixels ) )
+					srcPixels++, destPixels++;
+				else
+					Skip( srcPixels, destPixels, destRowEnd );
+			}
+		}
+
+		// Draws a whole row of fully opaque pixels, which only needs the alpha fixing up as the inverted source alpha is zero
+		static inline void BlendOpaqueRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			// Equivalent to BlendFast for opaque pixels: dest*0 + src with the alpha forced to opaque
+#ifdef PLAY_SIMD_X86
+			if( m_simdLevel == SimdLevel::AVX2 )
+			{
+				const __m256i opaque = _mm256_set1_epi32( 0xFF000000 );
+				for( ; destRowEnd - destPixels >= 8; srcPixels += 8, destPixels += 8 )
+					_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_or_si256( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) ), opaque ) );
+			}
+			else if( m_simdLevel == SimdLevel::SSE2 )
+			{
+				const __m128i opaque = _mm_set1_epi32( 0xFF000000 );
+				for( ; destRowEnd - destPixels >= 4; srcPixels += 4, destPixels += 4 )
+					_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), _mm_or_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) ), opaque ) );
+			}
+#endif
+			while( destPixels < destRowEnd )
+				*destPixels++ = *srcPixels++ | 0xFF000000;
+		}
+
+		// Blends a whole row using Blend, with a version of the blend for each type of global multiply so that alpha-only and tint-only multiplies
+		// don't pay for the parts they don't use
+		static inline void BlendRow( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			switch( factors.type )
+			{
+				case MultiplyType::ALPHA:
+					BlendRowFixed< MultiplyType::ALPHA >( srcPixels, destPixels, factors, destRowEnd );
+					break;
+				case MultiplyType::TINT:
+					BlendRowFixed< MultiplyType::TINT >( srcPixels, destPixels, factors, destRowEnd );
+					break;
+				default:
+					BlendRowFixed< MultiplyType::TINT_ALPHA >( srcPixels, destPixels, factors, destRowEnd );
+					break;
+			}
+		}
+
+		// Blends a whole row using BlendFixed, processing several pixels at once when the processor supports it
+		template< MultiplyType TYPE > static inline void BlendRowFixed( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			// The vector version needs every scaled source channel to fit into 16 bits, which is only guaranteed for multipliers in the range 0-1
+			if( factors.inRange && m_simdLevel != SimdLevel::SCALAR )
+			{
+				if( m_simdLevel == SimdLevel::AVX2 )
+					BlendRowAVX2< TYPE >( srcPixels, destPixels, factors, destRowEnd );
+				else
+					BlendRowSSE2< TYPE >( srcPixels, destPixels, factors, destRowEnd );
+			}
+#endif
+			while( destPixels < destRowEnd )
+			{
+				if( BlendFixed< TYPE >( srcPixels, destPixels, factors ) )
+					srcPixels++, destPixels++;
+				else
+					Skip( srcPixels, destPixels, destRowEnd );
+			}
+		}
+
 		// *******************************************************************************************************************************************************
 		// A basic approach which separates the channels and performs a 'typical' alpha blending operation: (src * srcAlpha)+(dest * (1-srcAlpha))
 		// Has the advantage that a global alpha multiplication can be easily added over the top, so we use this method when a global multiply is required
+		// The global multiply is applied in 8.8 fixed point so that the vector versions can give exactly the same result
 		// Notes: Requires a source buffer which has the source alpha pre-multiplied
 		// *******************************************************************************************************************************************************
-		static inline bool Blend(uint32_t*& srcPixels, uint32_t*& destPixels, BlendColour globalMultiply)
+		static inline bool Blend( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors )
+		{
+			return BlendFixed< MultiplyType::TINT_ALPHA >( srcPixels, destPixels, factors );
+		}
+
+		// The same as Blend, but only working out the parts of the global multiply which the given type uses (the result is always the same)
+		template< MultiplyType TYPE > static inline bool BlendFixed( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors )
 		{
-			if (*srcPixels > 0xFF000000) return false; // No pixels to draw( fully transparent )
+			if (*srcPixels >= 0xFF000000) return false; // No pixels to draw( fully transparent )
 
 			uint32_t src = *srcPixels;
 			uint32_t dest = *destPixels;
 
 			// Note: our source alpha values are already 1-srcAlpha (to make the optimal BlendFast approach faster) so we need to flip them back again
-			uint32_t srcAlpha = static_cast<int>((0xFF - (src >> 24)) * globalMultiply.alpha);
-			uint32_t constAlpha = static_cast<int>(0xFF * globalMultiply.alpha);
+			uint32_t invSrcAlpha = src >> 24;
+			if( TYPE != MultiplyType::TINT )
+				invSrcAlpha = 0xFF - DivideBy255( ( 0xFF - invSrcAlpha ) * factors.alpha );
 
-			// Source pixels are already multiplied by srcAlpha so we just apply the constant alpha multiplier
-			uint32_t destRed = (uint32_t)(constAlpha * globalMultiply.red * ((src >> 16) & 0xFF));
-			uint32_t destGreen = (uint32_t)(constAlpha * globalMultiply.green * ((src >> 8) & 0xFF));
-			uint32_t destBlue = (uint32_t)(constAlpha * globalMultiply.blue * (src & 0xFF));
-
-			uint32_t invSrcAlpha = 0xFF - srcAlpha;
+			// Source pixels are already multiplied by srcAlpha so we just apply the constant multipliers
+			uint32_t srcRed, srcGreen, srcBlue;
+			if( TYPE == MultiplyType::ALPHA )
+			{
+				// Red and blue share a multiplier of 1 or less, so neither product can carry into the other's 16 bits
+				uint32_t srcRedBlue = ( src & 0x00FF00FF ) * factors.red;
+				srcRed = srcRedBlue >> 16;
+				srcGreen = ( ( src >> 8 ) & 0xFF ) * factors.red;
+				srcBlue = srcRedBlue & 0xFFFF;
+			}
+			else
+			{
+				srcRed = ( ( src >> 16 ) & 0xFF ) * factors.red;
+				srcGreen = ( ( src >> 8 ) & 0xFF ) * factors.green;
+				srcBlue = ( src & 0xFF ) * factors.blue;
+			}
 
 			// Apply a standard Alpha blend [ src*srcAlpha + dest*(1-SrcAlpha) ]
-			destRed += invSrcAlpha * ((dest >> 16) & 0xFF);
-			destGreen += invSrcAlpha * ((dest >> 8) & 0xFF);
-			destBlue += invSrcAlpha * (dest & 0xFF);
+			uint32_t destRed = ( srcRed + ( invSrcAlpha * ( ( dest >> 16 ) & 0xFF ) ) ) >> 8;
+			uint32_t destGreen = ( srcGreen + ( invSrcAlpha * ( ( dest >> 8 ) & 0xFF ) ) ) >> 8;
+			uint32_t destBlue = ( srcBlue + ( invSrcAlpha * ( dest & 0xFF ) ) ) >> 8;
 
-			// Bring back to the range 0-255
-			destRed >>= 8;
-			destGreen >>= 8;
-			destBlue >>= 8;
+			// Multipliers above 1 can take the colours out of range
+			if( destRed > 0xFF ) destRed = 0xFF;
+			if( destGreen > 0xFF ) destGreen = 0xFF;
+			if( destBlue > 0xFF ) destBlue = 0xFF;
 
 			// Put ARGB components back together again
 			*destPixels = 0xFF000000 | (destRed << 16) | (destGreen << 8) | destBlue;
@@ -1060,6 +1296,27 @@ namespace Play::Render
 			return true;
 		}
 
+		// Gives exactly the same result as Blend with a { 1, 1, 1, 1 } global multiply, without applying any multipliers
+		static inline bool BlendUnit(uint32_t*& srcPixels, uint32_t*& destPixels)
+		{
+			if (*srcPixels >= 0xFF000000) return false; // No pixels to draw( fully transparent )
+
+			uint32_t src = *srcPixels;
+			uint32_t dest = *destPixels;
+			uint32_t invSrcAlpha = src >> 24;
+
+			uint32_t destRed = ((src >> 16) & 0xFF) + ((invSrcAlpha * ((dest >> 16) & 0xFF)) >> 8);
+			uint32_t destGreen = ((src >> 8) & 0xFF) + ((invSrcAlpha * ((dest >> 8) & 0xFF)) >> 8);
+			uint32_t destBlue = (src & 0xFF) + ((invSrcAlpha * (dest & 0xFF)) >> 8);
+
+			if( destRed > 0xFF ) destRed = 0xFF;
+			if( destGreen > 0xFF ) destGreen = 0xFF;
+			if( destBlue > 0xFF ) destBlue = 0xFF;
+
+			*destPixels = 0xFF000000 | (destRed << 16) | (destGreen << 8) | destBlue;
+			return true;
+		}
+
 		// *******************************************************************************************************************************************************
 		// An optimized approach which uses pre-multiplied alpha, parallel channel multiplication and pixel skipping to achieve the same 'typical' alpha 
 		// blending operation (src * srcAlpha)+(dest * (1-srcAlpha)). Not easy to apply a global alpha multiplication over the top, but used everywhere else.
@@ -1067,7 +1324,7 @@ namespace Play::Render
 		// *******************************************************************************************************************************************************
 		static inline bool BlendFast(uint32_t*& srcPixels, uint32_t*& destPixels)
 		{
-			if (*srcPixels > 0xFF000000) return false; // No pixels to draw( fully transparent )
+			if (*srcPixels >= 0xFF000000) return false; // No pixels to draw( fully transparent )
 
 			// This performs the dest*(1-srcAlpha) calculation for all channels in parallel with minor accuracy loss in dest colour.
 			// It does this by shifting all the destination channels down by 4 bits in order to "make room" for the later multiplication.
@@ -1082,2074 +1339,6026 @@ namespace Play::Render
 
 			return true;
 		}
-	};
-
-	class AdditiveBlendPolicy
-	{
-	public:
-		// Standard additive blending using pre-multiplied srcAlpha buffer: src*srcAlpha + dest*destAlpha
-		// This isn't actually a very common requirement, so we default to the same global multiply approach below 
-		static inline void BlendFastSkip(uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd)
-		{
-			BlendSkip( srcPixels, destPixels, { 1.0f, 1.0f, 1.0f, 1.0f }, destRowEnd );
-		}
-
-		// Standard additive blending, with a global alpha multiply. This is the most common requirement for particle effects.
-		static inline void BlendSkip( uint32_t*& srcPixels, uint32_t*& destPixels, BlendColour globalMultiply, const uint32_t* destRowEnd )
-		{
-			// A full blend calculation is required for semi-transparent pixels with a global multiply
-			// Fully transparent pixels can be skipped in the optimal way using the Skip function above   
-			if( Blend( srcPixels, destPixels, globalMultiply ) )
-				srcPixels++, destPixels++;
-			else
-				Skip( srcPixels, destPixels, destRowEnd );
-		}
 
+#ifdef PLAY_SIMD_X86
 		// *******************************************************************************************************************************************************
-		// A basic approach which separates the channels and performs an additive blending operation: (src * srcAlpha)+(dest * destAlpha)
-		// Has the advantage that a global alpha multiplication can be easily added over the top, so we use this method when a global multiply is required
-		// Notes: Requires a source buffer which has the source alpha pre-multiplied
+		// Vector versions of BlendFast and Blend which produce exactly the same results as the scalar functions above. Each step loads a block of 4 (SSE2) or
+		// 8 (AVX2) pixels and blends them all, leaving the destination untouched where the source is fully transparent. When a block starts with a fully
+		// transparent pixel the run length is used to jump over it in the same way as Skip(). Stops when there are too few pixels left for a whole block.
 		// *******************************************************************************************************************************************************
-		static inline bool Blend(uint32_t*& srcPixels, uint32_t*& destPixels, BlendColour globalMultiply)
+		static inline void BlendFastRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
 		{
-			if (*srcPixels > 0xFF000000) return false; // No pixels to draw( fully transparent )
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF ); // 0xFF000000 - 1 with the sign bit flipped for a signed comparison
+			const __m128i channelMask = _mm_set1_epi32( 0x000F0F0F );
+			const __m128i opaque = _mm_set1_epi32( 0xFF000000 );
 
-			uint32_t src = *srcPixels;
-			uint32_t dest = *destPixels;
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
 
-			// Keep the blended alpha calculation in the high bits
-			uint32_t destAlpha = dest >> 24;
-			uint32_t srcAlpha = 0xFF - (src >> 24);
-			uint32_t blendedAlpha = srcAlpha + destAlpha;
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
 
-			// Source pixels are already multiplied by srcAlpha so we just apply the constant alpha multiplier
-			uint32_t blendedRed = (uint32_t)( globalMultiply.alpha * globalMultiply.red * ((src >> 8) & 0xFF00));
-			uint32_t blendedGreen = (uint32_t)( globalMultiply.alpha * globalMultiply.green * (src & 0xFF00));
-			uint32_t blendedBlue = (uint32_t)( globalMultiply.alpha * globalMultiply.blue * ((src << 8) & 0xFF00));
+				// The inverse alpha / 16 is copied into both 16-bit halves of each pixel so a 16-bit multiply handles all three channels (none exceed 0xE1E1)
+				__m128i invAlpha = _mm_srli_epi32( src, 28 );
+				invAlpha = _mm_or_si128( invAlpha, _mm_slli_epi32( invAlpha, 16 ) );
+				__m128i blended = _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( dest, 4 ), channelMask ), invAlpha );
+				blended = _mm_or_si128( _mm_add_epi32( src, blended ), opaque );
 
-			// Apply an additive blend [ src*srcAlpha + dest*destAlpha ]
-			blendedRed += 0xFF * ((dest >> 16) & 0xFF);
-			blendedGreen += 0xFF * ((dest >> 8) & 0xFF);
-			blendedBlue += 0xFF * (dest & 0xFF);
+				__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit );
+				blended = _mm_or_si128( _mm_and_si128( transparent, dest ), _mm_andnot_si128( transparent, blended ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), blended );
 
-			// Bring back to the range 0-255
-			blendedRed >>= 8;
-			blendedGreen >>= 8;
-			blendedBlue >>= 8;
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
 
-			if (blendedAlpha > 0xFF) blendedAlpha = 0xFF;
-			if (blendedRed > 0xFF) blendedRed = 0xFF;
-			if (blendedGreen > 0xFF) blendedGreen = 0xFF;
-			if (blendedBlue > 0xFF) blendedBlue = 0xFF;
+		static inline void BlendFastRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
+			const __m256i channelMask = _mm256_set1_epi32( 0x000F0F0F );
+			const __m256i opaque = _mm256_set1_epi32( 0xFF000000 );
 
-			// Put ARGB components back together again
-			*destPixels = (blendedAlpha << 24) | (blendedRed << 16) | (blendedGreen << 8) | blendedBlue;
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
 
-			return true;
-		}
-	};
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
 
-	class MultiplyBlendPolicy
-	{
-	public:
+				__m256i invAlpha = _mm256_srli_epi32( src, 28 );
+				invAlpha = _mm256_or_si256( invAlpha, _mm256_slli_epi32( invAlpha, 16 ) );
+				__m256i blended = _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi32( dest, 4 ), channelMask ), invAlpha );
+				blended = _mm256_or_si256( _mm256_add_epi32( src, blended ), opaque );
 
-		// Standard multipy blend using an unmodified srcAlpha buffer (the original canvas buffer): dest* invSrcAlpha + (src * dest) * srcAlpha
-		static inline void BlendSkip(uint32_t*& srcPixels, uint32_t*& destPixels, BlendColour globalMultiply, const uint32_t*)
-		{
-			// Transparent pixels still need to be multiplied, so we have only one route
-			Blend(srcPixels, destPixels, globalMultiply);
-			srcPixels++, destPixels++;
-		}
+				__m256i transparent = _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_blendv_epi8( blended, dest, transparent ) );
 
-		// Standard additive blending, with a global alpha multiply. This is the most common requirement for particle effects.
-		static inline void BlendFastSkip(uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t*)
-		{
-			// Transparent pixels still need to be multiplied, so we have only one route
-			Blend(srcPixels, destPixels, { 1.0f, 1.0f, 1.0f, 1.0f });
-			srcPixels++, destPixels++;
+				srcPixels += 8;
+				destPixels += 8;
+			}
 		}
 
-		// *******************************************************************************************************************************************************
-		// A basic approach which separates the channels and performs an additive blending operation: (src * srcAlpha)+(dest * destAlpha)
-		// Has the advantage that a global alpha multiplication can be easily added over the top, so we use this method when a global multiply is required
-		// Notes: Requires a source buffer which has the source alpha unmodified
-		// *******************************************************************************************************************************************************
-		static inline void Blend(uint32_t*& srcPixels, uint32_t*& destPixels, BlendColour globalMultiply)
+		// Vector versions of BlendUnit. The destination channels are multiplied by the inverse alpha in 16-bit halves of each pixel and shifted back down,
+		// then a saturating add of the source clamps each channel in the same way as BlendUnit
+		static inline void BlendUnitRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
 		{
-			if (*srcPixels < 0x00FFFFFF) return; // No pixels to draw( fully transparent )
-
-			uint32_t src = *srcPixels;
-			uint32_t dest = *destPixels;
-
-			// Source pixels
-			uint32_t srcAlpha = src >> 24;
-			uint32_t srcRed = (src >> 16) & 0xFF;
-			uint32_t srcGreen = (src >> 8) & 0xFF;
-			uint32_t srcBlue = src & 0xFF;
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
+			const __m128i channelMask = _mm_set1_epi32( 0x00FF00FF );
+			const __m128i opaque = _mm_set1_epi32( 0xFF000000 );
 
-			// Destination pixels
-			uint32_t destAlpha = dest >> 24;
-			uint32_t destRed = (dest >> 16) & 0xFF;
-			uint32_t destGreen = (dest >> 8) & 0xFF;
-			uint32_t destBlue = dest & 0xFF;
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
 
-			// Apply a multiplicative blend [ dest*invSrcAlpha + (src*dest)*srcAlpha ]
-			uint32_t blendAlpha = static_cast<int>(srcAlpha * globalMultiply.alpha);
-			uint32_t invBlendAlpha = (0xFF - blendAlpha) * 0xFF;
-			uint32_t blendRed = (uint32_t)(globalMultiply.red * (destRed * invBlendAlpha) + ((srcRed * destRed) * blendAlpha));
-			uint32_t blendGreen = (uint32_t)(globalMultiply.green * (destGreen * invBlendAlpha) + ((srcGreen * destGreen) * blendAlpha));
-			uint32_t blendBlue = (uint32_t)(globalMultiply.blue * (destBlue * invBlendAlpha) + ((srcBlue * destBlue) * blendAlpha));
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
 
-			// Bring back to the range 0-255
-			blendRed >>= 16;
-			blendGreen >>= 16;
-			blendBlue >>= 16;
+				__m128i invSrcAlpha = _mm_srli_epi32( src, 24 );
+				invSrcAlpha = _mm_or_si128( invSrcAlpha, _mm_slli_epi32( invSrcAlpha, 16 ) );
+				__m128i redBlue = _mm_srli_epi16( _mm_mullo_epi16( _mm_and_si128( dest, channelMask ), invSrcAlpha ), 8 );
+				__m128i alphaGreen = _mm_andnot_si128( channelMask, _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( dest, 8 ), channelMask ), invSrcAlpha ) );
+				__m128i blended = _mm_or_si128( _mm_adds_epu8( src, _mm_or_si128( redBlue, alphaGreen ) ), opaque );
 
-			// Shouldn't be necessary
-			if (blendRed > 0xFF) blendRed = 0xFF;
-			if (blendGreen > 0xFF) blendGreen = 0xFF;
-			if (blendBlue > 0xFF) blendBlue = 0xFF;
+				__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit );
+				blended = _mm_or_si128( _mm_and_si128( transparent, dest ), _mm_andnot_si128( transparent, blended ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), blended );
 
-			// Put ARGB components back together again
-			*destPixels = (destAlpha << 24) | (blendRed << 16) | (blendGreen << 8) | blendBlue;
+				srcPixels += 4;
+				destPixels += 4;
+			}
 		}
-	};
-}
-#endif
-#ifndef PLAY_PLAYRENDER_H
-#define PLAY_PLAYRENDER_H
-//********************************************************************************************************************************
-// File:		PlayRender.h
-// Description:	A software pixel renderer for drawing 2D primitives into a PixelData buffer
-// Platform:	Independent
-// Notes:		The only internal state/data stored by the renderer is a pointer to the render target
-//********************************************************************************************************************************
-namespace Play::Render
-{
-	// Set the render target for all subsequent drawing operations
-	// Returns a pointer to any previous render target
-	PixelData* SetRenderTarget( PixelData* pRenderTarget );
 
-	extern PixelData* m_pRenderTarget;
-
-	// Primitive drawing functions
-	//********************************************************************************************************************************
+		static inline void BlendUnitRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
+			const __m256i channelMask = _mm256_set1_epi32( 0x00FF00FF );
+			const __m256i opaque = _mm256_set1_epi32( 0xFF000000 );
 
-	// Sets the colour of an individual pixel on the render target
-	template< typename TBlend > void DrawPixel(int posX, int posY, Pixel pix);
-	// Sets the colour of an individual pixel on the render target
-	template< typename TBlend > void DrawPixelPreMult(int posX, int posY, Pixel pix);
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
 
-	// Draws a line of pixels into the render target
-	void DrawLine( int startX, int startY, int endX, int endY, Pixel pix );
-	// Draws pixel data to the render target using a direct copy
-	// > Setting alphaMultiply < 1 forces a less optimal rendering approach (~50% slower) 
-	template< typename TBlend > void BlitPixels(const PixelData& srcImage, int srcOffset, int blitX, int blitY, int blitWidth, int blitHeight, BlendColour globalMultiply );
-	// Draws rotated and scaled pixel data to the render target (much slower than BlitPixels)
-	// > Setting alphaMultiply < 1 is not much slower overall (~10% slower) 
-	template< typename TBlend > void RotateScalePixels(const PixelData& srcPixelData, int srcFrameOffset, int srcWidth, int srcHeight, const Point2f& origin, const Matrix2D& m, BlendColour globalMultiply);
-	// Clears the render target using the given pixel colour
-	void ClearRenderTarget( Pixel colour );
-	// Copies a background image of the correct size to the render target
-	void BlitBackground( PixelData& backgroundImage );
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
 
-	//********************************************************************************************************************************
-	// Function:	BlitPixels - draws image data with and without a global alpha multiply
-	// Parameters:	spriteId = the id of the sprite to draw
-	//				xpos, ypos = the position you want to draw the sprite
-	//				frameIndex = which frame of the animation to draw (wrapped)
-	// Notes:		Blend implmentation depends on TBlend class (see PlayBlends.h) - should all end up inlined!
-	//********************************************************************************************************************************
-	template< typename TBlend > void BlitPixels(const PixelData& srcPixelData, int srcOffset, int blitX, int blitY, int blitWidth, int blitHeight, BlendColour globalMultiply)
-	{
-		blitY = m_pRenderTarget->height - blitY; // Flip the y-coordinate to be consistant with a Cartesian co-ordinate system
+				__m256i invSrcAlpha = _mm256_srli_epi32( src, 24 );
+				invSrcAlpha = _mm256_or_si256( invSrcAlpha, _mm256_slli_epi32( invSrcAlpha, 16 ) );
+				__m256i redBlue = _mm256_srli_epi16( _mm256_mullo_epi16( _mm256_and_si256( dest, channelMask ), invSrcAlpha ), 8 );
+				__m256i alphaGreen = _mm256_andnot_si256( channelMask, _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi32( dest, 8 ), channelMask ), invSrcAlpha ) );
+				__m256i blended = _mm256_or_si256( _mm256_adds_epu8( src, _mm256_or_si256( redBlue, alphaGreen ) ), opaque );
 
-		// Nothing within the display buffer to draw
-		if (blitX > m_pRenderTarget->width || blitX + blitWidth < 0 || blitY > m_pRenderTarget->height || blitY + blitHeight < 0)
-			return;
+				__m256i transparent = _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_blendv_epi8( blended, dest, transparent ) );
 
-		// Work out if we need to clip to the display buffer (and by how much)
-		int xClipStart = -blitX;
-		if (xClipStart < 0) { xClipStart = 0; }
+				srcPixels += 8;
+				destPixels += 8;
+			}
+		}
 
-		int xClipEnd = (blitX + blitWidth) - m_pRenderTarget->width;
-		if (xClipEnd < 0) { xClipEnd = 0; }
+		// The red/blue and alpha/green channels are split into separate 16-bit halves of each pixel, where the source and destination products are combined
+		// with a saturating add which clamps each channel in the same way as Blend. An alpha-only multiply uses one multiplier for every colour, and a tint-only
+		// multiply leaves out the global alpha calculation altogether.
+		template< MultiplyType TYPE > static inline void BlendRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
+			const __m128i byteMask = _mm_set1_epi32( 0xFF );
+			const __m128i channelMask = _mm_set1_epi32( 0x00FF00FF );
+			const __m128i opaque = _mm_set1_epi32( 0xFF000000 );
+
+			// The alpha channel is always opaque afterwards, so it doesn't matter what it is multiplied by
+			const __m128i alphaMultiply = _mm_set1_epi32( static_cast<int>( factors.alpha ) );
+			const __m128i redBlueMultiply = _mm_set1_epi32( static_cast<int>( ( factors.red << 16 ) | factors.blue ) );
+			const __m128i greenMultiply = TYPE == MultiplyType::ALPHA ? redBlueMultiply : _mm_set1_epi32( static_cast<int>( factors.green ) );
+
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
 
-		int yClipStart = -blitY;
-		if (yClipStart < 0) { yClipStart = 0; }
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
 
-		int yClipEnd = (blitY + blitHeight) - m_pRenderTarget->height;
-		if (yClipEnd < 0) { yClipEnd = 0; }
+				// The inverse alpha is copied into both 16-bit halves of each pixel
+				__m128i invSrcAlpha = _mm_srli_epi32( src, 24 );
+				if( TYPE != MultiplyType::TINT )
+					invSrcAlpha = _mm_sub_epi32( byteMask, DivideBy255SSE2( _mm_mullo_epi16( _mm_sub_epi32( byteMask, invSrcAlpha ), alphaMultiply ) ) );
+				invSrcAlpha = _mm_or_si128( invSrcAlpha, _mm_slli_epi32( invSrcAlpha, 16 ) );
 
-		// Set up the source and destination pointers based on clipping
-		int destOffset = (m_pRenderTarget->width * (blitY + yClipStart)) + (blitX + xClipStart);
-		uint32_t* destPixels = &m_pRenderTarget->pPixels->bits + destOffset;
+				__m128i redBlue = _mm_adds_epu16( _mm_mullo_epi16( _mm_and_si128( src, channelMask ), redBlueMultiply ), _mm_mullo_epi16( _mm_and_si128( dest, channelMask ), invSrcAlpha ) );
+				__m128i alphaGreen = _mm_adds_epu16( _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( src, 8 ), channelMask ), greenMultiply ), _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( dest, 8 ), channelMask ), invSrcAlpha ) );
+				__m128i blended = _mm_or_si128( _mm_or_si128( _mm_srli_epi16( redBlue, 8 ), _mm_andnot_si128( channelMask, alphaGreen ) ), opaque );
 
-		int srcClipOffset = (srcPixelData.width * yClipStart) + xClipStart;
-		uint32_t* srcPixels = &srcPixelData.pPixels->bits + srcOffset + srcClipOffset;
+				__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit );
+				blended = _mm_or_si128( _mm_and_si128( transparent, dest ), _mm_andnot_si128( transparent, blended ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), blended );
 
-		// Work out in advance how much we need to add to src and dest to reach the next row 
-		int destInc = m_pRenderTarget->width - blitWidth + xClipEnd + xClipStart;
-		int srcInc = srcPixelData.width - blitWidth + xClipEnd + xClipStart;
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
 
-		//Work out final pixel in destination.
-		int destColOffset = (m_pRenderTarget->width * (blitHeight - yClipEnd - yClipStart - 1)) + (blitWidth - xClipEnd - xClipStart);
-		uint32_t* destColEnd = destPixels + destColOffset;
+		template< MultiplyType TYPE > static inline void BlendRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
+			const __m256i byteMask = _mm256_set1_epi32( 0xFF );
+			const __m256i channelMask = _mm256_set1_epi32( 0x00FF00FF );
+			const __m256i opaque = _mm256_set1_epi32( 0xFF000000 );
 
-		//How many pixels per row in sprite.
-		int endRow = blitWidth - xClipEnd - xClipStart;
+			const __m256i alphaMultiply = _mm256_set1_epi32( static_cast<int>( factors.alpha ) );
+			const __m256i redBlueMultiply = _mm256_set1_epi32( static_cast<int>( ( factors.red << 16 ) | factors.blue ) );
+			const __m256i greenMultiply = TYPE == MultiplyType::ALPHA ? redBlueMultiply : _mm256_set1_epi32( static_cast<int>( factors.green ) );
 
-		if (globalMultiply.alpha < 1.0f || globalMultiply.red < 1.0f || globalMultiply.green < 1.0f || globalMultiply.blue < 1.0f )
-		{
-			// It is slightly faster to loop through without the additions 
-			while (destPixels < destColEnd)
+			while( destRowEnd - destPixels >= 8 )
 			{
-				uint32_t* destRowEnd = destPixels + endRow;
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
 
-				// Call the more versatile global multiply blend function
-				while (destPixels < destRowEnd)
-					TBlend::BlendSkip(srcPixels, destPixels, globalMultiply, destRowEnd);
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
 
-				// Increase buffers by pre-calculated amounts
-				destPixels += destInc;
-				srcPixels += srcInc;
-			}
-		}
-		else
-		{
-			// It is slightly faster to loop through without the additions 
-			while (destPixels < destColEnd)
-			{
-				uint32_t* destRowEnd = destPixels + endRow;
+				__m256i invSrcAlpha = _mm256_srli_epi32( src, 24 );
+				if( TYPE != MultiplyType::TINT )
+					invSrcAlpha = _mm256_sub_epi32( byteMask, DivideBy255AVX2( _mm256_mullo_epi16( _mm256_sub_epi32( byteMask, invSrcAlpha ), alphaMultiply ) ) );
+				invSrcAlpha = _mm256_or_si256( invSrcAlpha, _mm256_slli_epi32( invSrcAlpha, 16 ) );
+
+				__m256i redBlue = _mm256_adds_epu16( _mm256_mullo_epi16( _mm256_and_si256( src, channelMask ), redBlueMultiply ), _mm256_mullo_epi16( _mm256_and_si256( dest, channelMask ), invSrcAlpha ) );
+				__m256i alphaGreen = _mm256_adds_epu16( _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi32( src, 8 ), channelMask ), greenMultiply ), _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi32( dest, 8 ), channelMask ), invSrcAlpha ) );
+				__m256i blended = _mm256_or_si256( _mm256_or_si256( _mm256_srli_epi16( redBlue, 8 ), _mm256_andnot_si256( channelMask, alphaGreen ) ), opaque );
 
-				// Call the fastest available blend function
-				while (destPixels < destRowEnd)
-					TBlend::BlendFastSkip(srcPixels, destPixels, destRowEnd);
+				__m256i transparent = _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_blendv_epi8( blended, dest, transparent ) );
 
-				// Increase buffers by pre-calculated amounts
-				destPixels += destInc;
-				srcPixels += srcInc;
+				srcPixels += 8;
+				destPixels += 8;
 			}
 		}
+#endif
+	};
 
-		return;
-	}
-
-	//********************************************************************************************************************************
-	// Function:	TransformPixels - draws the image data transforming each screen pixel into image space
-	// Parameters:	srcPixelData = the pixel data you want to draw
-	//				srcFrameOffset = the horizontal pixel offset for the required animation frame within the PixelData
-	//				srcDrawWidth, srcDrawHeight = the width and height of the source image frame
-	//				srcOrigin = the centre of rotation for the source image
-	//				alphaMultiply = additional transparancy applied to the whole sprite
-	// Notes:		Much slower than BlitPixels, alphaMultiply is a negligable overhead compared to the rotation
-	//********************************************************************************************************************************
-	template< typename TBlend > void TransformPixels(const PixelData& srcPixelData, int srcFrameOffset, int srcDrawWidth, int srcDrawHeight, const Point2f& srcOrigin, const Matrix2D& transform, BlendColour globalMultiply)
+	class PreciseAlphaBlendPolicy
 	{
-		// We flip the y screen coordinate and reverse the rotatation to be consistant with a right-handed Cartesian co-ordinate system 
-		Matrix2D right;
-		right.row[0] = { transform.row[0].x, transform.row[1].x, 0.0f };
-		right.row[1] = { transform.row[0].y, transform.row[1].y, 0.0f };
-		right.row[2] = { transform.row[2].x, m_pRenderTarget->height - transform.row[2].y, 1.0f };
+	public:
+		// The same blend as AlphaBlendPolicy, (src * srcAlpha)+(dest * (1-srcAlpha)), but without rounding the destination colour down to the nearest 16.
+		// Each destination channel is multiplied by the inverse source alpha and divided by 255 with correct rounding, so there is no banding when 
+		// lots of translucent layers are drawn on top of each other (e.g. smoke or glass).
+		static inline void BlendFastSkip( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			if( BlendUnit( srcPixels, destPixels ) )
+				srcPixels++, destPixels++;
+			else
+				Skip( srcPixels, destPixels, destRowEnd );
+		}
 
-		static float inf = std::numeric_limits<float>::infinity();
-		float dst_minx{ inf }, dst_miny{ inf }, dst_maxx{ -inf }, dst_maxy{ -inf };
+		// Precise alpha blending, but with an additional global multiply
+		static inline void BlendSkip( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			if( Blend( srcPixels, destPixels, factors ) )
+				srcPixels++, destPixels++;
+			else
+				Skip( srcPixels, destPixels, destRowEnd );
+		}
 
-		float x[2] = { -srcOrigin.x, srcDrawWidth - srcOrigin.x };
-		float y[2] = { -srcOrigin.y, srcDrawHeight - srcOrigin.y };
-		Point2f vertices[4] = { { x[0], y[0] }, { x[1], y[0] }, { x[1], y[1] }, { x[0], y[1] } };
+		// Blends a whole row using BlendUnit, processing several pixels at once when the processor supports it
+		static inline void BlendFastRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			if( m_simdLevel == SimdLevel::AVX2 )
+				BlendFastRowAVX2( srcPixels, destPixels, destRowEnd );
+			else if( m_simdLevel == SimdLevel::SSE2 )
+				BlendFastRowSSE2( srcPixels, destPixels, destRowEnd );
+#endif
+			while( destPixels < destRowEnd )
+				BlendFastSkip( srcPixels, destPixels, destRowEnd );
+		}
 
-		// Calculate the extremes of the rotated corners.
-		for (int i = 0; i < 4; i++)
+		// BlendFastRow already blends with BlendUnit
+		static inline void BlendUnitRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
 		{
-			vertices[i] = right.Transform(vertices[i]);
-			dst_minx = floor(dst_minx < vertices[i].x ? dst_minx : vertices[i].x);
-			dst_maxx = ceil(dst_maxx > vertices[i].x ? dst_maxx : vertices[i].x);
-			dst_miny = floor(dst_miny < vertices[i].y ? dst_miny : vertices[i].y);
-			dst_maxy = ceil(dst_maxy > vertices[i].y ? dst_maxy : vertices[i].y);
+			BlendFastRow( srcPixels, destPixels, destRowEnd );
 		}
 
-		// Calculate the inverse transform so that we can iterate through the render target's pixels within the sprite's space
-		if (Determinant(right) == 0.0f) return;
-		Matrix2D invTransform = right;
-		invTransform.Inverse();
+		// Fully opaque pixels don't need any rounding, so they are copied in the same way as AlphaBlendPolicy
+		static inline void BlendOpaqueRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			AlphaBlendPolicy::BlendOpaqueRow( srcPixels, destPixels, destRowEnd );
+		}
 
-		// Calculate the minimum drawing area which would contain the rotated corners
-		int dst_draw_width = static_cast<int>(dst_maxx - dst_minx);
-		int dst_draw_height = static_cast<int>(dst_maxy - dst_miny);
-		int dst_buffer_width = m_pRenderTarget->width;
-		int dst_buffer_height = m_pRenderTarget->height;
+		// Blends a whole row using Blend, processing several pixels at once when the processor supports it
+		static inline void BlendRow( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			// The vector version needs every scaled source channel to fit into 16 bits, which is only guaranteed for multipliers in the range 0-1
+			if( factors.inRange && m_simdLevel != SimdLevel::SCALAR )
+			{
+				if( m_simdLevel == SimdLevel::AVX2 )
+					BlendRowAVX2( srcPixels, destPixels, factors, destRowEnd );
+				else
+					BlendRowSSE2( srcPixels, destPixels, factors, destRowEnd );
+			}
+#endif
+			while( destPixels < destRowEnd )
+				BlendSkip( srcPixels, destPixels, factors, destRowEnd );
+		}
 
-		// Clip the drawing area if any of the rotated corners are outside of the render target buffer
-		if (dst_miny < 0) { dst_draw_height += (int)dst_miny; dst_miny = 0; }
-		if (dst_maxy > (float)dst_buffer_height) { dst_draw_height -= (int)dst_maxy - dst_buffer_height; dst_maxy = (float)dst_buffer_height; }
-		if (dst_minx < 0) { dst_draw_width += (int)dst_minx; dst_minx = 0; }
-		if (dst_maxx > (float)dst_buffer_width) { dst_draw_width -= (int)dst_maxx - dst_buffer_width;  dst_maxx = (float)dst_buffer_width; }
+		// *******************************************************************************************************************************************************
+		// Precise alpha blending with a global multiply, using only integer arithmetic so that the vector versions can give exactly the same result
+		// Notes: Requires a source buffer which has the source alpha pre-multiplied
+		// *******************************************************************************************************************************************************
+		static inline bool Blend( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors )
+		{
+			if( *srcPixels >= 0xFF000000 ) return false; // No pixels to draw( fully transparent )
 
-		// Transform the starting position within the render target into the sprite's space 
-		Point2f dst_pixel_start{ dst_minx, dst_miny };
-		Point2f src_pixel_start = invTransform.Transform(dst_pixel_start) + srcOrigin;
+			uint32_t src = *srcPixels;
+			uint32_t dest = *destPixels;
 
-		// We need floating point for the sprite space as one pixel on the render target is not a whole pixel in the sprite
-		float src_posx = src_pixel_start.x;
-		float src_posy = src_pixel_start.y;
+			// Our source alpha values are stored as 1-srcAlpha, so they are flipped back before applying the global alpha
+			uint32_t invSrcAlpha = 0xFF - DivideBy255( ( 0xFF - ( src >> 24 ) ) * factors.alpha );
 
-		// Integer arithmetic is best for the render target as we're working in whole pixels
-		int dst_posx = static_cast<int>(dst_pixel_start.x);
-		int dst_posy = static_cast<int>(dst_pixel_start.y);
+			uint32_t destRed = ( ( ( ( src >> 16 ) & 0xFF ) * factors.red + 0x80 ) >> 8 ) + DivideBy255( invSrcAlpha * ( ( dest >> 16 ) & 0xFF ) );
+			uint32_t destGreen = ( ( ( ( src >> 8 ) & 0xFF ) * factors.green + 0x80 ) >> 8 ) + DivideBy255( invSrcAlpha * ( ( dest >> 8 ) & 0xFF ) );
+			uint32_t destBlue = ( ( ( src & 0xFF ) * factors.blue + 0x80 ) >> 8 ) + DivideBy255( invSrcAlpha * ( dest & 0xFF ) );
 
-		// The inverse transform matrix contains axis unit vectors for navigating render target space within sprite space
-		float src_xincx = invTransform.row[0].x;
-		float src_xincy = invTransform.row[0].y;
-		float src_yincx = invTransform.row[1].x;
-		float src_yincy = invTransform.row[1].y;
-		float src_xresetx = src_xincx * dst_draw_width;
-		float src_xresety = src_xincy * dst_draw_width;
+			if( destRed > 0xFF ) destRed = 0xFF;
+			if( destGreen > 0xFF ) destGreen = 0xFF;
+			if( destBlue > 0xFF ) destBlue = 0xFF;
 
-		// Calculate the pixel start and end positions within the render target buffer
-		int dst_start_pixel_index = dst_posx + (dst_posy * dst_buffer_width);
-		uint32_t* dst_pixel = (uint32_t*)m_pRenderTarget->pPixels + dst_start_pixel_index;
-		uint32_t* dst_pixel_end = dst_pixel + (dst_draw_height * dst_buffer_width);
+			*destPixels = 0xFF000000 | ( destRed << 16 ) | ( destGreen << 8 ) | destBlue;
+			return true;
+		}
 
-		// Iterate sequentially through pixels within the render target buffer
-		while (dst_pixel < dst_pixel_end)
+		// Gives exactly the same result as Blend with a { 1, 1, 1, 1 } global multiply
+		static inline bool BlendUnit( uint32_t*& srcPixels, uint32_t*& destPixels )
 		{
-			// For each row of pixels in turn
-			uint32_t* dst_row_end = dst_pixel + dst_draw_width;
-			while (dst_pixel < dst_row_end)
-			{
-				// The origin of a pixel is in its centre
-				int roundX = static_cast<int>(src_posx + 0.5f);
-				int roundY = static_cast<int>(src_posy + 0.5f);
+			if( *srcPixels >= 0xFF000000 ) return false; // No pixels to draw( fully transparent )
 
-				// Clip within the sprite boundaries
-				if (roundX >= 0 && roundY >= 0 && roundX < srcDrawWidth && roundY < srcDrawHeight)
-				{
-					int src_pixel_index = roundX + (roundY * srcPixelData.width);
-					uint32_t* src = ((uint32_t*)srcPixelData.pPixels + src_pixel_index + srcFrameOffset);
-					TBlend::Blend(src, dst_pixel, globalMultiply); // Perform the appropriate blend using a template
-				}
+			uint32_t src = *srcPixels;
+			uint32_t dest = *destPixels;
+			uint32_t invSrcAlpha = src >> 24;
 
-				// Move one horizontal pixel in render target, which corresponds to the x axis of the inverse matrix in sprite space
-				dst_pixel++;
-				src_posx += src_xincx;
-				src_posy += src_xincy;
-			}
+			// Red and blue are multiplied together as neither product can carry into the other's 16 bits
+			uint32_t redBlue = ( ( dest & 0x00FF00FF ) * invSrcAlpha ) + 0x00800080;
+			redBlue = ( ( redBlue + ( ( redBlue >> 8 ) & 0x00FF00FF ) ) >> 8 ) & 0x00FF00FF;
 
-			// Move render target pointer to the start of the next row
-			dst_pixel += dst_buffer_width - dst_draw_width;
+			uint32_t destRed = ( ( src >> 16 ) & 0xFF ) + ( redBlue >> 16 );
+			uint32_t destGreen = ( ( src >> 8 ) & 0xFF ) + DivideBy255( invSrcAlpha * ( ( dest >> 8 ) & 0xFF ) );
+			uint32_t destBlue = ( src & 0xFF ) + ( redBlue & 0xFF );
 
-			// Move sprite buffer pointer back to the start of the current row
-			src_posx -= src_xresetx;
-			src_posy -= src_xresety;
+			if( destRed > 0xFF ) destRed = 0xFF;
+			if( destGreen > 0xFF ) destGreen = 0xFF;
+			if( destBlue > 0xFF ) destBlue = 0xFF;
 
-			// One vertical pixel in the render target corresponds to the y axis of the inverse matrix in sprite space
-			src_posx += src_yincx;
-			src_posy += src_yincy;
+			*destPixels = 0xFF000000 | ( destRed << 16 ) | ( destGreen << 8 ) | destBlue;
+			return true;
 		}
-	}
 
-	template< typename TBlend > void DrawPixelPreMult(int posX, int posY, Pixel srcPixel)
-	{
-		if (srcPixel.a == 0x00 || posX < 0 || posX >= m_pRenderTarget->width || posY < 0 || posY >= m_pRenderTarget->height)
-			return;
+#ifdef PLAY_SIMD_X86
+		// *******************************************************************************************************************************************************
+		// Vector versions of BlendUnit and Blend which produce exactly the same results as the scalar functions above. Like BlendUnit, the red/blue and the
+		// alpha/green channels are split into separate 16-bit halves of each pixel, which leaves room for the full product of two channels. Blocks of pixels
+		// are handled in the same way as the AlphaBlendPolicy vector functions, including skipping runs of fully transparent pixels. The block functions are
+		// also used by the darken and lighten blend policies.
+		// *******************************************************************************************************************************************************
 
-		// Pre-multiply alpha and invert
-		srcPixel.r = (srcPixel.r * srcPixel.a) >> 8;
-		srcPixel.g = (srcPixel.g * srcPixel.a) >> 8;
-		srcPixel.b = (srcPixel.b * srcPixel.a) >> 8;
-		srcPixel.a = 0xFF - srcPixel.a;
+		// Blends a block of 4 pixels in the same way as BlendUnit (fully transparent source pixels give meaningless results)
+		static inline __m128i BlendUnitSSE2( __m128i src, __m128i dest )
+		{
+			const __m128i channelMask = _mm_set1_epi32( 0x00FF00FF );
 
-		uint32_t* pDest = &m_pRenderTarget->pPixels[(posY * m_pRenderTarget->width) + posX].bits;
-		uint32_t* pSrc = &srcPixel.bits;
+			// The inverse alpha is copied into both 16-bit halves of each pixel
+			__m128i invAlpha = _mm_srli_epi32( src, 24 );
+			invAlpha = _mm_or_si128( invAlpha, _mm_slli_epi32( invAlpha, 16 ) );
+			__m128i redBlue = DivideBy255SSE2( _mm_mullo_epi16( _mm_and_si128( dest, channelMask ), invAlpha ) );
+			__m128i alphaGreen = DivideBy255SSE2( _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( dest, 8 ), channelMask ), invAlpha ) );
 
-		TBlend::Blend(pSrc, pDest, { 1.0f, 1.0f, 1.0f, 1.0f });
+			// A saturating add clamps each channel in the same way as BlendUnit
+			__m128i blended = _mm_adds_epu8( src, _mm_or_si128( redBlue, _mm_slli_epi16( alphaGreen, 8 ) ) );
+			return _mm_or_si128( blended, _mm_set1_epi32( 0xFF000000 ) );
+		}
 
-		return;
-	}
+		static inline __m256i BlendUnitAVX2( __m256i src, __m256i dest )
+		{
+			const __m256i channelMask = _mm256_set1_epi32( 0x00FF00FF );
 
-	template< typename TBlend > void DrawPixel(int posX, int posY, Pixel srcPixel)
-	{
-		if (srcPixel.a == 0x00 || posX < 0 || posX >= m_pRenderTarget->width || posY < 0 || posY >= m_pRenderTarget->height)
-			return;
+			__m256i invAlpha = _mm256_srli_epi32( src, 24 );
+			invAlpha = _mm256_or_si256( invAlpha, _mm256_slli_epi32( invAlpha, 16 ) );
+			__m256i redBlue = DivideBy255AVX2( _mm256_mullo_epi16( _mm256_and_si256( dest, channelMask ), invAlpha ) );
+			__m256i alphaGreen = DivideBy255AVX2( _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi32( dest, 8 ), channelMask ), invAlpha ) );
 
-		uint32_t* pDest = &m_pRenderTarget->pPixels[(posY * m_pRenderTarget->width) + posX].bits;
-		uint32_t* pSrc = &srcPixel.bits;
+			__m256i blended = _mm256_adds_epu8( src, _mm256_or_si256( redBlue, _mm256_slli_epi16( alphaGreen, 8 ) ) );
+			return _mm256_or_si256( blended, _mm256_set1_epi32( 0xFF000000 ) );
+		}
 
-		TBlend::Blend(pSrc, pDest, { 1.0f, 1.0f, 1.0f, 1.0f });
+		// Blends a block of 4 pixels in the same way as Blend, with the multipliers from BlendFactors in the low half (alpha and green) or both halves 
+		// (red and blue) of each pixel
+		static inline __m128i BlendSSE2( __m128i src, __m128i dest, __m128i alphaMultiply, __m128i redBlueMultiply, __m128i greenMultiply )
+		{
+			const __m128i channelMask = _mm_set1_epi32( 0x00FF00FF );
+			const __m128i byteMask = _mm_set1_epi32( 0xFF );
+			const __m128i channelMax = _mm_set1_epi16( 0xFF );
+			const __m128i round = _mm_set1_epi16( 0x80 );
+
+			__m128i invAlpha = _mm_srli_epi32( src, 24 );
+			invAlpha = _mm_sub_epi32( byteMask, DivideBy255SSE2( _mm_mullo_epi16( _mm_sub_epi32( byteMask, invAlpha ), alphaMultiply ) ) );
+			invAlpha = _mm_or_si128( invAlpha, _mm_slli_epi32( invAlpha, 16 ) );
+
+			// The products fit into 16 bits as unsigned values, so the shifts must be logical
+			__m128i redBlue = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_and_si128( src, channelMask ), redBlueMultiply ), round ), 8 );
+			__m128i alphaGreen = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( src, 8 ), channelMask ), greenMultiply ), round ), 8 );
+			redBlue = _mm_add_epi16( redBlue, DivideBy255SSE2( _mm_mullo_epi16( _mm_and_si128( dest, channelMask ), invAlpha ) ) );
+			alphaGreen = _mm_add_epi16( alphaGreen, DivideBy255SSE2( _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( dest, 8 ), channelMask ), invAlpha ) ) );
+			redBlue = _mm_min_epi16( redBlue, channelMax );
+			alphaGreen = _mm_min_epi16( alphaGreen, channelMax );
+
+			return _mm_or_si128( _mm_or_si128( redBlue, _mm_slli_epi16( alphaGreen, 8 ) ), _mm_set1_epi32( 0xFF000000 ) );
+		}
 
-		return;
-	}
-};
-#endif // PLAY_PLAYRENDER_H
-#ifndef PLAY_PLAYGRAPHICS_H
-#define PLAY_PLAYGRAPHICS_H
-//********************************************************************************************************************************
-// File:		PlayGraphics.h
-// Description:	Manages 2D graphics operations on a PixelData buffer 
-// Platform:	Independent
-// Notes:		Uses PNG format. The end of the filename indicates the number of frames e.g. "bat_4.png" or "tiles_10x10.png"
-//********************************************************************************************************************************
-namespace Play::Graphics
-{
-	enum BlendMode
-	{
-		BLEND_NORMAL = 0,
-		BLEND_ADD,
-		BLEND_MULTIPLY,
-		BLEND_SUBTRACT
-	};
+		static inline __m256i BlendAVX2( __m256i src, __m256i dest, __m256i alphaMultiply, __m256i redBlueMultiply, __m256i greenMultiply )
+		{
+			const __m256i channelMask = _mm256_set1_epi32( 0x00FF00FF );
+			const __m256i byteMask = _mm256_set1_epi32( 0xFF );
+			const __m256i channelMax = _mm256_set1_epi16( 0xFF );
+			const __m256i round = _mm256_set1_epi16( 0x80 );
+
+			__m256i invAlpha = _mm256_srli_epi32( src, 24 );
+			invAlpha = _mm256_sub_epi32( byteMask, DivideBy255AVX2( _mm256_mullo_epi16( _mm256_sub_epi32( byteMask, invAlpha ), alphaMultiply ) ) );
+			invAlpha = _mm256_or_si256( invAlpha, _mm256_slli_epi32( invAlpha, 16 ) );
+
+			__m256i redBlue = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_and_si256( src, channelMask ), redBlueMultiply ), round ), 8 );
+			__m256i alphaGreen = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi32( src, 8 ), channelMask ), greenMultiply ), round ), 8 );
+			redBlue = _mm256_add_epi16( redBlue, DivideBy255AVX2( _mm256_mullo_epi16( _mm256_and_si256( dest, channelMask ), invAlpha ) ) );
+			alphaGreen = _mm256_add_epi16( alphaGreen, DivideBy255AVX2( _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi32( dest, 8 ), channelMask ), invAlpha ) ) );
+			redBlue = _mm256_min_epi16( redBlue, channelMax );
+			alphaGreen = _mm256_min_epi16( alphaGreen, channelMax );
+
+			return _mm256_or_si256( _mm256_or_si256( redBlue, _mm256_slli_epi16( alphaGreen, 8 ) ), _mm256_set1_epi32( 0xFF000000 ) );
+		}
 
-	extern BlendMode blendMode;
+		static inline void BlendFastRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
 
-	// Create/Destroy manager functions
-	//********************************************************************************************************************************
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
 
-	// Creates the PlayGraphics manager and generates sprites from all the PNGs in the directory indicated
-	bool CreateManager( int bufferWidth, int bufferHeight, const char* path );
-	// Destroys the PlayGraphics manager
-	bool DestroyManager();
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
+				__m128i blended = BlendUnitSSE2( src, dest );
 
-	// Basic drawing functions
-	//********************************************************************************************************************************
+				__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit );
+				blended = _mm_or_si128( _mm_and_si128( transparent, dest ), _mm_andnot_si128( transparent, blended ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), blended );
 
-	// Sets the colour of an individual pixel in the display buffer
-	void DrawPixel( Point2f pos, Pixel pix );
-	// Draws a line of pixels into the display buffer
-	void DrawLine( Point2f startPos, Point2f endPos, Pixel pix );
-	// Draws a rectangle into the display buffer
-	void DrawRect( Point2f bottomLeft, Point2f topRight, Pixel pix, bool fill = false );
-	// Draws a circle into the display buffer
-	void DrawCircle( Point2f centrePos, int radius, Pixel pix );
-	// Draws raw pixel data to the display buffer
-	// > Pre-multiplies the alpha on the image data if this hasn't been done before
-	void DrawPixelData( PixelData* pixelData, Point2f pos, float alpha = 1.0f );
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
 
-	// Debug font functions
-	//********************************************************************************************************************************
+		static inline void BlendFastRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
 
-	// Draws a single character using the in-built debug font
-	// > Returns the character width in pixels
-	int DrawDebugCharacter( Point2f pos, char c, Pixel pix );
-	// Draws text using the in-built debug font
-	// > Returns the x position at the end of the text
-	int DrawDebugString( Point2f pos, const std::string& s, Pixel pix, bool centred = true );
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
 
-	// Sprite Loading functions
-	//********************************************************************************************************************************
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
+				__m256i blended = BlendUnitAVX2( src, dest );
 
-	// Loads a sprite sheet and creates a sprite from it (custom asset pipelines)
-	// > All sprites are normally automatically created by the PlayGraphics constructor
-	int LoadSpriteSheet( const std::string& path, const std::string& filename );
-	// Adds a sprite sheet dynamically from memory (custom asset pipelines)
-	// > All sprites are normally created by the PlayGraphics constructor
-	int AddSprite( const std::string& name, PixelData& pixelData, int hCount = 1, int vCount = 1 );
-	// Updates a sprite sheet dynamically from memory (custom asset pipelines)
-	// > Left to caller to release old PixelData
-	int UpdateSprite( const std::string& name, PixelData& pixelData, int hCount = 1, int vCount = 1 );
-	// Regenerates the premultiplied alpha data.
-	int UpdateSprite( const std::string& name );
-	
-	// Loads a background image which is assumed to be the same size as the display buffer
-	// > Returns the index of the loaded background
-	int LoadBackground( const char* fileAndPath );
+				__m256i transparent = _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_blendv_epi8( blended, dest, transparent ) );
 
-	// Sprite Getters and Setters
-	//********************************************************************************************************************************
+				srcPixels += 8;
+				destPixels += 8;
+			}
+		}
 
-	// Gets the sprite id of the first matching sprite whose filename contains the given text
-	// > Returns -1 if not found
-	int GetSpriteId( const char* spriteName );
-	// Gets the root filename of a specific sprite
-	const std::string& GetSpriteName( int spriteId );
-	// Gets the size of the sprite with the given id
-	Vector2f GetSpriteSize(int spriteId);
-	// Gets the number of frames in the sprite with the given id
-	int GetSpriteFrames( int spriteId );
-	// Gets the origin of the sprite with the given id (offset from bottom left)
-	Vector2f GetSpriteOrigin( int spriteId );
-	// Sets the origin of the sprite with the given id (offset from bottom left)
-	void SetSpriteOrigin( int spriteId, Vector2f newOrigin, bool relative = false );
-	// Vertically flips the origin of the sprite with the given id (for legacy sprite origins)
-	void FlipSpriteOriginVertically( int spriteId );
-	// Vertically flips the origin of all sprites (for legacy sprite origins)
-	void FlipAllSpriteOriginsVertically( void );
-	// Centres the origin of the sprite with the given id
-	void CentreSpriteOrigin( int spriteId );
-	// Centres the origins of all the sprites
-	void CentreAllSpriteOrigins();
-	// Sets the origin of all sprites found matching the given name (offset from bottom left)
-	void SetSpriteOrigins( const char* rootName, Vector2f newOrigin, bool relative = false );
-	// Gets the number of sprites which have been loaded and created by PlayGraphics
-	int GetTotalLoadedSprites();
-	// Gets a (read only) pointer to a sprite's canvas buffer data
-	const PixelData* GetSpritePixelData( int spriteId ); 
+		static inline void BlendRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
 
-	// Sprite Drawing functions
-	//********************************************************************************************************************************
+			// The alpha multiplier only goes in the low half of each pixel, and the alpha channel itself isn't multiplied
+			const __m128i alphaMultiply = _mm_set1_epi32( static_cast<int>( factors.alpha ) );
+			const __m128i redBlueMultiply = _mm_set1_epi32( static_cast<int>( ( factors.red << 16 ) | factors.blue ) );
+			const __m128i greenMultiply = _mm_set1_epi32( static_cast<int>( factors.green ) );
 
-	// Draw the sprite with transparency (slower than without transparency)
-	void DrawTransparent(int spriteId, Point2f pos, int frameIndex, BlendColour globalMultiply = { 1.0f, 1.0f, 1.0f, 1.0f } ); 
-	// Draw the sprite without rotation or transparency (fastest draw)
-	inline void Draw( int spriteId, Point2f pos, int frameIndex ) { DrawTransparent( spriteId, pos, frameIndex ); } // DrawTransparent only ends up performing a global multiply if any of its values are < 1.0f
-	// Draw the sprite rotated with transparency (slowest draw)
-	void DrawRotated( int spriteId, Point2f pos, int frameIndex, float angle, float scale = 1.0f, BlendColour globalMultiply = { 1.0f, 1.0f, 1.0f, 1.0f } );
-	// Draw the sprite using a matrix transformation and transparency (slowest draw)
-	void DrawTransformed( int spriteId, const Matrix2D& transform, int frameIndex, BlendColour globalMultiply = { 1.0f, 1.0f, 1.0f, 1.0f } );
-	// Draws a previously loaded background image
-	void DrawBackground( int backgroundIndex = 0 );
-	// Multiplies the sprite image buffer by the colour values
-	// > Applies to all subseqent drawing calls for this sprite, but can be reset by calling agin with rgb set to white
-	void ColourSprite( int spriteId, int r, int g, int b );
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
 
-	// Draws a string using a sprite-based font exported from PlayFontTool
-	int DrawString( int fontId, Point2f pos, std::string text );
-	// Draws a centred string using a sprite-based font exported from PlayFontTool
-	int DrawStringCentred( int fontId, Point2f pos, std::string text );
-	// Draws an individual text character using a sprite-based font 
-	int DrawChar( int fontId, Point2f pos, char c );
-	// Draws a rotated text character using a sprite-based font 
-	int DrawCharRotated( int fontId, Point2f pos, float angle, float scale, char c );
-	// Gets the width of an individual text character from a sprite-based font
-	int GetFontCharWidth( int fontId, char c );
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
+				__m128i blended = BlendSSE2( src, dest, alphaMultiply, redBlueMultiply, greenMultiply );
 
-	// A pixel-based sprite collision test (slooow!)
-	int SpriteCollide( int spriteIdA, int frameIndexA, Matrix2D& transA, int spriteIdB, int frameIndexB, Matrix2D& transB );
+				__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit );
+				blended = _mm_or_si128( _mm_and_si128( transparent, dest ), _mm_andnot_si128( transparent, blended ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), blended );
 
-	// Internal sprite structure for storing individual sprite data
-	struct Sprite
-	{
-		int id{ -1 }; // Fast way of finding the right sprite
-		std::string name; // Slow way of finding the right sprite
-		int width{ -1 }, height{ -1 }; // The width and height of a single image in the sprite
-		//int canvasWidth{ -1 }, canvasHeight{ -1 }; // The width and height of the entire sprite canvas
-		int hCount{ -1 }, vCount{ -1 }, totalCount{ -1 };  // The number of sprite images in the canvas horizontally and vertically
-		int originX{ 0 }, originY{ 0 }; // The origin and centre of rotation for the sprite (whole pixels only)
-		PixelData canvasBuffer; // The sprite image data
-		PixelData preMultAlpha; // The sprite data pre-multiplied with its own alpha
-		Sprite() = default;
-	};
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
 
-	// Miscellaneous functions
-	//********************************************************************************************************************************
+		static inline void BlendRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
 
-	// Gets a pointer to the drawing buffer's pixel data
-	PixelData* GetDrawingBuffer(void);
-	// Resets the timing bar data and sets the current timing bar segment to a specific colour
-	void TimingBarBegin( Pixel pix );
-	// Sets the current timing bar segment to a specific colour
-	// > Returns the number of timing segments
-	int SetTimingBarColour( Pixel pix );
-	// Draws the timing bar for the previous frame at the given position and size
-	void DrawTimingBar( Point2f pos, Point2f size );
-	// Gets the duration (in milliseconds) of a specific timing segment
-	float GetTimingSegmentDuration( int id );
-	// Clears the display buffer using the given pixel colour
-	inline void ClearBuffer( Pixel colour ) { Render::ClearRenderTarget( colour ); }
-	// Sets the render target for drawing operations
-	inline PixelData* SetRenderTarget(PixelData* renderTarget) { return Render::SetRenderTarget(renderTarget); }
-	// Set the blend mode for all subsequent drawing operations that support different blend modes
-	inline void SetBlendMode(BlendMode bMode) { blendMode = bMode; }
-};
-#endif // PLAY_PLAYGRAPHICS_H
-#ifndef PLAY_PLAYAUDIO_H
-#define PLAY_PLAYAUDIO_H
-//********************************************************************************************************************************
-// File:		PlayAudio.h
-// Description:	Declarations for a simple audio manager 
-// Platform:	Independant
-//********************************************************************************************************************************
-namespace Play::Audio
-{
-	// Initialises the audio manager, using the directory provided as its root for finding .WAV files
-	bool CreateManager( const char* path );
-	// Destroys any memory associated with the audio manager
-	bool DestroyManager();
-	// Play a sound using part of all of its filename, returns the voice id
-	int StartSound( const char* name, bool bLoop = false, float volume = 1.0f, float freqMod = 1.0f);
-	//  Stop a currently playing sound using its voice id
-	bool StopSound( int voiceId ); 
-	//  Stop all currently playing sounds with the same filename 
-	bool StopSound( const char* name );
-	// Set the volume of a looping sound that's playing using name
-	void SetLoopingSoundVolume( const char* name, float volume = 1.0f);
-	// Set the volume of a looping sound that's playing using id
-	void SetLoopingSoundVolume( int voiceId, float volume = 1.0f);
-	// Set the pitch of a looping sound that's playing using name
-	void SetLoopingSoundPitch(const char* name, float freqMod = 1.0f);
-	// Set the pitch of a looping sound that's playing using id
-	void SetLoopingSoundPitch(int voiceId, float freqMod = 1.0f);
-};
-#endif // PLAY_PLAYAUDIO_H
+			const __m256i alphaMultiply = _mm256_set1_epi32( static_cast<int>( factors.alpha ) );
+			const __m256i redBlueMultiply = _mm256_set1_epi32( static_cast<int>( ( factors.red << 16 ) | factors.blue ) );
+			const __m256i greenMultiply = _mm256_set1_epi32( static_cast<int>( factors.green ) );
 
-#ifndef PLAY_PLAYINPUT_H
-#define PLAY_PLAYINPUT_H
-//********************************************************************************************************************************
-// File:		PlayInput.h
-// Description:	Manages keyboard and mouse input 
-// Platform:	Windows
-// Notes:		Obtains mouse data from PlayWindow via MouseData structure
-//********************************************************************************************************************************
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
 
-namespace Play
-{
-	// values equivalent to Windows VK codes or ASCII alphanumeric
-	enum KeyboardButton
-	{
-		KEY_BACKSPACE = 8, KEY_TAB,
-		KEY_ENTER = 13,
-		KEY_SHIFT = 16, KEY_CTRL, KEY_ALT,
-		KEY_ESCAPE = 27,
-		KEY_SPACE = 32, KEY_PAGE_UP, KEY_PAGE_DOWN, KEY_END, KEY_HOME,
-		KEY_LEFT = 37, KEY_UP, KEY_RIGHT, KEY_DOWN,
-		KEY_INSERT = 45, KEY_DELETE,
-		KEY_0 = 48, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7, KEY_8, KEY_9,
-		KEY_A = 65, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I, KEY_J, KEY_K, KEY_L, KEY_M, KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R, KEY_S, KEY_T, KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z,
-		KEY_NUMPAD_0 = 96, KEY_NUMPAD_1, KEY_NUMPAD_2, KEY_NUMPAD_3, KEY_NUMPAD_4, KEY_NUMPAD_5, KEY_NUMPAD_6, KEY_NUMPAD_7, KEY_NUMPAD_8, KEY_NUMPAD_9,
-		KEY_PLUS = 187, KEY_NUMPAD_PLUS = 107,
-		KEY_MINUS = 189, KEY_NUMPAD_MINUS = 109,
-		KEY_GREATER_THAN = 190, KEY_LESS_THAN = 188,
-		KEY_F1 = 112, KEY_F2, KEY_F3, KEY_F4, KEY_F5, KEY_F6, KEY_F7, KEY_F8, KEY_F9, KEY_F10, KEY_F11, KEY_F12,
-		KEY_OPEN_SQB = 219,
-		KEY_CLOSE_SQB = 221
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
+				__m256i blended = BlendAVX2( src, dest, alphaMultiply, redBlueMultiply, greenMultiply );
+
+				__m256i transparent = _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_blendv_epi8( blended, dest, transparent ) );
+
+				srcPixels += 8;
+				destPixels += 8;
+			}
+		}
+#endif
 	};
 
-	namespace Input
+	class AdditiveBlendPolicy
 	{
+	public:
+		// Standard additive blending using pre-multiplied srcAlpha buffer: src*srcAlpha + dest*destAlpha
+		// Without a global multiply this is just a saturating add of each channel
+		static inline void BlendFastSkip(uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd)
+		{
+			if( BlendUnit( srcPixels, destPixels ) )
+				srcPixels++, destPixels++;
+			else
+				Skip( srcPixels, destPixels, destRowEnd );
+		}
 
-		enum class MouseButton
+		// Standard additive blending, with a global alpha multiply. This is the most common requirement for particle effects.
+		static inline void BlendSkip( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
 		{
-			BUTTON_LEFT = 0,
-			BUTTON_RIGHT
-		};
+			// A full blend calculation is required for semi-transparent pixels with a global multiply
+			// Fully transparent pixels can be skipped in the optimal way using the Skip function above   
+			if( Blend( srcPixels, destPixels, factors ) )
+				srcPixels++, destPixels++;
+			else
+				Skip( srcPixels, destPixels, destRowEnd );
+		}
 
-		// Creates the Input Manager
-		MouseData* CreateManager();
-		// Destroys the Input Manager
-		bool DestroyManager();
-		// Returns the status of the supplied mouse button (0=left, 1=right)
-		bool GetMouseDown( MouseButton button );
-		// Get the screen position of the mouse cursor
-		Point2f GetMousePos();
-		// Returns true if the key has been pressed since it was last released
-		// If you omit the frame number then only the first call in the same frame will ever return true
-		bool KeyPress( Play::KeyboardButton key, int frame = -1 );
-		// Returns true if the key is currently being held down
-		bool KeyHeld( KeyboardButton key );
-	};
-}
-#endif // PLAY_PLAYINPUT_H
+		// Blends a whole row using BlendUnit, processing several pixels at once when the processor supports it
+		static inline void BlendFastRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			if( m_simdLevel == SimdLevel::AVX2 )
+				BlendFastRowAVX2( srcPixels, destPixels, destRowEnd );
+			else if( m_simdLevel == SimdLevel::SSE2 )
+				BlendFastRowSSE2( srcPixels, destPixels, destRowEnd );
+#endif
+			while( destPixels < destRowEnd )
+				BlendFastSkip( srcPixels, destPixels, destRowEnd );
+		}
 
+		// BlendFastRow already blends with BlendUnit
+		static inline void BlendUnitRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			BlendFastRow( srcPixels, destPixels, destRowEnd );
+		}
 
-#ifndef PLAY_PLAYMANAGER_H
-#define PLAY_PLAYMANAGER_H
-//********************************************************************************************************************************
-// File:		PlayManager.h
-// Description:	A manager for providing simplified access to the PlayBuffer framework with managed GameObjects
-// Platform:	Independent
-// Notes:		The GameObject management is "opt in" as many will want to create their own GameObject class
-//********************************************************************************************************************************
+		// Blends a whole row of fully opaque pixels (which still need to be added)
+		static inline void BlendOpaqueRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			BlendFastRow( srcPixels, destPixels, destRowEnd );
+		}
 
-#define TRANSFORM_SPACE( p )  (Play::drawSpace == Play::DrawingSpace::WORLD ? p - Play::cameraPos : p)
-#define TRANSFORM_MATRIX_SPACE( t ) (Play::drawSpace == Play::DrawingSpace::WORLD ? t * (MatrixTranslation( -Play::cameraPos.x, -Play::cameraPos.y )) : t)
+		// Blends a whole row using Blend, processing several pixels at once when the processor supports it
+		static inline void BlendRow( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			// The vector version needs every scaled source channel to fit into 16 bits, which is only guaranteed for multipliers in the range 0-1
+			if( factors.inRange && m_simdLevel != SimdLevel::SCALAR )
+			{
+				if( m_simdLevel == SimdLevel::AVX2 )
+					BlendRowAVX2( srcPixels, destPixels, factors, destRowEnd );
+				else
+					BlendRowSSE2( srcPixels, destPixels, factors, destRowEnd );
+			}
+#endif
+			while( destPixels < destRowEnd )
+				BlendSkip( srcPixels, destPixels, factors, destRowEnd );
+		}
 
-//! @brief Main Namespace for PlayBuffer
-namespace Play
-{
-	//! @brief Alignment for font drawing operations
-	enum Align
-	{
-		//! @brief Text is aligned to the left of the origin.
-		LEFT = 0, 
-		//! @brief Text is aligned to the right of the origin.
-		RIGHT, 
-		//! @brief Text is aligned to the middle of the origin.
-		CENTRE,
-	};
+		// *******************************************************************************************************************************************************
+		// A basic approach which separates the channels and performs an additive blending operation: (src * srcAlpha)+(dest * destAlpha)
+		// The global multiply is applied to the source colours in 8.8 fixed point so that the vector versions can give exactly the same result
+		// Notes: Requires a source buffer which has the source alpha pre-multiplied
+		// *******************************************************************************************************************************************************
+		static inline bool Blend(uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors)
+		{
+			if (*srcPixels >= 0xFF000000) return false; // No pixels to draw( fully transparent )
 
-	//! @brief Used to indicate which edge of the screen you want to check if a GameObject is moving off.
-	enum Direction
-	{
-		//! @brief Check if it's moving off the left or right sides of the screen.
-		HORIZONTAL = 0, 
-		//! @brief Check if it's moving off the top or bottom sides of the screen.
-		VERTICAL, 
-		//! @brief Check if it's moving off any side of the screen.
-		ALL,
-	};
+			uint32_t src = *srcPixels;
+			uint32_t dest = *destPixels;
 
+			// Keep the blended alpha calculation in the high bits
+			uint32_t blendedAlpha = (0xFF - (src >> 24)) + (dest >> 24);
 
-	//! @brief The drawing space values.
-	//! The drawing space determines where things are drawn on the screen. There are two values for this, WORLD and SCREEN.
-		enum DrawingSpace
-	{
-		//! @brief This takes the camera position into account when things are drawn. Essentially, the position that is used is DrawingPosition - CameraPosition.
-		WORLD = 0, 
-		//! @brief This ignores the camera position, and purely uses the position that gets passed through. This is most useful for user interface elements that should always be drawn in the same position on the screen.
-		SCREEN,
-	};
+			// Source pixels are already multiplied by srcAlpha so we just apply the constant multipliers
+			uint32_t blendedRed = ((((src >> 16) & 0xFF) * factors.red + 0x80) >> 8) + ((dest >> 16) & 0xFF);
+			uint32_t blendedGreen = ((((src >> 8) & 0xFF) * factors.green + 0x80) >> 8) + ((dest >> 8) & 0xFF);
+			uint32_t blendedBlue = (((src & 0xFF) * factors.blue + 0x80) >> 8) + (dest & 0xFF);
 
-	//! @brief The Blend modes for sprite drawing.
-	enum BlendMode
-	{
-		//! @brief This blends the sprite normally. If using a transparent sprite draw, this also uses the transparency of the sprite.
-		BLEND_NORMAL = 0, 
-		//! @brief This uses an additive blend, where the colour values of the sprite being drawn are added to the buffer underneath. This has the effect of brightening what is underneath the sprite.
-		BLEND_ADD, 
-		//! @brief This uses an multiplicative blend, where the colour values of the sprite being drawn are multiplied with what is in the buffer underneath. This will darken what is underneath the sprite.
-		BLEND_MULTIPLY
-	};
+			if (blendedAlpha > 0xFF) blendedAlpha = 0xFF;
+			if (blendedRed > 0xFF) blendedRed = 0xFF;
+			if (blendedGreen > 0xFF) blendedGreen = 0xFF;
+			if (blendedBlue > 0xFF) blendedBlue = 0xFF;
 
-	//! @brief A PlayBuffer colour value. Colours are defined in percentages of red, green and blue. All zero is black, All 100 is white.
-	struct Colour
-	{
-		//! Create a colour using float values.
-		//! @param r Amount of red.
-		//! @param g Amount of green.
-		//! @param b Amount of blue.
-		Colour( float r, float g, float b ) : red( r ), green( g ), blue( b ) {}
-		//! Create a colour using int values.
-		//! @param r Amount of red.
-		//! @param g Amount of green.
-		//! @param b Amount of blue.
-		Colour( int r, int g, int b ) : red( static_cast<float>( r ) ), green( static_cast<float>( g ) ), blue( static_cast<float>( b ) ) {}
-		//! @var red 
-		//! Red value, from 0 to 100.
-		//! @var green 
-		//! Green value, from 0 to 100.
-		//! @var blue
-		//! Blue value, from 0 to 100.
-		float red, green, blue;
-	};
+			// Put ARGB components back together again
+			*destPixels = (blendedAlpha << 24) | (blendedRed << 16) | (blendedGreen << 8) | blendedBlue;
 
-	extern Colour cBlack, cRed, cGreen, cBlue, cMagenta, cCyan, cYellow, cOrange, cWhite, cGrey;
-	extern int frameCount;
-	extern Point2f cameraPos;
-	extern DrawingSpace drawSpace;
+			return true;
+		}
 
+		// Gives exactly the same result as Blend with a { 1, 1, 1, 1 } global multiply: a saturating add of every channel
+		static inline bool BlendUnit(uint32_t*& srcPixels, uint32_t*& destPixels)
+		{
+			if (*srcPixels >= 0xFF000000) return false; // No pixels to draw( fully transparent )
 
+			// Flipping the inverted source alpha back means all four channels can be added in the same way
+			uint32_t src = *srcPixels ^ 0xFF000000;
+			uint32_t dest = *destPixels;
 
-	// Manager creation and deletion
-	//**************************************************************************************************
+			// Add the even and odd channels separately, so each has a spare bit above it to catch the overflow
+			uint32_t redBlue = (src & 0x00FF00FF) + (dest & 0x00FF00FF);
+			uint32_t alphaGreen = ((src >> 8) & 0x00FF00FF) + ((dest >> 8) & 0x00FF00FF);
 
-	//! @brief Initialises the manager and creates a window of the required dimensions.
-	//! @param width The width of the window in pixels.
-	//! @param height The height of the window in pixels.
-	//! @param scale Pixel scale. One-pixel equals (scale x scale) pixels in final window.
-	void CreateManager( int width, int height, int scale );
-	//! @brief Shuts down the manager and closes the window.
-	void DestroyManager();
-	// Get the width of the play buffer
-	inline int GetBufferWidth() { return Play::Window::GetWidth(); }
-	// Get the height of the play buffer
-	inline int GetBufferHeight() { return Play::Window::GetHeight(); }
+			// Any channel which overflowed is set to 0xFF
+			redBlue |= ((redBlue >> 8) & 0x00010001) * 0xFF;
+			alphaGreen |= ((alphaGreen >> 8) & 0x00010001) * 0xFF;
 
-	// PlayWindow functions
-	//**************************************************************************************************
+			*destPixels = (redBlue & 0x00FF00FF) | ((alphaGreen & 0x00FF00FF) << 8);
+			return true;
+		}
+
+#ifdef PLAY_SIMD_X86
+		// *******************************************************************************************************************************************************
+		// Vector versions of BlendUnit and Blend which produce exactly the same results as the scalar functions above, using packed saturating adds. With a 
+		// global multiply the source channels are scaled in 16-bit halves of each pixel first. Fully transparent pixels within a block add nothing, and when
+		// a block starts with one the run length is used to jump over it in the same way as Skip().
+		// *******************************************************************************************************************************************************
+		static inline void BlendFastRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
+			const __m128i alphaMask = _mm_set1_epi32( 0xFF000000 );
+
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
+
+				// Transparent pixels store a run length instead of a colour, so they are zeroed
+				__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit );
+				src = _mm_andnot_si128( transparent, _mm_xor_si128( src, alphaMask ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), _mm_adds_epu8( src, dest ) );
+
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
+
+		static inline void BlendFastRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
+			const __m256i alphaMask = _mm256_set1_epi32( 0xFF000000 );
+
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
+
+				__m256i transparent = _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit );
+				src = _mm256_andnot_si256( transparent, _mm256_xor_si256( src, alphaMask ) );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_adds_epu8( src, dest ) );
+
+				srcPixels += 8;
+				destPixels += 8;
+			}
+		}
+
+		static inline void BlendRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
+			const __m128i alphaMask = _mm_set1_epi32( 0xFF000000 );
+			const __m128i channelMask = _mm_set1_epi32( 0x00FF00FF );
+			const __m128i round = _mm_set1_epi16( 0x80 );
+
+			// The alpha channel isn't multiplied, which is the same as multiplying it by 1.0 in 8.8 fixed point
+			const __m128i redBlueMultiply = _mm_set1_epi32( static_cast<int>( ( factors.red << 16 ) | factors.blue ) );
+			const __m128i alphaGreenMultiply = _mm_set1_epi32( static_cast<int>( ( 0x100 << 16 ) | factors.green ) );
+
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
+
+				__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit );
+				src = _mm_xor_si128( src, alphaMask );
+
+				// The products fit into 16 bits as unsigned values, so the shifts must be logical
+				__m128i redBlue = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_and_si128( src, channelMask ), redBlueMultiply ), round ), 8 );
+				__m128i alphaGreen = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( src, 8 ), channelMask ), alphaGreenMultiply ), round ), 8 );
+				src = _mm_andnot_si128( transparent, _mm_or_si128( redBlue, _mm_slli_epi16( alphaGreen, 8 ) ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), _mm_adds_epu8( src, dest ) );
+
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
+
+		static inline void BlendRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
+			const __m256i alphaMask = _mm256_set1_epi32( 0xFF000000 );
+			const __m256i channelMask = _mm256_set1_epi32( 0x00FF00FF );
+			const __m256i round = _mm256_set1_epi16( 0x80 );
+
+			const __m256i redBlueMultiply = _mm256_set1_epi32( static_cast<int>( ( factors.red << 16 ) | factors.blue ) );
+			const __m256i alphaGreenMultiply = _mm256_set1_epi32( static_cast<int>( ( 0x100 << 16 ) | factors.green ) );
+
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
+
+				__m256i transparent = _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit );
+				src = _mm256_xor_si256( src, alphaMask );
+
+				__m256i redBlue = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_and_si256( src, channelMask ), redBlueMultiply ), round ), 8 );
+				__m256i alphaGreen = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi32( src, 8 ), channelMask ), alphaGreenMultiply ), round ), 8 );
+				src = _mm256_andnot_si256( transparent, _mm256_or_si256( redBlue, _mm256_slli_epi16( alphaGreen, 8 ) ) );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_adds_epu8( src, dest ) );
+
+				srcPixels += 8;
+				destPixels += 8;
+			}
+		}
+#endif
+	};
+
+	// Multiply blending uses two different source formats:
+	// > Without a global multiply (BlendUnit, BlendFastSkip, BlendFastRow and BlendOpaqueRow) the source is a multiply factor buffer made by
+	//   PreMultiplyFactors, which stores how much to multiply each destination channel by and the same fully transparent skip values as the pre-multiplied 
+	//   alpha buffer
+	// > With a global multiply (Blend, BlendSkip and BlendRow) the source is the unmodified canvas buffer, as the factors can't be worked out in advance
+	class MultiplyBlendPolicy
+	{
+	public:
+
+		// Standard multipy blend using an unmodified srcAlpha buffer (the original canvas buffer): dest* invSrcAlpha + (src * dest) * srcAlpha
+		static inline void BlendSkip(uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t*)
+		{
+			// Transparent pixels still need to be multiplied, so we have only one route
+			Blend(srcPixels, destPixels, factors);
+			srcPixels++, destPixels++;
+		}
+
+		// Multiply blending using a multiply factor buffer, where fully transparent pixels can be skipped in the optimal way using the Skip function above
+		static inline void BlendFastSkip(uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd)
+		{
+			if( BlendUnit( srcPixels, destPixels ) )
+				srcPixels++, destPixels++;
+			else
+				Skip( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Blends a whole row using BlendUnit, processing several pixels at once when the processor supports it
+		static inline void BlendFastRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			if( m_simdLevel == SimdLevel::AVX2 )
+				BlendFastRowAVX2( srcPixels, destPixels, destRowEnd );
+			else if( m_simdLevel == SimdLevel::SSE2 )
+				BlendFastRowSSE2( srcPixels, destPixels, destRowEnd );
+#endif
+			while( destPixels < destRowEnd )
+				BlendFastSkip( srcPixels, destPixels, destRowEnd );
+		}
+
+		// BlendFastRow already blends with BlendUnit
+		static inline void BlendUnitRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			BlendFastRow( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Blends a whole row of fully opaque pixels (which still need to be multiplied)
+		static inline void BlendOpaqueRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			BlendFastRow( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Blends a whole row of pixels with a global multiply (no vector version yet)
+		static inline void BlendRow( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			while( destPixels < destRowEnd )
+				BlendSkip( srcPixels, destPixels, factors, destRowEnd );
+		}
+
+		// *******************************************************************************************************************************************************
+		// A basic approach which separates the channels and performs an additive blending operation: (src * srcAlpha)+(dest * destAlpha)
+		// Has the advantage that a global alpha multiplication can be easily added over the top, so we use this method when a global multiply is required
+		// Notes: Requires a source buffer which has the source alpha unmodified
+		// *******************************************************************************************************************************************************
+		static inline void Blend(uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors)
+		{
+			if (*srcPixels < 0x00FFFFFF) return; // No pixels to draw( fully transparent )
+
+			uint32_t src = *srcPixels;
+			uint32_t dest = *destPixels;
+
+			// Source pixels
+			uint32_t srcAlpha = src >> 24;
+			uint32_t srcRed = (src >> 16) & 0xFF;
+			uint32_t srcGreen = (src >> 8) & 0xFF;
+			uint32_t srcBlue = src & 0xFF;
+
+			// Destination pixels
+			uint32_t destAlpha = dest >> 24;
+			uint32_t destRed = (dest >> 16) & 0xFF;
+			uint32_t destGreen = (dest >> 8) & 0xFF;
+			uint32_t destBlue = dest & 0xFF;
+
+			// Apply a multiplicative blend [ dest*invSrcAlpha + (src*dest)*srcAlpha ]
+			// The 8.8 colour tints only apply to the invSrcAlpha part, and even the largest tint keeps each product within 32 bits
+			uint32_t blendAlpha = DivideBy255(srcAlpha * factors.alpha);
+			uint32_t invBlendAlpha = (0xFF - blendAlpha) * 0xFF;
+			uint32_t blendRed = destRed * (((invBlendAlpha * factors.redTint) >> 8) + (srcRed * blendAlpha));
+			uint32_t blendGreen = destGreen * (((invBlendAlpha * factors.greenTint) >> 8) + (srcGreen * blendAlpha));
+			uint32_t blendBlue = destBlue * (((invBlendAlpha * factors.blueTint) >> 8) + (srcBlue * blendAlpha));
+
+			// Bring back to the range 0-255
+			blendRed >>= 16;
+			blendGreen >>= 16;
+			blendBlue >>= 16;
+
+			// Shouldn't be necessary
+			if (blendRed > 0xFF) blendRed = 0xFF;
+			if (blendGreen > 0xFF) blendGreen = 0xFF;
+			if (blendBlue > 0xFF) blendBlue = 0xFF;
+
+			// Put ARGB components back together again
+			*destPixels = (destAlpha << 24) | (blendRed << 16) | (blendGreen << 8) | blendBlue;
+		}
+
+		// Gives the same result as Blend with a { 1, 1, 1, 1 } global multiply (to within one either way), using a multiply factor buffer and integer arithmetic
+		static inline bool BlendUnit(uint32_t*& srcPixels, uint32_t*& destPixels)
+		{
+			if (*srcPixels >= 0xFF000000) return false; // No pixels to draw( fully transparent )
+
+			uint32_t factors = *srcPixels;
+			uint32_t dest = *destPixels;
+
+			uint32_t blendRed = ( ( ( dest >> 16 ) & 0xFF ) * ( ( factors >> 16 ) & 0xFF ) ) >> 8;
+			uint32_t blendGreen = ( ( ( dest >> 8 ) & 0xFF ) * ( ( factors >> 8 ) & 0xFF ) ) >> 8;
+			uint32_t blendBlue = ( ( dest & 0xFF ) * ( factors & 0xFF ) ) >> 8;
+
+			*destPixels = (dest & 0xFF000000) | (blendRed << 16) | (blendGreen << 8) | blendBlue;
+			return true;
+		}
+
+#ifdef PLAY_SIMD_X86
+		// *******************************************************************************************************************************************************
+		// Vector versions of BlendUnit which produce exactly the same results as the scalar function above. The destination channels are unpacked into the 
+		// high byte of 16-bit values and the factors into the low byte, so a single high multiply gives (dest * factor) >> 8. The destination alpha and any
+		// fully transparent pixels are left untouched, and when a block starts with a fully transparent pixel the run length is used to jump over it.
+		// *******************************************************************************************************************************************************
+		static inline void BlendFastRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
+			const __m128i alphaMask = _mm_set1_epi32( 0xFF000000 );
+			const __m128i zero = _mm_setzero_si128();
+
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m128i factors = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
+
+				__m128i low = _mm_mulhi_epu16( _mm_unpacklo_epi8( zero, dest ), _mm_unpacklo_epi8( factors, zero ) );
+				__m128i high = _mm_mulhi_epu16( _mm_unpackhi_epi8( zero, dest ), _mm_unpackhi_epi8( factors, zero ) );
+				__m128i blended = _mm_packus_epi16( low, high );
+
+				// The destination is kept for the alpha channel and for fully transparent pixels
+				__m128i keep = _mm_or_si128( _mm_cmpgt_epi32( _mm_xor_si128( factors, signBit ), transparentLimit ), alphaMask );
+				blended = _mm_or_si128( _mm_and_si128( keep, dest ), _mm_andnot_si128( keep, blended ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), blended );
+
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
+
+		static inline void BlendFastRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
+			const __m256i alphaMask = _mm256_set1_epi32( 0xFF000000 );
+			const __m256i zero = _mm256_setzero_si256();
+
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m256i factors = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
+
+				// Unpacking and packing both work within each 128-bit lane, so the pixels end up back in the same order
+				__m256i low = _mm256_mulhi_epu16( _mm256_unpacklo_epi8( zero, dest ), _mm256_unpacklo_epi8( factors, zero ) );
+				__m256i high = _mm256_mulhi_epu16( _mm256_unpackhi_epi8( zero, dest ), _mm256_unpackhi_epi8( factors, zero ) );
+				__m256i blended = _mm256_packus_epi16( low, high );
+
+				__m256i keep = _mm256_or_si256( _mm256_cmpgt_epi32( _mm256_xor_si256( factors, signBit ), transparentLimit ), alphaMask );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_blendv_epi8( blended, dest, keep ) );
+
+				srcPixels += 8;
+				destPixels += 8;
+			}
+		}
+#endif
+	};
+
+	class SubtractBlendPolicy
+	{
+	public:
+		// Subtractive blending using pre-multiplied srcAlpha buffer: dest - (src*srcAlpha), with each colour clamped at zero
+		// The destination alpha is left unchanged, and without a global multiply this is just a saturating subtract of each colour
+		static inline void BlendFastSkip( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			if( BlendUnit( srcPixels, destPixels ) )
+				srcPixels++, destPixels++;
+			else
+				Skip( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Subtractive blending, with a global multiply applied to the source colours first
+		static inline void BlendSkip( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			if( Blend( srcPixels, destPixels, factors ) )
+				srcPixels++, destPixels++;
+			else
+				Skip( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Blends a whole row using BlendUnit, processing several pixels at once when the processor supports it
+		static inline void BlendFastRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			if( m_simdLevel == SimdLevel::AVX2 )
+				BlendFastRowAVX2( srcPixels, destPixels, destRowEnd );
+			else if( m_simdLevel == SimdLevel::SSE2 )
+				BlendFastRowSSE2( srcPixels, destPixels, destRowEnd );
+#endif
+			while( destPixels < destRowEnd )
+				BlendFastSkip( srcPixels, destPixels, destRowEnd );
+		}
+
+		// BlendFastRow already blends with BlendUnit
+		static inline void BlendUnitRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			BlendFastRow( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Blends a whole row of fully opaque pixels (which still need to be subtracted)
+		static inline void BlendOpaqueRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			BlendFastRow( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Blends a whole row using Blend, processing several pixels at once when the processor supports it
+		static inline void BlendRow( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			// The vector version needs every scaled source channel to fit into 16 bits, which is only guaranteed for multipliers in the range 0-1
+			if( factors.inRange && m_simdLevel != SimdLevel::SCALAR )
+			{
+				if( m_simdLevel == SimdLevel::AVX2 )
+					BlendRowAVX2( srcPixels, destPixels, factors, destRowEnd );
+				else
+					BlendRowSSE2( srcPixels, destPixels, factors, destRowEnd );
+			}
+#endif
+			while( destPixels < destRowEnd )
+				BlendSkip( srcPixels, destPixels, factors, destRowEnd );
+		}
+
+		// *******************************************************************************************************************************************************
+		// Separates the channels and subtracts the scaled source colour from the destination: dest - (src * srcAlpha)
+		// The global multiply is applied to the source colours in 8.8 fixed point so that the vector versions can give exactly the same result
+		// Notes: Requires a source buffer which has the source alpha pre-multiplied
+		// *******************************************************************************************************************************************************
+		static inline bool Blend( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors )
+		{
+			if( *srcPixels >= 0xFF000000 ) return false; // No pixels to draw( fully transparent )
+
+			uint32_t src = *srcPixels;
+			uint32_t dest = *destPixels;
+
+			int blendedRed = static_cast<int>( ( dest >> 16 ) & 0xFF ) - static_cast<int>( ( ( ( src >> 16 ) & 0xFF ) * factors.red + 0x80 ) >> 8 );
+			int blendedGreen = static_cast<int>( ( dest >> 8 ) & 0xFF ) - static_cast<int>( ( ( ( src >> 8 ) & 0xFF ) * factors.green + 0x80 ) >> 8 );
+			int blendedBlue = static_cast<int>( dest & 0xFF ) - static_cast<int>( ( ( src & 0xFF ) * factors.blue + 0x80 ) >> 8 );
+
+			if( blendedRed < 0 ) blendedRed = 0;
+			if( blendedGreen < 0 ) blendedGreen = 0;
+			if( blendedBlue < 0 ) blendedBlue = 0;
+
+			*destPixels = ( dest & 0xFF000000 ) | ( blendedRed << 16 ) | ( blendedGreen << 8 ) | blendedBlue;
+			return true;
+		}
+
+		// Gives exactly the same result as Blend with a { 1, 1, 1, 1 } global multiply: a saturating subtract of every colour
+		static inline bool BlendUnit( uint32_t*& srcPixels, uint32_t*& destPixels )
+		{
+			if( *srcPixels >= 0xFF000000 ) return false; // No pixels to draw( fully transparent )
+
+			uint32_t src = *srcPixels;
+			uint32_t dest = *destPixels;
+
+			// Subtract the even and odd channels separately, with a spare bit set above each one to borrow from (the source alpha is left out)
+			uint32_t redBlue = ( ( dest & 0x00FF00FF ) | 0x01000100 ) - ( src & 0x00FF00FF );
+			uint32_t alphaGreen = ( ( ( dest >> 8 ) & 0x00FF00FF ) | 0x01000100 ) - ( ( src >> 8 ) & 0xFF );
+
+			// Any channel which had to borrow is set to zero
+			redBlue &= ( ( redBlue >> 8 ) & 0x00010001 ) * 0xFF;
+			alphaGreen &= ( ( alphaGreen >> 8 ) & 0x00010001 ) * 0xFF;
+
+			*destPixels = redBlue | ( alphaGreen << 8 );
+			return true;
+		}
+
+#ifdef PLAY_SIMD_X86
+		// *******************************************************************************************************************************************************
+		// Vector versions of BlendUnit and Blend which produce exactly the same results as the scalar functions above, using packed saturating subtracts. They
+		// work in the same way as the AdditiveBlendPolicy vector functions, except that the source alpha and fully transparent pixels are cleared so that they
+		// leave the destination unchanged.
+		// *******************************************************************************************************************************************************
+		static inline void BlendFastRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
+			const __m128i alphaMask = _mm_set1_epi32( 0xFF000000 );
+
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
+
+				__m128i keep = _mm_or_si128( _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit ), alphaMask );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), _mm_subs_epu8( dest, _mm_andnot_si128( keep, src ) ) );
+
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
+
+		static inline void BlendFastRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
+			const __m256i alphaMask = _mm256_set1_epi32( 0xFF000000 );
+
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
+
+				__m256i keep = _mm256_or_si256( _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit ), alphaMask );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_subs_epu8( dest, _mm256_andnot_si256( keep, src ) ) );
+
+				srcPixels += 8;
+				destPixels += 8;
+			}
+		}
+
+		static inline void BlendRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
+			const __m128i channelMask = _mm_set1_epi32( 0x00FF00FF );
+			const __m128i round = _mm_set1_epi16( 0x80 );
+
+			// Multiplying the alpha channel by zero means it is never subtracted
+			const __m128i redBlueMultiply = _mm_set1_epi32( static_cast<int>( ( factors.red << 16 ) | factors.blue ) );
+			const __m128i greenMultiply = _mm_set1_epi32( static_cast<int>( factors.green ) );
+
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
+
+				__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit );
+				__m128i redBlue = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_and_si128( src, channelMask ), redBlueMultiply ), round ), 8 );
+				__m128i alphaGreen = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi32( src, 8 ), channelMask ), greenMultiply ), round ), 8 );
+				src = _mm_andnot_si128( transparent, _mm_or_si128( redBlue, _mm_slli_epi16( alphaGreen, 8 ) ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), _mm_subs_epu8( dest, src ) );
+
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
+
+		static inline void BlendRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
+			const __m256i channelMask = _mm256_set1_epi32( 0x00FF00FF );
+			const __m256i round = _mm256_set1_epi16( 0x80 );
+
+			const __m256i redBlueMultiply = _mm256_set1_epi32( static_cast<int>( ( factors.red << 16 ) | factors.blue ) );
+			const __m256i greenMultiply = _mm256_set1_epi32( static_cast<int>( factors.green ) );
+
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
+
+				__m256i transparent = _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit );
+				__m256i redBlue = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_and_si256( src, channelMask ), redBlueMultiply ), round ), 8 );
+				__m256i alphaGreen = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi32( src, 8 ), channelMask ), greenMultiply ), round ), 8 );
+				src = _mm256_andnot_si256( transparent, _mm256_or_si256( redBlue, _mm256_slli_epi16( alphaGreen, 8 ) ) );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_subs_epu8( dest, src ) );
+
+				srcPixels += 8;
+				destPixels += 8;
+			}
+		}
+#endif
+	};
+
+	// Darken and lighten blending: the same blend as PreciseAlphaBlendPolicy, except that each colour only changes if the result is darker (or lighter) than 
+	// the destination, i.e. min(dest, blended) or max(dest, blended). As the blend moves each colour from the destination towards the source by the source
+	// alpha, this gives the usual darken and lighten results, and fully opaque sources just keep the darkest (or lightest) of the two colours.
+	template< bool LIGHTEN > class MinMaxBlendPolicy
+	{
+	public:
+		static inline void BlendFastSkip( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			if( BlendUnit( srcPixels, destPixels ) )
+				srcPixels++, destPixels++;
+			else
+				Skip( srcPixels, destPixels, destRowEnd );
+		}
+
+		static inline void BlendSkip( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			if( Blend( srcPixels, destPixels, factors ) )
+				srcPixels++, destPixels++;
+			else
+				Skip( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Blends a whole row using BlendUnit, processing several pixels at once when the processor supports it
+		static inline void BlendFastRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			if( m_simdLevel == SimdLevel::AVX2 )
+				BlendFastRowAVX2( srcPixels, destPixels, destRowEnd );
+			else if( m_simdLevel == SimdLevel::SSE2 )
+				BlendFastRowSSE2( srcPixels, destPixels, destRowEnd );
+#endif
+			while( destPixels < destRowEnd )
+				BlendFastSkip( srcPixels, destPixels, destRowEnd );
+		}
+
+		// BlendFastRow already blends with BlendUnit
+		static inline void BlendUnitRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			BlendFastRow( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Fully opaque pixels still need comparing with the destination
+		static inline void BlendOpaqueRow( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			BlendFastRow( srcPixels, destPixels, destRowEnd );
+		}
+
+		// Blends a whole row using Blend, processing several pixels at once when the processor supports it
+		static inline void BlendRow( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+#ifdef PLAY_SIMD_X86
+			// The same restriction on the multipliers as the PreciseAlphaBlendPolicy vector version
+			if( factors.inRange && m_simdLevel != SimdLevel::SCALAR )
+			{
+				if( m_simdLevel == SimdLevel::AVX2 )
+					BlendRowAVX2( srcPixels, destPixels, factors, destRowEnd );
+				else
+					BlendRowSSE2( srcPixels, destPixels, factors, destRowEnd );
+			}
+#endif
+			while( destPixels < destRowEnd )
+				BlendSkip( srcPixels, destPixels, factors, destRowEnd );
+		}
+
+		// Keeps the darkest (or lightest) of each colour in the blended and original destination pixels, which are always left fully opaque
+		static inline uint32_t Combine( uint32_t blended, uint32_t dest )
+		{
+			uint32_t result = 0xFF000000;
+			for( int shift = 0; shift < 24; shift += 8 )
+			{
+				uint32_t blendedChannel = ( blended >> shift ) & 0xFF;
+				uint32_t destChannel = ( dest >> shift ) & 0xFF;
+				result |= ( LIGHTEN ? std::max( blendedChannel, destChannel ) : std::min( blendedChannel, destChannel ) ) << shift;
+			}
+			return result;
+		}
+
+		// Notes: Requires a source buffer which has the source alpha pre-multiplied
+		static inline bool Blend( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors )
+		{
+			uint32_t dest = *destPixels;
+			if( !PreciseAlphaBlendPolicy::Blend( srcPixels, destPixels, factors ) ) return false;
+			*destPixels = Combine( *destPixels, dest );
+			return true;
+		}
+
+		// Gives exactly the same result as Blend with a { 1, 1, 1, 1 } global multiply
+		static inline bool BlendUnit( uint32_t*& srcPixels, uint32_t*& destPixels )
+		{
+			uint32_t dest = *destPixels;
+			if( !PreciseAlphaBlendPolicy::BlendUnit( srcPixels, destPixels ) ) return false;
+			*destPixels = Combine( *destPixels, dest );
+			return true;
+		}
+
+#ifdef PLAY_SIMD_X86
+		// *******************************************************************************************************************************************************
+		// Vector versions of BlendUnit and Blend, built on the PreciseAlphaBlendPolicy block functions with a packed min or max of each channel afterwards
+		// *******************************************************************************************************************************************************
+		static inline __m128i CombineSSE2( __m128i blended, __m128i dest )
+		{
+			if( LIGHTEN )
+				return _mm_max_epu8( blended, dest );
+			return _mm_or_si128( _mm_min_epu8( blended, dest ), _mm_set1_epi32( 0xFF000000 ) );
+		}
+
+		static inline __m256i CombineAVX2( __m256i blended, __m256i dest )
+		{
+			if( LIGHTEN )
+				return _mm256_max_epu8( blended, dest );
+			return _mm256_or_si256( _mm256_min_epu8( blended, dest ), _mm256_set1_epi32( 0xFF000000 ) );
+		}
+
+		static inline void BlendFastRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
+
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
+				__m128i blended = CombineSSE2( PreciseAlphaBlendPolicy::BlendUnitSSE2( src, dest ), dest );
+
+				__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit );
+				blended = _mm_or_si128( _mm_and_si128( transparent, dest ), _mm_andnot_si128( transparent, blended ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), blended );
+
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
+
+		static inline void BlendFastRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
+
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
+				__m256i blended = CombineAVX2( PreciseAlphaBlendPolicy::BlendUnitAVX2( src, dest ), dest );
+
+				__m256i transparent = _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_blendv_epi8( blended, dest, transparent ) );
+
+				srcPixels += 8;
+				destPixels += 8;
+			}
+		}
+
+		static inline void BlendRowSSE2( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+			const __m128i transparentLimit = _mm_set1_epi32( 0x7EFFFFFF );
+
+			const __m128i alphaMultiply = _mm_set1_epi32( static_cast<int>( factors.alpha ) );
+			const __m128i redBlueMultiply = _mm_set1_epi32( static_cast<int>( ( factors.red << 16 ) | factors.blue ) );
+			const __m128i greenMultiply = _mm_set1_epi32( static_cast<int>( factors.green ) );
+
+			while( destRowEnd - destPixels >= 4 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m128i src = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPixels ) );
+				__m128i dest = _mm_loadu_si128( reinterpret_cast<const __m128i*>( destPixels ) );
+				__m128i blended = CombineSSE2( PreciseAlphaBlendPolicy::BlendSSE2( src, dest, alphaMultiply, redBlueMultiply, greenMultiply ), dest );
+
+				__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( src, signBit ), transparentLimit );
+				blended = _mm_or_si128( _mm_and_si128( transparent, dest ), _mm_andnot_si128( transparent, blended ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( destPixels ), blended );
+
+				srcPixels += 4;
+				destPixels += 4;
+			}
+		}
+
+		static inline void BlendRowAVX2( uint32_t*& srcPixels, uint32_t*& destPixels, const BlendFactors& factors, const uint32_t* destRowEnd )
+		{
+			const __m256i signBit = _mm256_set1_epi32( 0x80000000 );
+			const __m256i transparentLimit = _mm256_set1_epi32( 0x7EFFFFFF );
+
+			const __m256i alphaMultiply = _mm256_set1_epi32( static_cast<int>( factors.alpha ) );
+			const __m256i redBlueMultiply = _mm256_set1_epi32( static_cast<int>( ( factors.red << 16 ) | factors.blue ) );
+			const __m256i greenMultiply = _mm256_set1_epi32( static_cast<int>( factors.green ) );
+
+			while( destRowEnd - destPixels >= 8 )
+			{
+				if( *srcPixels >= 0xFF000000 )
+				{
+					Skip( srcPixels, destPixels, destRowEnd );
+					continue;
+				}
+
+				__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( srcPixels ) );
+				__m256i dest = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( destPixels ) );
+				__m256i blended = CombineAVX2( PreciseAlphaBlendPolicy::BlendAVX2( src, dest, alphaMultiply, redBlueMultiply, greenMultiply ), dest );
+
+				__m256i transparent = _mm256_cmpgt_epi32( _mm256_xor_si256( src, signBit ), transparentLimit );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( destPixels ), _mm256_blendv_epi8( blended, dest, transparent ) );
+
+				srcPixels += 8;
+				destPixels += 8;
+			}
+		}
+#endif
+	};
+
+	using DarkenBlendPolicy = MinMaxBlendPolicy< false >;
+	using LightenBlendPolicy = MinMaxBlendPolicy< true >;
+}
+#endif
+#ifndef PLAY_PLAYRENDER_H
+#define PLAY_PLAYRENDER_H
+//********************************************************************************************************************************
+// File:		PlayRender.h
+// Description:	A software pixel renderer for drawing 2D primitives into a PixelData buffer
+// Platform:	Independent
+// Notes:		The only internal state/data stored by the renderer is a pointer to the render target and a clip rectangle per thread
+//********************************************************************************************************************************
+namespace Play::Render
+{
+	// Set the render target for all subsequent drawing operations
+	// Returns a pointer to any previous render target
+	PixelData* SetRenderTarget( PixelData* pRenderTarget );
+
+	extern PixelData* m_pRenderTarget;
+
+	// A rectangle of the render target in pixels from the top left (right and bottom are exclusive)
+	struct ClipRect
+	{
+		int left{ 0 }, top{ 0 };
+		int right{ INT_MAX }, bottom{ INT_MAX };
+	};
+
+	// Restricts all subsequent drawing operations on the calling thread to a rectangle of the render target
+	// > Each thread has its own clip rectangle, which lets several threads draw into different parts of the same target
+	void SetClipRect( const ClipRect& clipRect );
+	// Gets the clip rectangle for the calling thread
+	ClipRect GetClipRect();
+	// Removes any clip rectangle for the calling thread
+	void ClearClipRect();
+
+	extern thread_local ClipRect m_clipRect;
+
+	// Gets the part of the render target which can be drawn to by the calling thread
+	inline ClipRect GetDrawableRect()
+	{
+		ClipRect rect = m_clipRect;
+		if( rect.left < 0 ) rect.left = 0;
+		if( rect.top < 0 ) rect.top = 0;
+		if( rect.right > m_pRenderTarget->width ) rect.right = m_pRenderTarget->width;
+		if( rect.bottom > m_pRenderTarget->height ) rect.bottom = m_pRenderTarget->height;
+		return rect;
+	}
+
+	// Converts a row of 32-bit pixels to 16-bit RGB565 (the alpha is dropped and each channel is truncated)
+	void PackRowRGB565( const uint32_t* pSrc, uint16_t* pDest, int count );
+	// Converts a row of 16-bit RGB565 pixels to opaque 32-bit pixels, copying the top bits of each channel into the bottom ones
+	// > Packing the result again gives back the same 16-bit pixels, so a row can be expanded and packed without changing it
+	void ExpandRowRGB565( const uint16_t* pSrc, uint32_t* pDest, int count );
+
+	// Gets a run of render target pixels (from the pixel at offset) as 32-bit pixels for the blend policies to draw into
+	// > A 16-bit target is expanded into a row kept for the calling thread, which UnlockTargetPixels packs back into the target
+	// > Only one run can be locked by each thread at a time
+	inline uint32_t* LockTargetPixels( size_t offset, int count )
+	{
+		if( m_pRenderTarget->format == PIXEL_ARGB8888 )
+			return &m_pRenderTarget->pPixels[offset].bits;
+
+		thread_local std::vector< uint32_t > expanded;
+		if( expanded.size() < static_cast<size_t>( count ) )
+			expanded.resize( count );
+		ExpandRowRGB565( reinterpret_cast<uint16_t*>( m_pRenderTarget->pPixels ) + offset, expanded.data(), count );
+		return expanded.data();
+	}
+
+	// Finishes drawing into pixels from LockTargetPixels
+	inline void UnlockTargetPixels( const uint32_t* pPixels, size_t offset, int count )
+	{
+		if( m_pRenderTarget->format == PIXEL_RGB565 )
+			PackRowRGB565( pPixels, reinterpret_cast<uint16_t*>( m_pRenderTarget->pPixels ) + offset, count );
+	}
+
+	// Describes how a run of pixels within one row of a sprite frame needs to be drawn
+	enum SpanType : uint8_t
+	{
+		SPAN_TRANSPARENT = 0, // Fully transparent, nothing to draw
+		SPAN_OPAQUE, // Fully opaque, can be copied straight into the render target
+		SPAN_TRANSLUCENT, // Partially transparent, needs blending
+	};
+
+	struct PixelSpan
+	{
+		int start{ 0 }; // The first pixel of the run (relative to the start of the frame row)
+		int length{ 0 };
+		SpanType type{ SPAN_TRANSPARENT };
+	};
+
+	// A run-length description of every row of every frame in a pre-multiplied sprite canvas
+	struct SpanTable
+	{
+		int framesPerRow{ 0 }; // The number of frames across the canvas
+		std::vector< uint32_t > rowIndex; // The first span in each frame row, indexed by: ( canvasRow * framesPerRow ) + frameColumn
+		std::vector< PixelSpan > spans;
+	};
+
+	// Builds the span table for a pre-multiplied canvas which is split into frames of the given width
+	void BuildSpanTable( const PixelData& preMultData, int frameWidth, SpanTable& spanTable );
+
+	// How TransformPixels (and Graphics::SpriteCollide) pick which source pixel lands on each destination pixel
+	enum SamplingMode
+	{
+		SAMPLE_DEFAULT = -1, // Use the mode set by SetSamplingMode (only meaningful as a drawing parameter)
+		SAMPLE_NEAREST = 0, // Nearest pixel, stepping in 16.16 fixed point. Gives the same results with any compiler (default)
+		SAMPLE_NEAREST_FLOAT, // Nearest pixel, stepping in floating point (the original method)
+		SAMPLE_BILINEAR, // Smooth filtering of the nearest 2x2 pixels, stepping in 16.16 fixed point. Needs pre-multiplied pixel data
+	};
+
+	// Sets the sampling mode used for all subsequent rotated and scaled drawing
+	void SetSamplingMode( SamplingMode mode );
+	// Gets the current sampling mode
+	SamplingMode GetSamplingMode();
+
+	extern SamplingMode m_samplingMode;
+
+	// Converts a value into 16.16 fixed point, rounding to the nearest 1/65536th
+	inline int64_t ToFixed16( float value )
+	{
+		return static_cast<int64_t>( std::floor( static_cast<double>( value ) * 65536.0 + 0.5 ) );
+	}
+
+	// Blends a 2x2 block of pre-multiplied pixels (top left, top right, bottom left, bottom right) using 8-bit fractional weights
+	// > Uses the same integer arithmetic in the vector and scalar versions so the results are identical
+	inline uint32_t FilterBilinear( const uint32_t taps[4], uint32_t fracX, uint32_t fracY )
+	{
+#ifdef PLAY_SIMD_X86
+		if( m_simdLevel != SimdLevel::SCALAR )
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i round = _mm_set1_epi16( 0x80 );
+
+			// Fully transparent pixels keep a run length in their colour bits, which mustn't be filtered
+			__m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( taps ) );
+			__m128i transparent = _mm_cmpgt_epi32( _mm_xor_si128( pixels, _mm_set1_epi32( 0x80000000 ) ), _mm_set1_epi32( 0x7EFFFFFF ) );
+			pixels = _mm_or_si128( _mm_andnot_si128( transparent, pixels ), _mm_and_si128( transparent, _mm_set1_epi32( 0xFF000000 ) ) );
+
+			// Each channel is widened to 16 bits, so the largest weighted sum is 0xFF * 0x100 + 0x80
+			__m128i weightX = _mm_unpacklo_epi64( _mm_set1_epi16( static_cast<short>( 0x100 - fracX ) ), _mm_set1_epi16( static_cast<short>( fracX ) ) );
+			__m128i top = _mm_mullo_epi16( _mm_unpacklo_epi8( pixels, zero ), weightX );
+			__m128i bottom = _mm_mullo_epi16( _mm_unpackhi_epi8( pixels, zero ), weightX );
+			top = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( top, _mm_srli_si128( top, 8 ) ), round ), 8 );
+			bottom = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( bottom, _mm_srli_si128( bottom, 8 ) ), round ), 8 );
+
+			__m128i weightY = _mm_unpacklo_epi64( _mm_set1_epi16( static_cast<short>( 0x100 - fracY ) ), _mm_set1_epi16( static_cast<short>( fracY ) ) );
+			__m128i result = _mm_mullo_epi16( _mm_unpacklo_epi64( top, bottom ), weightY );
+			result = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( result, _mm_srli_si128( result, 8 ) ), round ), 8 );
+			return static_cast<uint32_t>( _mm_cvtsi128_si32( _mm_packus_epi16( result, result ) ) );
+		}
+#endif
+		uint32_t pixels[4];
+		for( int i = 0; i < 4; i++ )
+			pixels[i] = taps[i] >= 0xFF000000 ? 0xFF000000 : taps[i];
+
+		uint32_t result = 0;
+		for( int shift = 0; shift < 32; shift += 8 )
+		{
+			uint32_t top = ( ( ( ( pixels[0] >> shift ) & 0xFF ) * ( 0x100 - fracX ) ) + ( ( ( pixels[1] >> shift ) & 0xFF ) * fracX ) + 0x80 ) >> 8;
+			uint32_t bottom = ( ( ( ( pixels[2] >> shift ) & 0xFF ) * ( 0x100 - fracX ) ) + ( ( ( pixels[3] >> shift ) & 0xFF ) * fracX ) + 0x80 ) >> 8;
+			result |= ( ( ( top * ( 0x100 - fracY ) ) + ( bottom * fracY ) + 0x80 ) >> 8 ) << shift;
+		}
+		return result;
+	}
+
+	// Filters the 2x2 block of pre-multiplied pixels around a 16.16 fixed point position within a sprite frame
+	// > Pixels outside the frame are treated as fully transparent
+	inline uint32_t SampleBilinear( const uint32_t* pFrame, int stride, int width, int height, int64_t posx, int64_t posy )
+	{
+		int x0 = static_cast<int>( posx >> 16 );
+		int y0 = static_cast<int>( posy >> 16 );
+		uint32_t fracX = static_cast<uint32_t>( posx >> 8 ) & 0xFF;
+		uint32_t fracY = static_cast<uint32_t>( posy >> 8 ) & 0xFF;
+
+		uint32_t taps[4];
+		if( x0 >= 0 && y0 >= 0 && x0 + 1 < width && y0 + 1 < height )
+		{
+			const uint32_t* pTop = pFrame + ( y0 * stride ) + x0;
+			taps[0] = pTop[0];
+			taps[1] = pTop[1];
+			taps[2] = pTop[stride];
+			taps[3] = pTop[stride + 1];
+		}
+		else
+		{
+			// Around the edges of the frame
+			for( int i = 0; i < 4; i++ )
+			{
+				int x = x0 + ( i & 1 );
+				int y = y0 + ( i >> 1 );
+				taps[i] = ( x >= 0 && y >= 0 && x < width && y < height ) ? pFrame[( y * stride ) + x] : 0xFF000000;
+			}
+		}
+		return FilterBilinear( taps, fracX, fracY );
+	}
+
+	// Narrows the range [entry, exit) to the values of t where ( start + t * step ) lies between min and max
+	// > The result is approximate at the boundaries, so callers should pad it and test each pixel
+	inline void ClipScanline( float start, float step, float min, float max, float& entry, float& exit )
+	{
+		if( step == 0.0f )
+		{
+			if( start < min || start > max )
+				exit = entry;
+			return;
+		}
+
+		float tMin = ( min - start ) / step;
+		float tMax = ( max - start ) / step;
+		if( tMin > tMax ) std::swap( tMin, tMax );
+		if( tMin > entry ) entry = tMin;
+		if( tMax < exit ) exit = tMax;
+	}
+
+	// Works out the run lengths of the fully transparent pixels in a row of pre-multiplied pixels which has been put together from other pixels
+	inline void CountTransparentRuns( uint32_t* pixels, int count )
+	{
+		uint32_t run = 0;
+		for( int i = count - 1; i >= 0; i-- )
+		{
+			if( pixels[i] >= 0xFF000000 )
+				pixels[i] = 0xFF000000 | run++;
+			else
+				run = 0;
+		}
+	}
+
+	// Copies a row of pre-multiplied pixels into a buffer in reverse order, so that it can be drawn mirrored
+	// > Fully transparent pixels store how many transparent pixels follow them, so the counts are worked out again for the new order
+	inline void ReverseRow( const uint32_t* src, uint32_t* dest, int count )
+	{
+		uint32_t run = 0;
+		for( int i = 0; i < count; i++ )
+		{
+			if( src[i] >= 0xFF000000 )
+				dest[count - 1 - i] = 0xFF000000 | run++;
+			else
+			{
+				dest[count - 1 - i] = src[i];
+				run = 0;
+			}
+		}
+	}
+
+	// Primitive drawing functions
+	//********************************************************************************************************************************
+
+	// Sets the colour of an individual pixel on the render target
+	template< typename TBlend > void DrawPixel(int posX, int posY, Pixel pix);
+	// Sets the colour of an individual pixel on the render target
+	template< typename TBlend > void DrawPixelPreMult(int posX, int posY, Pixel pix);
+
+	// Draws a line of pixels into the render target, from the start pixel to the end pixel (in render target pixels from the top left)
+	// > Clipped to the drawable area before any pixels are drawn, and drawn by stepping a pointer through the render target
+	// > A line with the same start and end draws nothing. The colour is pre-multiplied first unless preMultiply = false (see FillSpan)
+	template< typename TBlend > void DrawLine(int startX, int startY, int endX, int endY, Pixel pix, bool preMultiply = true);
+	// How the ends of a thick line are drawn
+	enum LineCap
+	{
+		CAP_BUTT = 0, // Flat, ending exactly at the end points
+		CAP_SQUARE, // Flat, carrying on for half the thickness past the end points
+		CAP_ROUND, // A semicircle around each end point
+	};
+
+	// Draws an anti-aliased one pixel wide line into the render target using Xiaolin Wu's algorithm
+	// > Positions are in render target pixels from the top left, where whole numbers are the centres of pixels
+	// > Each pixel is blended with the colour's alpha scaled by how much of the pixel the line covers
+	template< typename TBlend > void DrawLineAA(float startX, float startY, float endX, float endY, Pixel pix, bool preMultiply = true);
+	// Draws a line of any thickness into the render target with anti-aliased edges (positions as for DrawLineAA)
+	// > Each row is split into the fully covered pixels, which are filled as a span, and the edge pixels which are blended by their coverage
+	template< typename TBlend > void DrawThickLine(float startX, float startY, float endX, float endY, float thickness, Pixel pix, LineCap cap, bool preMultiply = true);
+	// Fills a run of pixels on one row of the render target, from startX up to (but not including) endX
+	// > Clipped once for the whole run, which is then blended as a row so the blend policies can process several pixels at once
+	// > The colour is pre-multiplied first unless preMultiply = false, which multiply blending needs (as with DrawPixel and DrawPixelPreMult)
+	template< typename TBlend > void FillSpan(int posY, int startX, int endX, Pixel pix, bool preMultiply = true);
+	// Fills a rectangle of the render target (right and bottom are exclusive)
+	template< typename TBlend > void FillRect(int left, int top, int right, int bottom, Pixel pix, bool preMultiply = true);
+	// Draws an ellipse into the render target one row at a time, either filled or as a one pixel outline
+	template< typename TBlend > void DrawEllipse(int centreX, int centreY, int radiusX, int radiusY, Pixel pix, bool fill, bool preMultiply = true);
+	// Fills a polygon given in render target pixels from the top left, which can be concave or even cross itself (using the even-odd rule)
+	// > Pixels are filled when their centre is inside the polygon, so polygons which share an edge don't overlap
+	template< typename TBlend > void FillPolygon(const Point2f* pPoints, int numPoints, Pixel pix, bool preMultiply = true);
+	// Mirrors the pixel data drawn by BlitPixels (the flags can be combined)
+	enum FlipFlags
+	{
+		FLIP_NONE = 0,
+		FLIP_HORIZONTAL = 1, // Swaps the left and right of the image
+		FLIP_VERTICAL = 2, // Swaps the top and bottom of the image
+		FLIP_BOTH = FLIP_HORIZONTAL | FLIP_VERTICAL,
+	};
+
+	// Draws pixel data to the render target using a direct copy
+	// > Setting alphaMultiply < 1 forces a less optimal rendering approach (~50% slower) 
+	// > Providing a span table (and the index of the first frame row within it) lets whole runs of pixels be skipped or copied
+	// > Flipping doesn't need the transform path: the source rows are just read from the other end (see FlipFlags)
+	template< typename TBlend > void BlitPixels(const PixelData& srcImage, int srcOffset, int blitX, int blitY, int blitWidth, int blitHeight, BlendColour globalMultiply, const SpanTable* pSpans = nullptr, int spanRow = 0, int flip = FLIP_NONE );
+	// Draws 8-bit palette-indexed pixel data to the render target in the same way as BlitPixels
+	// > Each pixel the span table says is visible is looked up in a palette which is already pre-multiplied (as PreMultiplyAlpha stores it)
+	template< typename TBlend > void BlitIndexedPixels(const uint8_t* pIndices, int indicesWidth, const Pixel* pPalette, int srcOffset, int blitX, int blitY, int blitWidth, int blitHeight, BlendColour globalMultiply, const SpanTable& spans, int spanRow, int flip = FLIP_NONE );
+	// Draws rotated and scaled pixel data to the render target (much slower than BlitPixels)
+	// > Setting alphaMultiply < 1 is not much slower overall (~10% slower) 
+	template< typename TBlend > void RotateScalePixels(const PixelData& srcPixelData, int srcFrameOffset, int srcWidth, int srcHeight, const Point2f& origin, const Matrix2D& m, BlendColour globalMultiply);
+	// Clears the render target using the given pixel colour
+	void ClearRenderTarget( Pixel colour );
+	// Copies a background image of the correct size to the render target
+	void BlitBackground( PixelData& backgroundImage );
+	// Calculates the area of the render target (in pixels from the top left) which TransformPixels could draw to
+	ClipRect GetTransformedBounds( int srcDrawWidth, int srcDrawHeight, const Point2f& srcOrigin, const Matrix2D& transform );
+	// Draws scaled and flipped pixel data to the render target using a table of source columns (much faster than TransformPixels)
+	// > The transform mustn't rotate (see IsAxisAligned) and the pixel data must be pre-multiplied or multiply factors, as run lengths are rebuilt
+	template< typename TBlend > void ScalePixels(const PixelData& srcPixelData, int srcFrameOffset, int srcDrawWidth, int srcDrawHeight, const Point2f& srcOrigin, const Matrix2D& transform, BlendColour globalMultiply, SamplingMode samplingMode = SAMPLE_DEFAULT);
+
+	// Draws a render target's pixels (where anything drawn is opaque and an alpha of 0 is empty) to the current render target
+	// > Each row is converted into pre-multiplied pixels in a buffer as it is drawn, so the source isn't changed and can be drawn again
+	// > The source must be a different buffer to the current render target. Set preMultiply = false for multiply blending, which reads the pixels as they are
+	template< typename TBlend > void CompositePixels(const PixelData& srcPixelData, int blitX, int blitY, BlendColour globalMultiply, bool preMultiply = true);
+
+	// The part of the render target covered by a transformed draw, and the matching position in the sprite
+	struct TransformedArea
+	{
+		int dstX{ 0 }, dstY{ 0 }; // The top left of the drawing area in the render target
+		int width{ 0 }, height{ 0 }; // The size of the drawing area (before the clip rectangle is applied)
+		int rowBegin{ 0 }, rowEnd{ 0 }, columnBegin{ 0 }, columnEnd{ 0 }; // The part of the drawing area inside the clip rectangle
+		Point2f srcStart; // The sprite position of the drawing area's top left pixel
+		Matrix2D invTransform; // Steps across the sprite one render target pixel at a time
+	};
+
+	// Works out the area of the render target which TransformPixels and ScalePixels draw to, returning false when nothing would be drawn
+	bool GetTransformedArea( int srcDrawWidth, int srcDrawHeight, const Point2f& srcOrigin, const Matrix2D& transform, TransformedArea& area );
+
+	// Renders rotated and scaled pre-multiplied pixel data (with a global multiply applied) into a new pre-multiplied buffer, rather than the render target
+	// > Used to cache the result so it can be drawn with BlitPixels. Any translation in the transform is ignored, and the top left of the result is at
+	// > (offsetX, offsetY) render target pixels from the origin. The caller owns the new pixels, which have their transparent run lengths worked out
+	void TransformToPixels( const PixelData& srcPixelData, int srcFrameOffset, int srcDrawWidth, int srcDrawHeight, const Point2f& srcOrigin, const Matrix2D& transform, BlendColour globalMultiply, SamplingMode samplingMode, PixelData& result, int& offsetX, int& offsetY );
+
+	// Whether a transform only scales, flips and translates, so it can be drawn with ScalePixels
+	inline bool IsAxisAligned( const Matrix2D& transform )
+	{
+		return transform.row[0].y == 0.0f && transform.row[1].x == 0.0f && transform.row[0].x != 0.0f && transform.row[1].y != 0.0f;
+	}
+
+	//********************************************************************************************************************************
+	// Function:	BlitPixels - draws image data with and without a global alpha multiply
+	// Parameters:	spriteId = the id of the sprite to draw
+	//				xpos, ypos = the position you want to draw the sprite
+	//				frameIndex = which frame of the animation to draw (wrapped)
+	//				pSpans, spanRow = optional span table for the source data and the index of the frame's first row within it
+	//				flip = any combination of FlipFlags
+	// Notes:		Blend implmentation depends on TBlend class (see PlayBlends.h) - should all end up inlined!
+	//				Horizontally flipped spans are reversed into a buffer so they can still use the row blend functions
+	//********************************************************************************************************************************
+	template< typename TBlend > void BlitPixels(const PixelData& srcPixelData, int srcOffset, int blitX, int blitY, int blitWidth, int blitHeight, BlendColour globalMultiply, const SpanTable* pSpans, int spanRow, int flip)
+	{
+		blitY = m_pRenderTarget->height - blitY; // Flip the y-coordinate to be consistant with a Cartesian co-ordinate system
+
+		// Nothing within the display buffer (or clip rectangle) to draw
+		ClipRect clip = GetDrawableRect();
+		if (blitX >= clip.right || blitX + blitWidth <= clip.left || blitY >= clip.bottom || blitY + blitHeight <= clip.top)
+			return;
+
+		// Work out if we need to clip to the display buffer (and by how much)
+		int xClipStart = clip.left - blitX;
+		if (xClipStart < 0) { xClipStart = 0; }
+
+		int xClipEnd = (blitX + blitWidth) - clip.right;
+		if (xClipEnd < 0) { xClipEnd = 0; }
+
+		int yClipStart = clip.top - blitY;
+		if (yClipStart < 0) { yClipStart = 0; }
+
+		int yClipEnd = (blitY + blitHeight) - clip.bottom;
+		if (yClipEnd < 0) { yClipEnd = 0; }
+
+		// Set up the source pointer and destination offset based on clipping
+		size_t destOffset = (static_cast<size_t>(m_pRenderTarget->width) * (blitY + yClipStart)) + (blitX + xClipStart);
+
+		// When flipped, the pixels clipped off one side of the destination come off the opposite side of the source
+		bool flipX = (flip & FLIP_HORIZONTAL) != 0;
+		bool flipY = (flip & FLIP_VERTICAL) != 0;
+		int srcFirstRow = flipY ? blitHeight - 1 - yClipStart : yClipStart;
+		int srcFirstColumn = flipX ? xClipEnd : xClipStart;
+		int srcRowInc = flipY ? -srcPixelData.width : srcPixelData.width;
+
+		int srcClipOffset = (srcPixelData.width * srcFirstRow) + srcFirstColumn;
+		uint32_t* srcPixels = &srcPixelData.pPixels->bits + srcOffset + srcClipOffset;
+
+		// How many rows are drawn, and how many pixels per row in sprite
+		int rows = blitHeight - yClipEnd - yClipStart;
+		int endRow = blitWidth - xClipEnd - xClipStart;
+
+		bool multiply = globalMultiply.alpha < 1.0f || globalMultiply.red < 1.0f || globalMultiply.green < 1.0f || globalMultiply.blue < 1.0f;
+
+		// The global multiply is converted to fixed point once for the whole blit
+		BlendFactors factors = GetBlendFactors( globalMultiply );
+
+		// Each row of the render target is locked while it is drawn, so the blends work the same way on a 16-bit target
+		if (pSpans)
+		{
+			// Only the parts of each span which fall inside the clipped row get drawn
+			int visibleEnd = srcFirstColumn + endRow;
+			int spanRowInc = flipY ? -pSpans->framesPerRow : pSpans->framesPerRow;
+			spanRow += srcFirstRow * pSpans->framesPerRow;
+
+			thread_local std::vector< uint32_t > reversed;
+			if (flipX)
+				reversed.resize(endRow);
+
+			for (int row = 0; row < rows; row++)
+			{
+				uint32_t* destPixels = LockTargetPixels(destOffset, endRow);
+				const PixelSpan* span = pSpans->spans.data() + pSpans->rowIndex[spanRow];
+				const PixelSpan* spanEnd = pSpans->spans.data() + pSpans->rowIndex[spanRow + 1];
+
+				for (; span < spanEnd; span++)
+				{
+					int start = span->start > srcFirstColumn ? span->start : srcFirstColumn;
+					int end = span->start + span->length < visibleEnd ? span->start + span->length : visibleEnd;
+					if (span->type == SPAN_TRANSPARENT || start >= end)
+						continue;
+
+					uint32_t* spanSrc = srcPixels + (start - srcFirstColumn);
+					uint32_t* spanDest = destPixels + (start - srcFirstColumn);
+					if (flipX)
+					{
+						// The last pixel of the span is drawn first, and opaque spans don't have any run lengths to fix up
+						if (span->type == SPAN_OPAQUE)
+							std::reverse_copy(spanSrc, spanSrc + (end - start), reversed.data());
+						else
+							ReverseRow(spanSrc, reversed.data(), end - start);
+						spanSrc = reversed.data();
+						spanDest = destPixels + (visibleEnd - end);
+					}
+					uint32_t* spanDestEnd = spanDest + (end - start);
+
+					if (multiply)
+						TBlend::BlendRow(spanSrc, spanDest, factors, spanDestEnd);
+					else if (span->type == SPAN_OPAQUE)
+						TBlend::BlendOpaqueRow(spanSrc, spanDest, spanDestEnd);
+					else
+						TBlend::BlendFastRow(spanSrc, spanDest, spanDestEnd);
+				}
+
+				// Move on to the next row of the frame
+				UnlockTargetPixels(destPixels, destOffset, endRow);
+				destOffset += m_pRenderTarget->width;
+				srcPixels += srcRowInc;
+				spanRow += spanRowInc;
+			}
+		}
+		else if (flipX)
+		{
+			// Without a span table the source may not store run lengths (e.g. the canvas buffer used for multiply blending),
+			// so mirrored rows are blended a pixel at a time
+			for (int row = 0; row < rows; row++)
+			{
+				uint32_t* destRow = LockTargetPixels(destOffset, endRow);
+				uint32_t* destRowEnd = destRow + endRow;
+				uint32_t* src = srcPixels + endRow - 1;
+				for (uint32_t* destPixels = destRow; destPixels < destRowEnd; destPixels++, src--)
+				{
+					if (multiply)
+						TBlend::Blend(src, destPixels, factors);
+					else
+						TBlend::BlendUnit(src, destPixels);
+				}
+
+				UnlockTargetPixels(destRow, destOffset, endRow);
+				destOffset += m_pRenderTarget->width;
+				srcPixels += srcRowInc;
+			}
+		}
+		else
+		{
+			for (int row = 0; row < rows; row++)
+			{
+				uint32_t* destRow = LockTargetPixels(destOffset, endRow);
+				uint32_t* destPixels = destRow;
+				uint32_t* src = srcPixels;
+
+				// Call the more versatile global multiply blend function, or the fastest available one without a multiply
+				if (multiply)
+					TBlend::BlendRow(src, destPixels, factors, destRow + endRow);
+				else
+					TBlend::BlendFastRow(src, destPixels, destRow + endRow);
+
+				UnlockTargetPixels(destRow, destOffset, endRow);
+				destOffset += m_pRenderTarget->width;
+				srcPixels += srcRowInc;
+			}
+		}
+
+		return;
+	}
+
+	// Looks up a row of 8-bit indices in a palette, gathering eight pixels at once when the processor supports it
+	inline void LookUpPalette(const uint8_t* pIndices, const Pixel* pPalette, Pixel* pDest, int count)
+	{
+		int x = 0;
+#ifdef PLAY_SIMD_X86
+		if (m_simdLevel == SimdLevel::AVX2)
+		{
+			const int* pTable = reinterpret_cast<const int*>(pPalette);
+			for (; x + 8 <= count; x += 8)
+			{
+				__m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pIndices + x)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDest + x), _mm256_i32gather_epi32(pTable, indices, 4));
+			}
+		}
+#endif
+		for (; x < count; x++)
+			pDest[x] = pPalette[pIndices[x]];
+	}
+
+	template< typename TBlend > void BlitIndexedPixels(const uint8_t* pIndices, int indicesWidth, const Pixel* pPalette, int srcOffset, int blitX, int blitY, int blitWidth, int blitHeight, BlendColour globalMultiply, const SpanTable& spans, int spanRow, int flip)
+	{
+		blitY = m_pRenderTarget->height - blitY; // Flip the y-coordinate to be consistant with a Cartesian co-ordinate system
+
+		// Nothing within the display buffer (or clip rectangle) to draw, so nothing to look up
+		ClipRect clip = GetDrawableRect();
+		if (blitX >= clip.right || blitX + blitWidth <= clip.left || blitY >= clip.bottom || blitY + blitHeight <= clip.top)
+			return;
+
+		// The same clipping as BlitPixels
+		int xClipStart = clip.left - blitX;
+		if (xClipStart < 0) { xClipStart = 0; }
+
+		int xClipEnd = (blitX + blitWidth) - clip.right;
+		if (xClipEnd < 0) { xClipEnd = 0; }
+
+		int yClipStart = clip.top - blitY;
+		if (yClipStart < 0) { yClipStart = 0; }
+
+		int yClipEnd = (blitY + blitHeight) - clip.bottom;
+		if (yClipEnd < 0) { yClipEnd = 0; }
+
+		size_t destOffset = (static_cast<size_t>(m_pRenderTarget->width) * (blitY + yClipStart)) + (blitX + xClipStart);
+
+		bool flipX = (flip & FLIP_HORIZONTAL) != 0;
+		bool flipY = (flip & FLIP_VERTICAL) != 0;
+		int srcFirstRow = flipY ? blitHeight - 1 - yClipStart : yClipStart;
+		int srcFirstColumn = flipX ? xClipEnd : xClipStart;
+		int srcRowInc = flipY ? -indicesWidth : indicesWidth;
+		const uint8_t* srcIndices = pIndices + srcOffset + (indicesWidth * srcFirstRow) + srcFirstColumn;
+
+		int rows = blitHeight - yClipEnd - yClipStart;
+		int endRow = blitWidth - xClipEnd - xClipStart;
+		int visibleEnd = srcFirstColumn + endRow;
+		int spanRowInc = flipY ? -spans.framesPerRow : spans.framesPerRow;
+		spanRow += srcFirstRow * spans.framesPerRow;
+
+		bool multiply = globalMultiply.alpha < 1.0f || globalMultiply.red < 1.0f || globalMultiply.green < 1.0f || globalMultiply.blue < 1.0f;
+		BlendFactors factors = GetBlendFactors( globalMultiply );
+
+		// Each span is looked up in the pre-multiplied palette just before it is blended, so the looked up pixels never leave the cache
+		// > Transparent palette entries have a run length of zero, so the few inside translucent spans are skipped one at a time, and
+		// > mirrored spans can be looked up backwards without fixing up any run lengths
+		thread_local std::vector< Pixel > spanPixels;
+		if (spanPixels.size() < static_cast<size_t>(endRow))
+			spanPixels.resize(endRow);
+
+		for (int row = 0; row < rows; row++)
+		{
+			uint32_t* destPixels = LockTargetPixels(destOffset, endRow);
+			const PixelSpan* span = spans.spans.data() + spans.rowIndex[spanRow];
+			const PixelSpan* spanEnd = spans.spans.data() + spans.rowIndex[spanRow + 1];
+
+			for (; span < spanEnd; span++)
+			{
+				int start = span->start > srcFirstColumn ? span->start : srcFirstColumn;
+				int end = span->start + span->length < visibleEnd ? span->start + span->length : visibleEnd;
+				if (span->type == SPAN_TRANSPARENT || start >= end)
+					continue;
+
+				const uint8_t* spanIndices = srcIndices + (start - srcFirstColumn);
+				uint32_t* spanDest = destPixels + (start - srcFirstColumn);
+				if (flipX)
+				{
+					for (int x = 0; x < end - start; x++)
+						spanPixels[x] = pPalette[spanIndices[end - start - 1 - x]];
+					spanDest = destPixels + (visibleEnd - end);
+				}
+				else
+				{
+					LookUpPalette(spanIndices, pPalette, spanPixels.data(), end - start);
+				}
+				uint32_t* spanSrc = &spanPixels.data()->bits;
+				uint32_t* spanDestEnd = spanDest + (end - start);
+
+				if (multiply)
+					TBlend::BlendRow(spanSrc, spanDest, factors, spanDestEnd);
+				else if (span->type == SPAN_OPAQUE)
+					TBlend::BlendOpaqueRow(spanSrc, spanDest, spanDestEnd);
+				else
+					TBlend::BlendFastRow(spanSrc, spanDest, spanDestEnd);
+			}
+
+			UnlockTargetPixels(destPixels, destOffset, endRow);
+			destOffset += m_pRenderTarget->width;
+			srcIndices += srcRowInc;
+			spanRow += spanRowInc;
+		}
+	}
+
+	//********************************************************************************************************************************
+	// Function:	TransformPixels - draws the image data transforming each screen pixel into image space
+	// Parameters:	srcPixelData = the pixel data you want to draw
+	//				srcFrameOffset = the horizontal pixel offset for the required animation frame within the PixelData
+	//				srcDrawWidth, srcDrawHeight = the width and height of the source image frame
+	//				srcOrigin = the centre of rotation for the source image
+	//				alphaMultiply = additional transparancy applied to the whole sprite
+	//				samplingMode = how the source pixels are sampled (see SetSamplingMode), SAMPLE_BILINEAR needs pre-multiplied data
+	// Notes:		Much slower than BlitPixels, alphaMultiply is a negligable overhead compared to the rotation
+	//				Only the part of each row which maps inside the sprite is visited
+	//********************************************************************************************************************************
+	template< typename TBlend > void TransformPixels(const PixelData& srcPixelData, int srcFrameOffset, int srcDrawWidth, int srcDrawHeight, const Point2f& srcOrigin, const Matrix2D& transform, BlendColour globalMultiply, SamplingMode samplingMode = SAMPLE_DEFAULT)
+	{
+		// Work out which part of the render target is covered and where its first pixel lies within the sprite
+		TransformedArea area;
+		if (!GetTransformedArea(srcDrawWidth, srcDrawHeight, srcOrigin, transform, area))
+			return;
+
+		int dst_buffer_width = m_pRenderTarget->width;
+		int dst_draw_width = area.width;
+		int row_begin = area.rowBegin;
+		int row_end = area.rowEnd;
+		int column_begin = area.columnBegin;
+		int column_end = area.columnEnd;
+		const Matrix2D& invTransform = area.invTransform;
+
+		// We need floating point for the sprite space as one pixel on the render target is not a whole pixel in the sprite
+		float src_posx = area.srcStart.x;
+		float src_posy = area.srcStart.y;
+
+		// Integer arithmetic is best for the render target as we're working in whole pixels
+		int dst_posx = area.dstX;
+		int dst_posy = area.dstY;
+
+		// The inverse transform matrix contains axis unit vectors for navigating render target space within sprite space
+		float src_xincx = invTransform.row[0].x;
+		float src_xincy = invTransform.row[0].y;
+		float src_yincx = invTransform.row[1].x;
+		float src_yincy = invTransform.row[1].y;
+
+		// The same position and unit vectors in 16.16 fixed point for integer stepping
+		if (samplingMode == SAMPLE_DEFAULT) samplingMode = m_samplingMode;
+		bool fixedPoint = samplingMode != SAMPLE_NEAREST_FLOAT;
+		bool bilinear = samplingMode == SAMPLE_BILINEAR;
+		const uint32_t* src_frame = (uint32_t*)srcPixelData.pPixels + srcFrameOffset;
+		int64_t fix_posx = ToFixed16(src_posx);
+		int64_t fix_posy = ToFixed16(src_posy);
+		int64_t fix_xincx = ToFixed16(src_xincx);
+		int64_t fix_xincy = ToFixed16(src_xincy);
+		int64_t fix_yincx = ToFixed16(src_yincx);
+		int64_t fix_yincy = ToFixed16(src_yincy);
+
+		// Without a global multiply the blend doesn't need to apply any multipliers, otherwise they are converted to fixed point once for the whole draw
+		bool unitMultiply = globalMultiply.alpha == 1.0f && globalMultiply.red == 1.0f && globalMultiply.green == 1.0f && globalMultiply.blue == 1.0f;
+		BlendFactors factors = GetBlendFactors( globalMultiply );
+
+		// Calculate the pixel start position within the render target buffer
+		size_t dst_row_offset = dst_posx + (static_cast<size_t>(dst_posy) * dst_buffer_width);
+
+		// Iterate through the rows of the drawing area within the render target buffer
+		dst_row_offset += static_cast<size_t>(row_begin) * dst_buffer_width;
+		for (int row = row_begin; row < row_end; row++, dst_row_offset += dst_buffer_width)
+		{
+			// One vertical pixel in the render target corresponds to the y axis of the inverse matrix in sprite space
+			float row_posx = src_posx + row * src_yincx;
+			float row_posy = src_posy + row * src_yincy;
+			int64_t fix_row_posx = fix_posx + row * fix_yincx;
+			int64_t fix_row_posy = fix_posy + row * fix_yincy;
+
+			// Work out where this row enters and leaves the sprite (a pixel is inside when its rounded position is within the sprite)
+			float entry = 0.0f;
+			float exit = static_cast<float>(dst_draw_width);
+			float fix_scale = 1.0f / 65536.0f;
+			if (bilinear)
+			{
+				// Filtered pixels are affected by the sprite anywhere within (-1, size)
+				ClipScanline(fix_row_posx * fix_scale, fix_xincx * fix_scale, -1.0f, (float)srcDrawWidth, entry, exit);
+				ClipScanline(fix_row_posy * fix_scale, fix_xincy * fix_scale, -1.0f, (float)srcDrawHeight, entry, exit);
+			}
+			else if (fixedPoint)
+			{
+				// Fixed point positions round down, so the sprite covers [-0.5, size-0.5)
+				ClipScanline(fix_row_posx * fix_scale, fix_xincx * fix_scale, -0.5f, srcDrawWidth - 0.5f, entry, exit);
+				ClipScanline(fix_row_posy * fix_scale, fix_xincy * fix_scale, -0.5f, srcDrawHeight - 0.5f, entry, exit);
+			}
+			else
+			{
+				// Float positions are truncated towards zero, so the sprite covers (-1.5, size-0.5)
+				ClipScanline(row_posx, src_xincx, -1.5f, srcDrawWidth - 0.5f, entry, exit);
+				ClipScanline(row_posy, src_xincy, -1.5f, srcDrawHeight - 0.5f, entry, exit);
+			}
+			if (entry >= exit)
+				continue;
+
+			// Allow an extra pixel at either end for rounding errors, the test below has the final say
+			int start = static_cast<int>(entry) - 1;
+			int end = static_cast<int>(exit) + 2;
+			if (start < column_begin) start = column_begin;
+			if (end > column_end) end = column_end;
+			if (start >= end)
+				continue;
+
+			// The part of the row being drawn is locked, so it can be drawn the same way on a 16-bit target
+			uint32_t* dst_row = LockTargetPixels(dst_row_offset + start, end - start);
+			uint32_t* dst_pixel = dst_row;
+			uint32_t* dst_row_end = dst_row + (end - start);
+
+			if (bilinear)
+			{
+				int64_t posx = fix_row_posx + start * fix_xincx;
+				int64_t posy = fix_row_posy + start * fix_xincy;
+				for (; dst_pixel < dst_row_end; dst_pixel++, posx += fix_xincx, posy += fix_xincy)
+				{
+					// The top left pixel of the 2x2 block being filtered
+					int64_t floorX = posx >> 16;
+					int64_t floorY = posy >> 16;
+
+					if (floorX >= -1 && floorY >= -1 && floorX < srcDrawWidth && floorY < srcDrawHeight)
+					{
+						uint32_t filtered = SampleBilinear(src_frame, srcPixelData.width, srcDrawWidth, srcDrawHeight, posx, posy);
+						uint32_t* src = &filtered;
+
+						if (unitMultiply)
+							TBlend::BlendUnit(src, dst_pixel);
+						else
+							TBlend::Blend(src, dst_pixel, factors);
+					}
+				}
+			}
+			else if (fixedPoint)
+			{
+				// Everything is stepped in integers, so each pixel's position doesn't depend on where the row was clipped
+				int64_t posx = fix_row_posx + start * fix_xincx;
+				int64_t posy = fix_row_posy + start * fix_xincy;
+				for (; dst_pixel < dst_row_end; dst_pixel++, posx += fix_xincx, posy += fix_xincy)
+				{
+					// The origin of a pixel is in its centre
+					int64_t roundX = (posx + 0x8000) >> 16;
+					int64_t roundY = (posy + 0x8000) >> 16;
+
+					// Clip within the sprite boundaries
+					if (roundX >= 0 && roundY >= 0 && roundX < srcDrawWidth && roundY < srcDrawHeight)
+					{
+						uint32_t* src = (uint32_t*)src_frame + roundX + (roundY * srcPixelData.width);
+
+						// Perform the appropriate blend using a template
+						if (unitMultiply)
+							TBlend::BlendUnit(src, dst_pixel);
+						else
+							TBlend::Blend(src, dst_pixel, factors);
+					}
+				}
+			}
+			else
+			{
+				float column = static_cast<float>(start);
+				for (; dst_pixel < dst_row_end; dst_pixel++, column += 1.0f)
+				{
+					// Move horizontally in the render target, which corresponds to the x axis of the inverse matrix in sprite space
+					float posx = row_posx + column * src_xincx;
+					float posy = row_posy + column * src_xincy;
+
+					// The origin of a pixel is in its centre
+					int roundX = static_cast<int>(posx + 0.5f);
+					int roundY = static_cast<int>(posy + 0.5f);
+
+					// Clip within the sprite boundaries
+					if (roundX >= 0 && roundY >= 0 && roundX < srcDrawWidth && roundY < srcDrawHeight)
+					{
+						int src_pixel_index = roundX + (roundY * srcPixelData.width);
+						uint32_t* src = ((uint32_t*)srcPixelData.pPixels + src_pixel_index + srcFrameOffset);
+
+						// Perform the appropriate blend using a template
+						if (unitMultiply)
+							TBlend::BlendUnit(src, dst_pixel);
+						else
+							TBlend::Blend(src, dst_pixel, factors);
+					}
+				}
+			}
+
+			UnlockTargetPixels(dst_row, dst_row_offset + start, end - start);
+		}
+	}
+
+	//********************************************************************************************************************************
+	// Function:	ScalePixels - draws the image data scaled and flipped, without any rotation
+	// Parameters:	as TransformPixels, but the transform must be axis aligned and SAMPLE_BILINEAR isn't supported
+	// Notes:		The source column for every render target column is worked out once per draw, with exactly the same arithmetic as
+	//				TransformPixels so the same pixels are drawn. Each row of source pixels is gathered into a buffer and blended
+	//				a row at a time with the same blends as TransformPixels (BlendUnitRow, or BlendRow with a global multiply), so the result is identical,
+	//				and rows which sample the same source row (e.g. at a scale of 2x or 3x) just reuse the gathered pixels.
+	//********************************************************************************************************************************
+	template< typename TBlend > void ScalePixels(const PixelData& srcPixelData, int srcFrameOffset, int srcDrawWidth, int srcDrawHeight, const Point2f& srcOrigin, const Matrix2D& transform, BlendColour globalMultiply, SamplingMode samplingMode)
+	{
+		PLAY_ASSERT_MSG(IsAxisAligned(transform), "ScalePixels can't draw a rotated transform");
+
+		TransformedArea area;
+		if (!GetTransformedArea(srcDrawWidth, srcDrawHeight, srcOrigin, transform, area))
+			return;
+
+		if (samplingMode == SAMPLE_DEFAULT) samplingMode = m_samplingMode;
+		PLAY_ASSERT_MSG(samplingMode != SAMPLE_BILINEAR, "ScalePixels doesn't support bilinear sampling");
+		bool fixedPoint = samplingMode != SAMPLE_NEAREST_FLOAT;
+
+		// Only the diagonal of the inverse transform is used, as a row of the render target stays on one row of the sprite
+		float src_posx = area.srcStart.x;
+		float src_posy = area.srcStart.y;
+		float src_xincx = area.invTransform.row[0].x;
+		float src_yincy = area.invTransform.row[1].y;
+		int64_t fix_posx = ToFixed16(src_posx);
+		int64_t fix_posy = ToFixed16(src_posy);
+		int64_t fix_xincx = ToFixed16(src_xincx);
+		int64_t fix_yincy = ToFixed16(src_yincy);
+
+		// Work out the source column for each column of the drawing area. The rounding matches TransformPixels, and as the columns
+		// only move in one direction the ones inside the sprite are all together
+		thread_local std::vector< int > columns;
+		columns.resize(area.columnEnd - area.columnBegin);
+		int first = area.columnEnd;
+		int last = area.columnBegin - 1;
+		for (int column = area.columnBegin; column < area.columnEnd; column++)
+		{
+			int64_t roundX = fixedPoint ? (fix_posx + column * fix_xincx + 0x8000) >> 16 : static_cast<int>(src_posx + static_cast<float>(column) * src_xincx + 0.5f);
+			if (roundX < 0 || roundX >= srcDrawWidth)
+				continue;
+			columns[column - area.columnBegin] = static_cast<int>(roundX);
+			if (column < first) first = column;
+			last = column;
+		}
+
+		if (first > last)
+			return;
+
+		// Without a global multiply the blend doesn't need to apply any multipliers, otherwise they are converted to fixed point once for the whole draw
+		bool unitMultiply = globalMultiply.alpha == 1.0f && globalMultiply.red == 1.0f && globalMultiply.green == 1.0f && globalMultiply.blue == 1.0f;
+		BlendFactors factors = GetBlendFactors( globalMultiply );
+
+		thread_local std::vector< uint32_t > gathered;
+		gathered.resize(last - first + 1);
+		const int* pColumns = columns.data() + (first - area.columnBegin);
+		const uint32_t* src_frame = (uint32_t*)srcPixelData.pPixels + srcFrameOffset;
+		int gathered_row = -1;
+
+		int dst_buffer_width = m_pRenderTarget->width;
+		size_t dst_row_offset = area.dstX + first + (static_cast<size_t>(area.dstY + area.rowBegin) * dst_buffer_width);
+		int dst_row_width = last + 1 - first;
+		for (int row = area.rowBegin; row < area.rowEnd; row++, dst_row_offset += dst_buffer_width)
+		{
+			int64_t roundY = fixedPoint ? (fix_posy + row * fix_yincy + 0x8000) >> 16 : static_cast<int>(src_posy + static_cast<float>(row) * src_yincy + 0.5f);
+			if (roundY < 0 || roundY >= srcDrawHeight)
+				continue;
+
+			if (roundY != gathered_row)
+			{
+				const uint32_t* src_row = src_frame + (roundY * srcPixelData.width);
+				for (size_t i = 0; i < gathered.size(); i++)
+					gathered[i] = src_row[pColumns[i]];
+
+				// The run lengths of fully transparent pixels are counted in the source, so they are worked out again for the gathered row
+				CountTransparentRuns(gathered.data(), static_cast<int>(gathered.size()));
+				gathered_row = static_cast<int>(roundY);
+			}
+
+			uint32_t* src = gathered.data();
+			uint32_t* dst_row = LockTargetPixels(dst_row_offset, dst_row_width);
+			uint32_t* dst_pixel = dst_row;
+			uint32_t* dst_row_end = dst_row + dst_row_width;
+
+			// BlendFastRow isn't used, as AlphaBlendPolicy::BlendFast rounds differently to the BlendUnit used by TransformPixels
+			if (unitMultiply)
+				TBlend::BlendUnitRow(src, dst_pixel, dst_row_end);
+			else
+				TBlend::BlendRow(src, dst_pixel, factors, dst_row_end);
+			UnlockTargetPixels(dst_row, dst_row_offset, dst_row_width);
+		}
+	}
+
+	//********************************************************************************************************************************
+	// Function:	CompositePixels - draws a render target to the current render target using any blend policy
+	// Parameters:	srcPixelData = the render target to draw (its alpha is 0 wherever nothing has been drawn)
+	//				blitX, blitY = the position of its top left pixel (with the y-coordinate flipped, as in BlitPixels)
+	//				preMultiply = whether each row is converted to pre-multiplied pixels before blending
+	// Notes:		Render targets aren't pre-multiplied, as the blend policies write opaque pixels, so the conversion is just inverting the alpha.
+	//				Without an alpha, translucent pixels drawn into the source have already been blended with the empty pixels beneath them
+	//********************************************************************************************************************************
+	template< typename TBlend > void CompositePixels(const PixelData& srcPixelData, int blitX, int blitY, BlendColour globalMultiply, bool preMultiply)
+	{
+		PLAY_ASSERT_MSG(&srcPixelData != m_pRenderTarget && srcPixelData.pPixels != m_pRenderTarget->pPixels, "A render target can't be composited into itself");
+		PLAY_ASSERT_MSG(srcPixelData.format == PIXEL_ARGB8888, "Only 32-bit render targets can be composited");
+		blitY = m_pRenderTarget->height - blitY; // Flip the y-coordinate to be consistant with a Cartesian co-ordinate system
+
+		ClipRect clip = GetDrawableRect();
+		int left = std::max(blitX, clip.left);
+		int top = std::max(blitY, clip.top);
+		int right = std::min(blitX + srcPixelData.width, clip.right);
+		int bottom = std::min(blitY + srcPixelData.height, clip.bottom);
+		if (left >= right || top >= bottom)
+			return;
+
+		bool unitMultiply = globalMultiply.alpha == 1.0f && globalMultiply.red == 1.0f && globalMultiply.green == 1.0f && globalMultiply.blue == 1.0f;
+		BlendFactors factors = GetBlendFactors(globalMultiply);
+
+		thread_local std::vector< uint32_t > converted;
+		converted.resize(right - left);
+
+		int dst_buffer_width = m_pRenderTarget->width;
+		const uint32_t* src_row = &srcPixelData.pPixels->bits + ((top - blitY) * srcPixelData.width) + (left - blitX);
+		size_t dst_row_offset = (static_cast<size_t>(top) * dst_buffer_width) + left;
+		for (int y = top; y < bottom; y++, src_row += srcPixelData.width, dst_row_offset += dst_buffer_width)
+		{
+			uint32_t* dst_row = LockTargetPixels(dst_row_offset, right - left);
+			uint32_t* dst_pixel = dst_row;
+			uint32_t* dst_row_end = dst_row + (right - left);
+
+			if (!preMultiply)
+			{
+				// The multiply blend reads the source without changing it, so the row doesn't need copying
+				uint32_t* src = const_cast<uint32_t*>(src_row);
+				TBlend::BlendRow(src, dst_pixel, factors, dst_row_end);
+			}
+			else
+			{
+				for (int i = 0; i < right - left; i++)
+				{
+					uint32_t alpha = src_row[i] >> 24;
+					converted[i] = alpha == 0 ? 0xFF000000 : ((0xFF - alpha) << 24) | (src_row[i] & 0x00FFFFFF);
+				}
+				CountTransparentRuns(converted.data(), right - left);
+
+				uint32_t* src = converted.data();
+				if (unitMultiply)
+					TBlend::BlendFastRow(src, dst_pixel, dst_row_end);
+				else
+					TBlend::BlendRow(src, dst_pixel, factors, dst_row_end);
+			}
+			UnlockTargetPixels(dst_row, dst_row_offset, right - left);
+		}
+	}
+
+	template< typename TBlend > void DrawPixelPreMult(int posX, int posY, Pixel srcPixel)
+	{
+		if (srcPixel.a == 0x00 || posX < 0 || posX >= m_pRenderTarget->width || posY < 0 || posY >= m_pRenderTarget->height)
+			return;
+		if (posX < m_clipRect.left || posX >= m_clipRect.right || posY < m_clipRect.top || posY >= m_clipRect.bottom)
+			return;
+
+		// Pre-multiply alpha and invert
+		srcPixel.r = (srcPixel.r * srcPixel.a) >> 8;
+		srcPixel.g = (srcPixel.g * srcPixel.a) >> 8;
+		srcPixel.b = (srcPixel.b * srcPixel.a) >> 8;
+		srcPixel.a = 0xFF - srcPixel.a;
+
+		size_t offset = (static_cast<size_t>(posY) * m_pRenderTarget->width) + posX;
+		uint32_t* pDest = LockTargetPixels(offset, 1);
+		uint32_t* pSrc = &srcPixel.bits;
+
+		TBlend::Blend(pSrc, pDest, BlendFactors());
+		UnlockTargetPixels(pDest, offset, 1);
+
+		return;
+	}
+
+	template< typename TBlend > void DrawPixel(int posX, int posY, Pixel srcPixel)
+	{
+		if (srcPixel.a == 0x00 || posX < 0 || posX >= m_pRenderTarget->width || posY < 0 || posY >= m_pRenderTarget->height)
+			return;
+		if (posX < m_clipRect.left || posX >= m_clipRect.right || posY < m_clipRect.top || posY >= m_clipRect.bottom)
+			return;
+
+		size_t offset = (static_cast<size_t>(posY) * m_pRenderTarget->width) + posX;
+		uint32_t* pDest = LockTargetPixels(offset, 1);
+		uint32_t* pSrc = &srcPixel.bits;
+
+		TBlend::Blend(pSrc, pDest, BlendFactors());
+		UnlockTargetPixels(pDest, offset, 1);
+
+		return;
+	}
+
+	// Gets the colour the span functions blend with, pre-multiplied in the same way as DrawPixelPreMult
+	inline uint32_t GetFillColour(Pixel pix, bool preMultiply)
+	{
+		if (preMultiply)
+		{
+			pix.r = (pix.r * pix.a) >> 8;
+			pix.g = (pix.g * pix.a) >> 8;
+			pix.b = (pix.b * pix.a) >> 8;
+			pix.a = 0xFF - pix.a;
+		}
+		return pix.bits;
+	}
+
+	// Blends a solid colour into a run of pixels which has already been clipped
+	// > The colour is repeated along a row which is kept between calls, so it only needs filling in again when the colour changes or a longer run is drawn
+	template< typename TBlend > void FillClippedSpan(uint32_t* destPixels, int count, uint32_t srcColour)
+	{
+		thread_local std::vector< uint32_t > solid;
+		thread_local uint32_t solidColour = 0;
+		if (solid.size() < static_cast<size_t>(count) || solidColour != srcColour)
+		{
+			solid.assign(std::max(solid.size(), static_cast<size_t>(count)), srcColour);
+			solidColour = srcColour;
+		}
+
+		uint32_t* src = solid.data();
+		TBlend::BlendRow(src, destPixels, BlendFactors(), destPixels + count);
+	}
+
+	// Blends a solid colour into a run of render target pixels which has already been clipped
+	template< typename TBlend > void FillTargetSpan(int posX, int posY, int count, uint32_t srcColour)
+	{
+		size_t offset = (static_cast<size_t>(posY) * m_pRenderTarget->width) + posX;
+		uint32_t* pDest = LockTargetPixels(offset, count);
+		FillClippedSpan<TBlend>(pDest, count, srcColour);
+		UnlockTargetPixels(pDest, offset, count);
+	}
+
+	template< typename TBlend > void FillSpan(int posY, int startX, int endX, Pixel pix, bool preMultiply)
+	{
+		ClipRect clip = GetDrawableRect();
+		if (pix.a == 0x00 || posY < clip.top || posY >= clip.bottom)
+			return;
+
+		startX = std::max(startX, clip.left);
+		endX = std::min(endX, clip.right);
+		if (startX < endX)
+			FillTargetSpan<TBlend>(startX, posY, endX - startX, GetFillColour(pix, preMultiply));
+	}
+
+	template< typename TBlend > void FillRect(int left, int top, int right, int bottom, Pixel pix, bool preMultiply)
+	{
+		ClipRect clip = GetDrawableRect();
+		left = std::max(left, clip.left);
+		top = std::max(top, clip.top);
+		right = std::min(right, clip.right);
+		bottom = std::min(bottom, clip.bottom);
+		if (pix.a == 0x00 || left >= right || top >= bottom)
+			return;
+
+		uint32_t colour = GetFillColour(pix, preMultiply);
+		for (int y = top; y < bottom; y++)
+			FillTargetSpan<TBlend>(left, y, right - left, colour);
+	}
+
+	//********************************************************************************************************************************
+	// Function:	DrawLine - draws a clipped line one pixel at a time along its longer axis
+	// Parameters:	startX, startY, endX, endY = the first and last pixels of the line (both are drawn)
+	// Notes:		Step i along the longer axis moves round( i * minor / major ) along the shorter one (rounding halves up). This can be 
+	//				inverted to find the first and last steps inside the clip rectangle, so the part of a line which is off the render 
+	//				target costs nothing. Horizontal lines are just a span
+	//********************************************************************************************************************************
+	template< typename TBlend > void DrawLine(int startX, int startY, int endX, int endY, Pixel pix, bool preMultiply)
+	{
+		if (pix.a == 0x00 || (startX == endX && startY == endY))
+			return;
+
+		if (startY == endY)
+		{
+			FillSpan<TBlend>(startY, std::min(startX, endX), std::max(startX, endX) + 1, pix, preMultiply);
+			return;
+		}
+
+		ClipRect clip = GetDrawableRect();
+		if (std::max(startX, endX) < clip.left || std::min(startX, endX) >= clip.right || std::max(startY, endY) < clip.top || std::min(startY, endY) >= clip.bottom)
+			return;
+
+		int stepX = endX < startX ? -1 : 1;
+		int stepY = endY < startY ? -1 : 1;
+		int dx = abs(endX - startX);
+		int dy = abs(endY - startY);
+
+		// Work along the longer (major) axis, in the positive direction of both axes to keep the clipping simple
+		bool xMajor = dx >= dy;
+		int64_t major = xMajor ? dx : dy;
+		int64_t minor = xMajor ? dy : dx;
+		int majorStart = xMajor ? startX * stepX : startY * stepY;
+		int minorStart = xMajor ? startY * stepY : startX * stepX;
+		int majorLow = xMajor ? (stepX > 0 ? clip.left : 1 - clip.right) : (stepY > 0 ? clip.top : 1 - clip.bottom);
+		int majorHigh = xMajor ? (stepX > 0 ? clip.right - 1 : -clip.left) : (stepY > 0 ? clip.bottom - 1 : -clip.top);
+		int minorLow = xMajor ? (stepY > 0 ? clip.top : 1 - clip.bottom) : (stepX > 0 ? clip.left : 1 - clip.right);
+		int minorHigh = xMajor ? (stepY > 0 ? clip.bottom - 1 : -clip.top) : (stepX > 0 ? clip.right - 1 : -clip.left);
+
+		// The steps where the major axis is inside the clip rectangle
+		int64_t first = std::max<int64_t>(0, majorLow - majorStart);
+		int64_t last = std::min<int64_t>(major, majorHigh - majorStart);
+
+		// The steps where the minor axis is inside: the offset at step i is floor( ( 2 * i * minor + major ) / ( 2 * major ) )
+		if (minor > 0)
+		{
+			auto ceilDiv = [](int64_t a, int64_t b) { return a >= 0 ? (a + b - 1) / b : -(-a / b); };
+			first = std::max(first, ceilDiv((2 * major * (minorLow - minorStart)) - major, 2 * minor));
+			last = std::min(last, ceilDiv((2 * major * (minorHigh - minorStart + 1)) - major, 2 * minor) - 1);
+		}
+		else if (minorStart < minorLow || minorStart > minorHigh)
+		{
+			return;
+		}
+		if (first > last)
+			return;
+
+		// The remainder of the division above decides when the minor axis takes a step
+		int64_t numerator = (2 * first * minor) + major;
+		int64_t remainder = numerator % (2 * major);
+		int x = xMajor ? startX + static_cast<int>(first) * stepX : startX + static_cast<int>(numerator / (2 * major)) * stepX;
+		int y = xMajor ? startY + static_cast<int>(numerator / (2 * major)) * stepY : startY + static_cast<int>(first) * stepY;
+
+		ptrdiff_t width = m_pRenderTarget->width;
+		ptrdiff_t majorInc = xMajor ? stepX : stepY * width;
+		ptrdiff_t minorInc = xMajor ? stepY * width : stepX;
+		uint32_t colour = GetFillColour(pix, preMultiply);
+		BlendFactors factors;
+
+		// A 16-bit target has each pixel locked (see LockTargetPixels), but a 32-bit one is still stepped through with a pointer
+		if (m_pRenderTarget->format != PIXEL_ARGB8888)
+		{
+			size_t offset = (y * width) + x;
+			for (int64_t i = first; i <= last; i++)
+			{
+				uint32_t* pSrc = &colour;
+				uint32_t* pPixel = LockTargetPixels(offset, 1);
+				TBlend::Blend(pSrc, pPixel, factors);
+				UnlockTargetPixels(pPixel, offset, 1);
+
+				offset += majorInc;
+				remainder += 2 * minor;
+				if (remainder >= 2 * major)
+				{
+					remainder -= 2 * major;
+					offset += minorInc;
+				}
+			}
+			return;
+		}
+
+		uint32_t* pDest = &m_pRenderTarget->pPixels[(y * width) + x].bits;
+		for (int64_t i = first; i <= last; i++)
+		{
+			uint32_t* pSrc = &colour;
+			uint32_t* pPixel = pDest;
+			TBlend::Blend(pSrc, pPixel, factors);
+
+			pDest += majorInc;
+			remainder += 2 * minor;
+			if (remainder >= 2 * major)
+			{
+				remainder -= 2 * major;
+				pDest += minorInc;
+			}
+		}
+	}
+
+	// Blends a single pixel of the render target with a colour whose alpha is scaled by coverage (0-1), without any bounds checks
+	template< typename TBlend > void BlendCoverage(int posX, int posY, Pixel pix, float coverage, bool preMultiply)
+	{
+		pix.a = static_cast<uint8_t>((pix.a * coverage) + 0.5f);
+		if (pix.a == 0x00)
+			return;
+
+		uint32_t colour = GetFillColour(pix, preMultiply);
+		uint32_t* pSrc = &colour;
+		size_t offset = (static_cast<size_t>(posY) * m_pRenderTarget->width) + posX;
+		uint32_t* pDest = LockTargetPixels(offset, 1);
+		TBlend::Blend(pSrc, pDest, BlendFactors());
+		UnlockTargetPixels(pDest, offset, 1);
+	}
+
+	//********************************************************************************************************************************
+	// Function:	DrawLineAA - draws an anti-aliased line using Xiaolin Wu's algorithm
+	// Parameters:	startX, startY, endX, endY = the ends of the line, where whole numbers are the centres of pixels
+	// Notes:		Every step along the longer axis blends the two pixels either side of the line on the shorter axis. The end pixels are
+	//				also scaled by how far the line reaches into them. Steps outside the clip rectangle are skipped without being visited
+	//********************************************************************************************************************************
+	template< typename TBlend > void DrawLineAA(float startX, float startY, float endX, float endY, Pixel pix, bool preMultiply)
+	{
+		if (pix.a == 0x00)
+			return;
+
+		// Step along x, swapping the axes for steep lines
+		bool steep = fabsf(endY - startY) > fabsf(endX - startX);
+		if (steep)
+		{
+			std::swap(startX, startY);
+			std::swap(endX, endY);
+		}
+		if (startX > endX)
+		{
+			std::swap(startX, endX);
+			std::swap(startY, endY);
+		}
+
+		ClipRect clip = GetDrawableRect();
+		int majorLow = steep ? clip.top : clip.left;
+		int majorHigh = steep ? clip.bottom : clip.right;
+		int minorLow = steep ? clip.left : clip.top;
+		int minorHigh = steep ? clip.right : clip.bottom;
+		if (endX < majorLow - 1 || startX >= majorHigh + 1)
+			return;
+
+		auto plot = [&](int major, int minor, float coverage)
+		{
+			if (major >= majorLow && major < majorHigh && minor >= minorLow && minor < minorHigh)
+			{
+				if (steep)
+					BlendCoverage<TBlend>(minor, major, pix, coverage, preMultiply);
+				else
+					BlendCoverage<TBlend>(major, minor, pix, coverage, preMultiply);
+			}
+		};
+
+		float dx = endX - startX;
+		float gradient = dx == 0.0f ? 1.0f : (endY - startY) / dx;
+
+		// The two end pixels
+		int firstX = static_cast<int>(floorf(startX + 0.5f));
+		float firstY = startY + (gradient * (firstX - startX));
+		float firstGap = 1.0f - ((startX + 0.5f) - floorf(startX + 0.5f));
+		int lastX = static_cast<int>(floorf(endX + 0.5f));
+		float lastY = endY + (gradient * (lastX - endX));
+		float lastGap = (endX + 0.5f) - floorf(endX + 0.5f);
+
+		plot(firstX, static_cast<int>(floorf(firstY)), (1.0f - (firstY - floorf(firstY))) * firstGap);
+		plot(firstX, static_cast<int>(floorf(firstY)) + 1, (firstY - floorf(firstY)) * firstGap);
+		if (lastX != firstX)
+		{
+			plot(lastX, static_cast<int>(floorf(lastY)), (1.0f - (lastY - floorf(lastY))) * lastGap);
+			plot(lastX, static_cast<int>(floorf(lastY)) + 1, (lastY - floorf(lastY)) * lastGap);
+		}
+
+		// The steps in between, starting from the first one inside the clip rectangle (the position isn't accumulated, so clipping doesn't change it)
+		int xEnd = std::min(lastX, majorHigh);
+		for (int x = std::max(firstX + 1, majorLow); x < xEnd; x++)
+		{
+			float y = firstY + (gradient * (x - firstX));
+			int minor = static_cast<int>(floorf(y));
+			float fraction = y - minor;
+			plot(x, minor, 1.0f - fraction);
+			plot(x, minor + 1, fraction);
+		}
+	}
+
+	//********************************************************************************************************************************
+	// Function:	DrawThickLine - draws a thick line with anti-aliased edges as coverage spans
+	// Parameters:	startX, startY, endX, endY = the ends of the line, where whole numbers are the centres of pixels
+	//				thickness = the width of the line in pixels
+	//				cap = how the ends of the line are drawn
+	// Notes:		The line is a rectangle (or a capsule with round caps), so each row crosses it in a single run. The run is worked out
+	//				for the shape grown by half a pixel, where pixels are at least partly covered, and shrunk by half a pixel, where they
+	//				are fully covered. Coverage is approximated from the distance of a pixel's centre to the edge
+	//********************************************************************************************************************************
+	template< typename TBlend > void DrawThickLine(float startX, float startY, float endX, float endY, float thickness, Pixel pix, LineCap cap, bool preMultiply)
+	{
+		if (pix.a == 0x00 || thickness <= 0.0f)
+			return;
+
+		// The direction along the line and across it (a point uses any direction)
+		float length = sqrtf(((endX - startX) * (endX - startX)) + ((endY - startY) * (endY - startY)));
+		float alongX = length > 0.0f ? (endX - startX) / length : 1.0f;
+		float alongY = length > 0.0f ? (endY - startY) / length : 0.0f;
+		float acrossX = -alongY;
+		float acrossY = alongX;
+		float halfWidth = thickness * 0.5f;
+		float extend = cap == CAP_SQUARE ? halfWidth : 0.0f;
+		bool round = cap == CAP_ROUND;
+
+		auto coverage = [&](float x, float y)
+		{
+			float vx = x - startX;
+			float vy = y - startY;
+			float along = (vx * alongX) + (vy * alongY);
+			if (round)
+			{
+				float t = std::clamp(along, 0.0f, length);
+				float distance = sqrtf(((vx - (alongX * t)) * (vx - (alongX * t))) + ((vy - (alongY * t)) * (vy - (alongY * t))));
+				return std::clamp(halfWidth + 0.5f - distance, 0.0f, 1.0f);
+			}
+			float across = fabsf((vx * acrossX) + (vy * acrossY));
+			float beyond = std::max(-along, along - length);
+			return std::clamp(halfWidth + 0.5f - across, 0.0f, 1.0f) * std::clamp(extend + 0.5f - beyond, 0.0f, 1.0f);
+		};
+
+		// Gets the range of x (relative to startX) where a row crosses the shape with its edges moved out by grow pixels
+		auto rowRange = [&](float vy, float grow, float& uMin, float& uMax)
+		{
+			uMin = -FLT_MAX;
+			uMax = FLT_MAX;
+			float radius = halfWidth + grow;
+			if (radius <= 0.0f)
+			{
+				uMin = 0.0f, uMax = -1.0f;
+				return;
+			}
+
+			// Keeps the part of the row where lo <= a * u + b <= hi
+			auto limit = [&](float a, float b, float lo, float hi)
+			{
+				if (lo > hi)
+				{
+					uMin = 0.0f, uMax = -1.0f;
+					return;
+				}
+				if (fabsf(a) < 1e-6f)
+				{
+					if (b < lo || b > hi)
+						uMin = 0.0f, uMax = -1.0f;
+					return;
+				}
+				float u0 = (lo - b) / a;
+				float u1 = (hi - b) / a;
+				uMin = std::max(uMin, std::min(u0, u1));
+				uMax = std::min(uMax, std::max(u0, u1));
+			};
+
+			float ends = round ? 0.0f : extend + grow;
+			limit(acrossX, acrossY * vy, -radius, radius);
+			limit(alongX, alongY * vy, -ends, length + ends);
+			if (!round)
+				return;
+
+			// A capsule also includes the circles around the end points
+			for (float t : { 0.0f, length })
+			{
+				float cy = vy - (alongY * t);
+				if (fabsf(cy) > radius)
+					continue;
+				float cx = alongX * t;
+				float half = sqrtf((radius * radius) - (cy * cy));
+				if (uMin > uMax)
+					uMin = cx - half, uMax = cx + half;
+				else
+					uMin = std::min(uMin, cx - half), uMax = std::max(uMax, cx + half);
+			}
+		};
+
+		float reach = halfWidth + extend + 1.0f;
+		ClipRect clip = GetDrawableRect();
+		int rowBegin = static_cast<int>(std::max(static_cast<float>(clip.top), ceilf(std::min(startY, endY) - reach)));
+		int rowEnd = static_cast<int>(std::min(static_cast<float>(clip.bottom), floorf(std::max(startY, endY) + reach) + 1.0f));
+		uint32_t colour = GetFillColour(pix, preMultiply);
+
+		for (int y = rowBegin; y < rowEnd; y++)
+		{
+			float outerMin, outerMax, innerMin, innerMax;
+			rowRange(y - startY, 0.5f, outerMin, outerMax);
+			if (outerMin > outerMax)
+				continue;
+			rowRange(y - startY, -0.5f, innerMin, innerMax);
+
+			// Clamped before converting to integers, as the ends can be a long way outside the render target
+			auto toColumn = [&](float x) { return static_cast<int>(std::clamp(x, static_cast<float>(clip.left - 1), static_cast<float>(clip.right))); };
+			int outerFirst = std::max(clip.left, toColumn(ceilf(startX + outerMin)));
+			int outerEnd = std::min(clip.right, toColumn(floorf(startX + outerMax)) + 1);
+			int innerFirst = outerEnd, innerEnd = outerEnd;
+			if (innerMin <= innerMax)
+			{
+				innerFirst = std::clamp(toColumn(ceilf(startX + innerMin)), outerFirst, outerEnd);
+				innerEnd = std::clamp(toColumn(floorf(startX + innerMax)) + 1, innerFirst, outerEnd);
+			}
+
+			for (int x = outerFirst; x < innerFirst; x++)
+				BlendCoverage<TBlend>(x, y, pix, coverage(static_cast<float>(x), static_cast<float>(y)), preMultiply);
+			if (innerFirst < innerEnd)
+				FillTargetSpan<TBlend>(innerFirst, y, innerEnd - innerFirst, colour);
+			for (int x = innerEnd; x < outerEnd; x++)
+				BlendCoverage<TBlend>(x, y, pix, coverage(static_cast<float>(x), static_cast<float>(y)), preMultiply);
+		}
+	}
+
+	//********************************************************************************************************************************
+	// Function:	DrawEllipse - draws a filled or outlined ellipse as horizontal runs of pixels
+	// Parameters:	centreX, centreY = the centre of the ellipse in render target pixels from the top left
+	//				radiusX, radiusY = the number of pixels either side of the centre
+	// Notes:		The half width of every row is worked out first. An outline row covers the pixels between its own half width and 
+	//				the smaller of its neighbours', which keeps the outline joined up where it is steep
+	//********************************************************************************************************************************
+	template< typename TBlend > void DrawEllipse(int centreX, int centreY, int radiusX, int radiusY, Pixel pix, bool fill, bool preMultiply)
+	{
+		radiusX = abs(radiusX);
+		radiusY = abs(radiusY);
+		ClipRect clip = GetDrawableRect();
+		if (pix.a == 0x00 || centreX + radiusX < clip.left || centreX - radiusX >= clip.right || centreY + radiusY < clip.top || centreY - radiusY >= clip.bottom)
+			return;
+
+		// A pixel is inside when its centre is inside an ellipse half a pixel bigger, so a radius of 0 is a single pixel
+		thread_local std::vector< int > halfWidths;
+		halfWidths.resize((radiusY * 2) + 1);
+		for (int dy = -radiusY; dy <= radiusY; dy++)
+		{
+			float ey = dy / (radiusY + 0.5f);
+			halfWidths[dy + radiusY] = static_cast<int>((radiusX + 0.5f) * sqrtf(1.0f - (ey * ey)));
+		}
+
+		uint32_t colour = GetFillColour(pix, preMultiply);
+		auto span = [&](int y, int startX, int endX)
+		{
+			startX = std::max(startX, clip.left);
+			endX = std::min(endX, clip.right);
+			if (startX < endX)
+				FillTargetSpan<TBlend>(startX, y, endX - startX, colour);
+		};
+
+		int rowBegin = std::max(0, clip.top - (centreY - radiusY));
+		int rowEnd = std::min(radiusY * 2 + 1, clip.bottom - (centreY - radiusY));
+		for (int row = rowBegin; row < rowEnd; row++)
+		{
+			int y = centreY - radiusY + row;
+			int halfWidth = halfWidths[row];
+			int inner = 0;
+			if (!fill && row > 0 && row < radiusY * 2)
+				inner = std::min(std::min(halfWidths[row - 1], halfWidths[row + 1]) + 1, halfWidth);
+
+			if (inner <= 0)
+			{
+				span(y, centreX - halfWidth, centreX + halfWidth + 1);
+			}
+			else
+			{
+				span(y, centreX - halfWidth, centreX - inner + 1);
+				span(y, centreX + inner, centreX + halfWidth + 1);
+			}
+		}
+	}
+
+	//********************************************************************************************************************************
+	// Function:	FillPolygon - fills a polygon as horizontal runs of pixels
+	// Parameters:	pPoints, numPoints = the corners of the polygon in render target pixels from the top left (the last joins the first)
+	// Notes:		Each row finds where the edges cross the centre line of its pixels, and fills between alternate crossings
+	//********************************************************************************************************************************
+	template< typename TBlend > void FillPolygon(const Point2f* pPoints, int numPoints, Pixel pix, bool preMultiply)
+	{
+		if (pix.a == 0x00 || numPoints < 3)
+			return;
+
+		float minY = pPoints[0].y;
+		float maxY = pPoints[0].y;
+		for (int i = 1; i < numPoints; i++)
+		{
+			minY = std::min(minY, pPoints[i].y);
+			maxY = std::max(maxY, pPoints[i].y);
+		}
+
+		ClipRect clip = GetDrawableRect();
+		// Clamped before converting to integers, as the points can be a long way outside the render target
+		int rowBegin = static_cast<int>(std::max(static_cast<float>(clip.top), std::ceil(minY - 0.5f)));
+		int rowEnd = static_cast<int>(std::min(static_cast<float>(clip.bottom), std::ceil(maxY - 0.5f)));
+
+		uint32_t colour = GetFillColour(pix, preMultiply);
+		thread_local std::vector< float > crossings;
+		for (int y = rowBegin; y < rowEnd; y++)
+		{
+			float centreY = y + 0.5f;
+			crossings.clear();
+			for (int i = 0, j = numPoints - 1; i < numPoints; j = i++)
+			{
+				const Point2f& a = pPoints[j];
+				const Point2f& b = pPoints[i];
+				// Each edge includes its top end but not its bottom end, so a corner on the centre line is only crossed once
+				if ((a.y <= centreY) != (b.y <= centreY))
+					crossings.push_back(a.x + ((centreY - a.y) * (b.x - a.x) / (b.y - a.y)));
+			}
+			std::sort(crossings.begin(), crossings.end());
+
+			for (size_t i = 0; i + 1 < crossings.size(); i += 2)
+			{
+				int startX = static_cast<int>(std::max(static_cast<float>(clip.left), std::ceil(crossings[i] - 0.5f)));
+				int endX = static_cast<int>(std::min(static_cast<float>(clip.right), std::ceil(crossings[i + 1] - 0.5f)));
+				if (startX < endX)
+					FillTargetSpan<TBlend>(startX, y, endX - startX, colour);
+			}
+		}
+	}
+};
+#endif // PLAY_PLAYRENDER_H
+#ifndef PLAY_PLAYGRAPHICS_H
+#define PLAY_PLAYGRAPHICS_H
+//********************************************************************************************************************************
+// File:		PlayGraphics.h
+// Description:	Manages 2D graphics operations on a PixelData buffer 
+// Platform:	Independent
+// Notes:		Uses PNG format. The end of the filename indicates the number of frames e.g. "bat_4.png" or "tiles_10x10.png"
+//********************************************************************************************************************************
+namespace Play::Graphics
+{
+	enum BlendMode
+	{
+		BLEND_NORMAL = 0,
+		BLEND_ADD,
+		BLEND_MULTIPLY,
+		BLEND_SUBTRACT,
+		BLEND_PRECISE, // The same as BLEND_NORMAL but without any loss of accuracy in the colours underneath
+		BLEND_DARKEN,
+		BLEND_LIGHTEN
+	};
+
+	extern BlendMode blendMode;
+
+	// Create/Destroy manager functions
+	//********************************************************************************************************************************
+
+	// Creates the PlayGraphics manager and generates sprites from all the PNGs in the directory indicated
+	// > A PIXEL_RGB565 format makes a 16-bit drawing buffer (which needs an even width), halving the memory each draw reads and writes 
+	// > at the cost of colour precision. Everything is drawn the same way, with each row converted to 32 bits while it is blended
+	bool CreateManager( int bufferWidth, int bufferHeight, const char* path, PixelFormat format = PIXEL_ARGB8888 );
+	// Destroys the PlayGraphics manager
+	bool DestroyManager();
+
+	// Basic drawing functions
+	//********************************************************************************************************************************
+
+	// Sets the colour of an individual pixel in the display buffer
+	void DrawPixel( Point2f pos, Pixel pix );
+	// Draws a line of pixels into the display buffer
+	void DrawLine( Point2f startPos, Point2f endPos, Pixel pix );
+	// Draws an anti-aliased one pixel wide line into the display buffer
+	void DrawLineAA( Point2f startPos, Point2f endPos, Pixel pix );
+	// Draws a line of any thickness into the display buffer with anti-aliased edges
+	// > Much faster than stamping a sprite along the line, as the inside of the line is filled a row at a time
+	void DrawThickLine( Point2f startPos, Point2f endPos, float thickness, Pixel pix, Render::LineCap cap = Render::CAP_ROUND );
+	// Draws a rectangle into the display buffer
+	// > Filled shapes are drawn a row at a time, which is much faster than drawing their pixels individually
+	void DrawRect( Point2f bottomLeft, Point2f topRight, Pixel pix, bool fill = false );
+	// Draws a circle into the display buffer
+	void DrawCircle( Point2f centrePos, int radius, Pixel pix, bool fill = false );
+	// Draws an ellipse into the display buffer
+	void DrawEllipse( Point2f centrePos, int radiusX, int radiusY, Pixel pix, bool fill = false );
+	// Draws a polygon into the display buffer (the last point joins the first)
+	// > Filled polygons can be concave. Where the edges cross, the parts covered an odd number of times are filled
+	void DrawPolygon( const std::vector< Point2f >& points, Pixel pix, bool fill = false );
+	// Draws raw pixel data to the display buffer
+	// > Pre-multiplies the alpha on the image data if this hasn't been done before
+	void DrawPixelData( PixelData* pixelData, Point2f pos, float alpha = 1.0f );
+
+	// Debug font functions
+	//********************************************************************************************************************************
+
+	// Draws a single character using the in-built debug font
+	// > Returns the character width in pixels
+	int DrawDebugCharacter( Point2f pos, char c, Pixel pix );
+	// Draws text using the in-built debug font
+	// > Returns the x position at the end of the text
+	int DrawDebugString( Point2f pos, const std::string& s, Pixel pix, bool centred = true );
+	// Draws text using the in-built debug font with a one pixel outline on the diagonals of each character
+	// > The same as drawing the text in the outline colour at four diagonal offsets first, but only blits each character twice
+	int DrawDebugStringOutlined( Point2f pos, const std::string& s, Pixel pix, Pixel outlinePix, bool centred = true );
+
+	// Deferred drawing functions
+	//********************************************************************************************************************************
+
+	// Records all subsequent drawing into the display buffer instead of drawing it straight away
+	// > The recorded drawing is split into screen tiles which are shared between a pool of threads when it is flushed
+	// > The result is identical to immediate drawing. Setting numThreads = 0 uses one thread per hardware core
+	void SetDeferredDrawing( bool enable, int numThreads = 0 );
+	// Returns true if drawing into the display buffer is being deferred
+	bool IsDrawingDeferred();
+	// Draws everything which has been recorded or queued since the last flush
+	// > Happens automatically when the display buffer is needed (e.g. when it is presented)
+	void FlushDrawing();
+
+	// The order in which drawing into the display buffer is carried out
+	enum DrawOrder
+	{
+		ORDER_SUBMITTED = 0, // Everything is drawn in the order it is submitted (default)
+		ORDER_LAYER, // Drawing is queued and sorted by layer, keeping the submitted order within each layer
+		ORDER_LAYER_STATE, // Drawing is queued and sorted by layer, then by sprite and blend mode to make better use of the cache
+	};
+
+	// Sets the order of all subsequent drawing into the display buffer
+	// > Queued drawing is sorted when it is flushed. Sorting by state can change which overlapping draws in a layer end up on top
+	// > Clearing the display buffer or drawing a background isn't sorted: everything queued before it is drawn first, whatever the layers
+	void SetDrawOrder( DrawOrder order );
+	// Sets the layer for all subsequent drawing (lower layers are drawn first when drawing is sorted)
+	void SetDrawingLayer( int layer );
+	// Gets the current drawing layer
+	int GetDrawingLayer();
+	// Gets the number of drawing operations waiting in the queue
+	int GetQueuedDrawingCount();
+
+	// Dirty rectangle functions
+	//********************************************************************************************************************************
+
+	// Tracks which parts of the display buffer are drawn into, so that clearing and presenting can skip the parts which haven't changed
+	// > Clearing to the same colour (or background) as last time only restores the parts which have been drawn into since
+	// > Drawing with the Render functions directly isn't tracked, and GetDrawingBuffer marks the whole buffer as dirty
+	void SetDirtyTracking( bool enable );
+	// Returns true if dirty rectangles are being tracked
+	bool IsDirtyTracking();
+	// Gets the rectangles of the display buffer (in pixels from the top left) whose pixels have changed since the last call
+	// > Intended for presenting the display buffer, so it keeps its own copy of the pixels to compare against
+	void GetChangedRects( std::vector< Render::ClipRect >& rects );
+
+	// Rotation cache functions
+	//********************************************************************************************************************************
+
+	// How well the rotation cache is working (see SetRotationCache)
+	struct RotationCacheStats
+	{
+		uint64_t hits{ 0 }; // DrawRotated calls which just blitted a cached frame
+		uint64_t misses{ 0 }; // DrawRotated calls which had to render a frame
+		uint64_t evictions{ 0 }; // Frames thrown away to stay within the memory budget
+		size_t bytesUsed{ 0 };
+		size_t frames{ 0 };
+	};
+
+	// Caches the frames drawn by DrawRotated, so drawing the same frame at the same angle, scale and global multiply again is just a blit
+	// > Angles are rounded to one of angleSteps directions and scales to a multiple of scaleStep, which trades accuracy for more cache hits
+	// > The least recently used frames are thrown away to keep within memoryBudget bytes. A budget of 0 turns the cache off (the default)
+	// > BLEND_MULTIPLY drawing is never cached
+	void SetRotationCache( size_t memoryBudget, int angleSteps = 256, float scaleStep = 1.0f / 32.0f );
+	// Throws away every frame in the rotation cache (frames of a sprite are thrown away automatically when its pixels change)
+	void ClearRotationCache();
+	// Gets the rotation cache counters, which keep counting until the cache is cleared
+	RotationCacheStats GetRotationCacheStats();
+
+	// Render target functions
+	//********************************************************************************************************************************
+
+	// Gets an offscreen render target from the pool, cleared to be fully transparent (an alpha of 0)
+	// > Pixel buffers are kept in power of two size buckets and reused across frames, so acquiring a target every frame doesn't allocate
+	// > Draws anything which has been deferred first, as the pixels may have been used by a target which was released
+	PixelData* AcquireRenderTarget( int width, int height );
+	// Gives a render target back to the pool (the pixels are kept to be reused)
+	void ReleaseRenderTarget( PixelData* pRenderTarget );
+	// Frees the pixels of every render target in the pool which isn't being used
+	void TrimRenderTargetPool();
+	// Makes all subsequent drawing go into a render target, until PopRenderTarget is called
+	// > Any render target can be pushed, not just pooled ones. The clip rectangle is removed and put back when the target is popped
+	// > Drawing into an offscreen target is never deferred or queued, so it can be composited as soon as it is popped
+	void PushRenderTarget( PixelData* pRenderTarget );
+	// Goes back to the render target which was being drawn into before the last PushRenderTarget
+	void PopRenderTarget();
+	// Composites a render target into the current one using the current blend mode, with its bottom left corner at the given position
+	// > The pixels aren't changed (unlike DrawPixelData), so a target can be drawn once and composited every frame. Pixels with an alpha of 0 are 
+	// > left out, while anything drawn into the target is opaque
+	void DrawRenderTarget( const PixelData* pRenderTarget, Point2f pos, BlendColour globalMultiply = { 1.0f, 1.0f, 1.0f, 1.0f } );
+
+	// Sprite Loading functions
+	//********************************************************************************************************************************
+
+	// Loads a sprite sheet and creates a sprite from it (custom asset pipelines)
+	// > All sprites are normally automatically created by the PlayGraphics constructor
+	int LoadSpriteSheet( const std::string& path, const std::string& filename );
+	// Adds a sprite sheet dynamically from memory (custom asset pipelines)
+	// > All sprites are normally created by the PlayGraphics constructor
+	int AddSprite( const std::string& name, PixelData& pixelData, int hCount = 1, int vCount = 1 );
+	// Updates a sprite sheet dynamically from memory (custom asset pipelines)
+	// > Left to caller to release old PixelData
+	int UpdateSprite( const std::string& name, PixelData& pixelData, int hCount = 1, int vCount = 1 );
+	// Regenerates the premultiplied alpha data.
+	int UpdateSprite( const std::string& name );
+	// Packs the pre-multiplied pixels of every loaded sprite into a few large pages, each aligned to a cache line
+	// > The pixels of each sprite stay together (so none of the drawing changes), but hundreds of small sprites end up sharing a few pages
+	// > Sprites larger than a page get a page of their own. Can be called again after loading more sprites, which packs everything afresh
+	// > Returns the number of pages
+	int PackSpriteAtlas( size_t pageBytes = 4 * 1024 * 1024 );
+	// Stores a sprite as 8-bit indices into a palette of up to 256 colours, which takes about an eighth of the memory
+	// > Returns false (leaving the sprite as it was) if it has more colours. Blits look each pixel up in a pre-multiplied palette, and
+	// > ColourSprite just recolours the palette. Rotating, scaling, multiply blending and collisions look up a temporary 32-bit copy of
+	// > the frame each time, so they are slower than for other sprites. GetSpritePixelData makes (and keeps) a 32-bit copy of the whole sprite
+	// > The sprite's PixelData is freed, so don't index sprites you still have PixelData for
+	bool IndexSprite( int spriteId );
+	// Indexes every loaded sprite which has 256 colours or fewer (see IndexSprite)
+	// > Returns the number of sprites which were indexed
+	int IndexSprites();
+	
+	// Loads a background image which is assumed to be the same size as the display buffer
+	// > Returns the index of the loaded background
+	int LoadBackground( const char* fileAndPath );
+
+	// Sprite Getters and Setters
+	//********************************************************************************************************************************
+
+	// Gets the sprite id of the first matching sprite whose filename contains the given text
+	// > Returns -1 if not found
+	int GetSpriteId( const char* spriteName );
+	// Gets the root filename of a specific sprite
+	const std::string& GetSpriteName( int spriteId );
+	// Gets the size of the sprite with the given id
+	Vector2f GetSpriteSize(int spriteId);
+	// Gets the number of frames in the sprite with the given id
+	int GetSpriteFrames( int spriteId );
+	// Gets the origin of the sprite with the given id (offset from bottom left)
+	Vector2f GetSpriteOrigin( int spriteId );
+	// Sets the origin of the sprite with the given id (offset from bottom left)
+	void SetSpriteOrigin( int spriteId, Vector2f newOrigin, bool relative = false );
+	// Vertically flips the origin of the sprite with the given id (for legacy sprite origins)
+	void FlipSpriteOriginVertically( int spriteId );
+	// Vertically flips the origin of all sprites (for legacy sprite origins)
+	void FlipAllSpriteOriginsVertically( void );
+	// Centres the origin of the sprite with the given id
+	void CentreSpriteOrigin( int spriteId );
+	// Centres the origins of all the sprites
+	void CentreAllSpriteOrigins();
+	// Sets the origin of all sprites found matching the given name (offset from bottom left)
+	void SetSpriteOrigins( const char* rootName, Vector2f newOrigin, bool relative = false );
+	// Gets the number of sprites which have been loaded and created by PlayGraphics
+	int GetTotalLoadedSprites();
+	// Gets a (read only) pointer to a sprite's canvas buffer data
+	const PixelData* GetSpritePixelData( int spriteId ); 
+
+	// Sprite Drawing functions
+	//********************************************************************************************************************************
+
+	// Draw the sprite with transparency (slower than without transparency)
+	// > Flipped sprites (any combination of Render::FlipFlags) are mirrored around their origin, at the same speed as unflipped ones
+	void DrawTransparent(int spriteId, Point2f pos, int frameIndex, BlendColour globalMultiply = { 1.0f, 1.0f, 1.0f, 1.0f }, int flip = Render::FLIP_NONE ); 
+	// Draw the sprite without rotation or transparency (fastest draw)
+	inline void Draw( int spriteId, Point2f pos, int frameIndex, int flip = Render::FLIP_NONE ) { DrawTransparent( spriteId, pos, frameIndex, { 1.0f, 1.0f, 1.0f, 1.0f }, flip ); } // DrawTransparent only ends up performing a global multiply if any of its values are < 1.0f
+	// Draw the sprite rotated with transparency (slowest draw)
+	// > The sampling mode overrides the one set with SetSamplingMode for this draw only
+	// > Becomes a blit of a cached frame when the rotation cache is turned on (see SetRotationCache)
+	// > An angle of 0 uses a much faster scaling draw, unless the sampling mode is SAMPLE_BILINEAR
+	void DrawRotated( int spriteId, Point2f pos, int frameIndex, float angle, float scale = 1.0f, BlendColour globalMultiply = { 1.0f, 1.0f, 1.0f, 1.0f }, Render::SamplingMode samplingMode = Render::SAMPLE_DEFAULT );
+	// Draw the sprite using a matrix transformation and transparency (slowest draw)
+	// > A matrix which only scales, flips and translates uses the same faster draw as an unrotated DrawRotated
+	void DrawTransformed( int spriteId, const Matrix2D& transform, int frameIndex, BlendColour globalMultiply = { 1.0f, 1.0f, 1.0f, 1.0f }, Render::SamplingMode samplingMode = Render::SAMPLE_DEFAULT );
+	// Draws a previously loaded background image
+	void DrawBackground( int backgroundIndex = 0 );
+	// Multiplies the sprite image buffer by the colour values
+	// > Applies to all subseqent drawing calls for this sprite, but can be reset by calling agin with rgb set to white
+	void ColourSprite( int spriteId, int r, int g, int b );
+
+	// Draws a string using a sprite-based font exported from PlayFontTool
+	// > The whole string is drawn as one batch of glyph blits, laid out once and then reused from the text run cache (see SetTextRunCache)
+	int DrawString( int fontId, Point2f pos, std::string_view text );
+	// Draws a centred string using a sprite-based font exported from PlayFontTool
+	int DrawStringCentred( int fontId, Point2f pos, std::string_view text );
+	// Draws an individual text character using a sprite-based font 
+	int DrawChar( int fontId, Point2f pos, char c );
+	// Draws a rotated text character using a sprite-based font 
+	int DrawCharRotated( int fontId, Point2f pos, float angle, float scale, char c );
+	// Gets the width of an individual text character from a sprite-based font
+	int GetFontCharWidth( int fontId, char c );
+	// Gets the width of a string drawn with a sprite-based font (the same as DrawString returns)
+	int GetStringWidth( int fontId, std::string_view text );
+	// Sets how many laid out strings are kept, so drawing the same text with the same font again skips the layout (256 by default)
+	// > The least recently drawn strings are thrown away first. A size of 0 turns the cache off
+	void SetTextRunCache( int maxRuns );
+	// Throws away every laid out string (the strings of a font are thrown away automatically when its sprite is updated)
+	void ClearTextRunCache();
+
+	// A pixel-based sprite collision test (slooow!)
+	int SpriteCollide( int spriteIdA, int frameIndexA, Matrix2D& transA, int spriteIdB, int frameIndexB, Matrix2D& transB );
+
+	// Internal sprite structure for storing individual sprite data
+	struct Sprite
+	{
+		int id{ -1 }; // Fast way of finding the right sprite
+		std::string name; // Slow way of finding the right sprite
+		int width{ -1 }, height{ -1 }; // The width and height of a single image in the sprite
+		//int canvasWidth{ -1 }, canvasHeight{ -1 }; // The width and height of the entire sprite canvas
+		int hCount{ -1 }, vCount{ -1 }, totalCount{ -1 };  // The number of sprite images in the canvas horizontally and vertically
+		int originX{ 0 }, originY{ 0 }; // The origin and centre of rotation for the sprite (whole pixels only)
+		PixelData canvasBuffer; // The sprite image data
+		PixelData preMultAlpha; // The sprite data pre-multiplied with its own alpha
+		Render::SpanTable preMultSpans; // The transparent, opaque and translucent runs in each row of the pre-multiplied data
+		PixelData multiplyFactors; // The sprite data converted into factors for multiply blending (only created when it is first needed)
+		bool inAtlas{ false }; // The pre-multiplied data is in an atlas page rather than its own allocation (see PackSpriteAtlas)
+		std::vector< uint8_t > indices; // The pixels of an indexed sprite, laid out like the canvas buffer (see IndexSprite)
+		std::vector< Pixel > palette; // The colours of an indexed sprite
+		std::vector< Pixel > preMultPalette; // The palette pre-multiplied with its own alpha and the sprite colour, as the pre-multiplied data would be
+		Pixel colour{ 0x00FFFFFF }; // The colour set by ColourSprite
+		Sprite() = default;
+	};
+
+	// Miscellaneous functions
+	//********************************************************************************************************************************
+
+	// Gets a pointer to the drawing buffer's pixel data
+	// > Draws anything which has been deferred first. Check its format, as a 16-bit buffer holds two pixels in each Pixel
+	PixelData* GetDrawingBuffer(void);
+	// Resets the timing bar data and sets the current timing bar segment to a specific colour
+	void TimingBarBegin( Pixel pix );
+	// Sets the current timing bar segment to a specific colour
+	// > Returns the number of timing segments
+	int SetTimingBarColour( Pixel pix );
+	// Draws the timing bar for the previous frame at the given position and size
+	void DrawTimingBar( Point2f pos, Point2f size );
+	// Gets the duration (in milliseconds) of a specific timing segment
+	float GetTimingSegmentDuration( int id );
+	// Clears the display buffer using the given pixel colour
+	void ClearBuffer( Pixel colour );
+	// Sets the render target for drawing operations
+	// > Draws anything which has been deferred first
+	inline PixelData* SetRenderTarget(PixelData* renderTarget) { FlushDrawing(); return Render::SetRenderTarget(renderTarget); }
+	// Set the blend mode for all subsequent drawing operations that support different blend modes
+	inline void SetBlendMode(BlendMode bMode) { blendMode = bMode; }
+	// Sets how rotated and scaled sprites are sampled for all subsequent drawing operations
+	inline void SetSamplingMode(Render::SamplingMode mode) { Render::SetSamplingMode(mode); }
+};
+#endif // PLAY_PLAYGRAPHICS_H
+#ifndef PLAY_PLAYAUDIO_H
+#define PLAY_PLAYAUDIO_H
+//********************************************************************************************************************************
+// File:		PlayAudio.h
+// Description:	Declarations for a simple audio manager 
+// Platform:	Independant
+//********************************************************************************************************************************
+namespace Play::Audio
+{
+	// Initialises the audio manager, using the directory provided as its root for finding .WAV files
+	bool CreateManager( const char* path );
+	// Destroys any memory associated with the audio manager
+	bool DestroyManager();
+	// Play a sound using part of all of its filename, returns the voice id
+	int StartSound( const char* name, bool bLoop = false, float volume = 1.0f, float freqMod = 1.0f);
+	//  Stop a currently playing sound using its voice id
+	bool StopSound( int voiceId ); 
+	//  Stop all currently playing sounds with the same filename 
+	bool StopSound( const char* name );
+	// Set the volume of a looping sound that's playing using name
+	void SetLoopingSoundVolume( const char* name, float volume = 1.0f);
+	// Set the volume of a looping sound that's playing using id
+	void SetLoopingSoundVolume( int voiceId, float volume = 1.0f);
+	// Set the pitch of a looping sound that's playing using name
+	void SetLoopingSoundPitch(const char* name, float freqMod = 1.0f);
+	// Set the pitch of a looping sound that's playing using id
+	void SetLoopingSoundPitch(int voiceId, float freqMod = 1.0f);
+};
+#endif // PLAY_PLAYAUDIO_H
+
+#ifndef PLAY_PLAYINPUT_H
+#define PLAY_PLAYINPUT_H
+//********************************************************************************************************************************
+// File:		PlayInput.h
+// Description:	Manages keyboard and mouse input 
+// Platform:	Windows
+// Notes:		Obtains mouse data from PlayWindow via MouseData structure
+//********************************************************************************************************************************
+
+namespace Play
+{
+	// values equivalent to Windows VK codes or ASCII alphanumeric
+	enum KeyboardButton
+	{
+		KEY_BACKSPACE = 8, KEY_TAB,
+		KEY_ENTER = 13,
+		KEY_SHIFT = 16, KEY_CTRL, KEY_ALT,
+		KEY_ESCAPE = 27,
+		KEY_SPACE = 32, KEY_PAGE_UP, KEY_PAGE_DOWN, KEY_END, KEY_HOME,
+		KEY_LEFT = 37, KEY_UP, KEY_RIGHT, KEY_DOWN,
+		KEY_INSERT = 45, KEY_DELETE,
+		KEY_0 = 48, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7, KEY_8, KEY_9,
+		KEY_A = 65, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I, KEY_J, KEY_K, KEY_L, KEY_M, KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R, KEY_S, KEY_T, KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z,
+		KEY_NUMPAD_0 = 96, KEY_NUMPAD_1, KEY_NUMPAD_2, KEY_NUMPAD_3, KEY_NUMPAD_4, KEY_NUMPAD_5, KEY_NUMPAD_6, KEY_NUMPAD_7, KEY_NUMPAD_8, KEY_NUMPAD_9,
+		KEY_PLUS = 187, KEY_NUMPAD_PLUS = 107,
+		KEY_MINUS = 189, KEY_NUMPAD_MINUS = 109,
+		KEY_GREATER_THAN = 190, KEY_LESS_THAN = 188,
+		KEY_F1 = 112, KEY_F2, KEY_F3, KEY_F4, KEY_F5, KEY_F6, KEY_F7, KEY_F8, KEY_F9, KEY_F10, KEY_F11, KEY_F12,
+		KEY_OPEN_SQB = 219,
+		KEY_CLOSE_SQB = 221
+	};
+
+	namespace Input
+	{
+
+		enum class MouseButton
+		{
+			BUTTON_LEFT = 0,
+			BUTTON_RIGHT
+		};
+
+		// Creates the Input Manager
+		MouseData* CreateManager();
+		// Destroys the Input Manager
+		bool DestroyManager();
+		// Returns the status of the supplied mouse button (0=left, 1=right)
+		bool GetMouseDown( MouseButton button );
+		// Get the screen position of the mouse cursor
+		Point2f GetMousePos();
+		// Returns true if the key has been pressed since it was last released
+		// If you omit the frame number then only the first call in the same frame will ever return true
+		bool KeyPress( Play::KeyboardButton key, int frame = -1 );
+		// Returns true if the key is currently being held down
+		bool KeyHeld( KeyboardButton key );
+	};
+}
+#endif // PLAY_PLAYINPUT_H
+
+
+#ifndef PLAY_PLAYMANAGER_H
+#define PLAY_PLAYMANAGER_H
+//********************************************************************************************************************************
+// File:		PlayManager.h
+// Description:	A manager for providing simplified access to the PlayBuffer framework with managed GameObjects
+// Platform:	Independent
+// Notes:		The GameObject management is "opt in" as many will want to create their own GameObject class
+//********************************************************************************************************************************
+
+#define TRANSFORM_SPACE( p )  (Play::drawSpace == Play::DrawingSpace::WORLD ? p - Play::cameraPos : p)
+#define TRANSFORM_MATRIX_SPACE( t ) (Play::drawSpace == Play::DrawingSpace::WORLD ? t * (MatrixTranslation( -Play::cameraPos.x, -Play::cameraPos.y )) : t)
+
+//! @brief Main Namespace for PlayBuffer
+namespace Play
+{
+	//! @brief Alignment for font drawing operations
+	enum Align
+	{
+		//! @brief Text is aligned to the left of the origin.
+		LEFT = 0, 
+		//! @brief Text is aligned to the right of the origin.
+		RIGHT, 
+		//! @brief Text is aligned to the middle of the origin.
+		CENTRE,
+	};
+
+	//! @brief Used to indicate which edge of the screen you want to check if a GameObject is moving off.
+	enum Direction
+	{
+		//! @brief Check if it's moving off the left or right sides of the screen.
+		HORIZONTAL = 0, 
+		//! @brief Check if it's moving off the top or bottom sides of the screen.
+		VERTICAL, 
+		//! @brief Check if it's moving off any side of the screen.
+		ALL,
+	};
+
+
+	//! @brief The drawing space values.
+	//! The drawing space determines where things are drawn on the screen. There are two values for this, WORLD and SCREEN.
+		enum DrawingSpace
+	{
+		//! @brief This takes the camera position into account when things are drawn. Essentially, the position that is used is DrawingPosition - CameraPosition.
+		WORLD = 0, 
+		//! @brief This ignores the camera position, and purely uses the position that gets passed through. This is most useful for user interface elements that should always be drawn in the same position on the screen.
+		SCREEN,
+	};
+
+	//! @brief The Blend modes for sprite drawing.
+	enum BlendMode
+	{
+		//! @brief This blends the sprite normally. If using a transparent sprite draw, this also uses the transparency of the sprite.
+		BLEND_NORMAL = 0, 
+		//! @brief This uses an additive blend, where the colour values of the sprite being drawn are added to the buffer underneath. This has the effect of brightening what is underneath the sprite.
+		BLEND_ADD, 
+		//! @brief This uses an multiplicative blend, where the colour values of the sprite being drawn are multiplied with what is in the buffer underneath. This will darken what is underneath the sprite.
+		BLEND_MULTIPLY,
+		//! @brief This uses a subtractive blend, where the colour values of the sprite being drawn are subtracted from the buffer underneath. This has the effect of darkening what is underneath the sprite towards black.
+		BLEND_SUBTRACT,
+		//! @brief This blends the sprite in the same way as BLEND_NORMAL, but without slightly reducing the accuracy of the colours underneath semi-transparent pixels.
+		//! This avoids visible banding when lots of semi-transparent sprites are drawn on top of each other (e.g. smoke or glass).
+		BLEND_PRECISE,
+		//! @brief This blends the sprite normally, but only where the result is darker than what is in the buffer underneath. Each colour channel is compared separately.
+		BLEND_DARKEN,
+		//! @brief This blends the sprite normally, but only where the result is lighter than what is in the buffer underneath. Each colour channel is compared separately.
+		BLEND_LIGHTEN
+	};
+
+	//! @brief A PlayBuffer colour value. Colours are defined in percentages of red, green and blue. All zero is black, All 100 is white.
+	struct Colour
+	{
+		//! Create a colour using float values.
+		//! @param r Amount of red.
+		//! @param g Amount of green.
+		//! @param b Amount of blue.
+		Colour( float r, float g, float b ) : red( r ), green( g ), blue( b ) {}
+		//! Create a colour using int values.
+		//! @param r Amount of red.
+		//! @param g Amount of green.
+		//! @param b Amount of blue.
+		Colour( int r, int g, int b ) : red( static_cast<float>( r ) ), green( static_cast<float>( g ) ), blue( static_cast<float>( b ) ) {}
+		//! @var red 
+		//! Red value, from 0 to 100.
+		//! @var green 
+		//! Green value, from 0 to 100.
+		//! @var blue
+		//! Blue value, from 0 to 100.
+		float red, green, blue;
+	};
+
+	extern Colour cBlack, cRed, cGreen, cBlue, cMagenta, cCyan, cYellow, cOrange, cWhite, cGrey;
+	extern int frameCount;
+	extern Point2f cameraPos;
+	extern DrawingSpace drawSpace;
+
+
+
+	// Manager creation and deletion
+	//**************************************************************************************************
+
+	//! @brief Initialises the manager and creates a window of the required dimensions.
+	//! @param width The width of the window in pixels.
+	//! @param height The height of the window in pixels.
+	//! @param scale Pixel scale. One-pixel equals (scale x scale) pixels in final window.
+	//! @param format The display buffer format. PIXEL_RGB565 halves the memory used for drawing, at the cost of colour precision.
+	void CreateManager( int width, int height, int scale, PixelFormat format = PIXEL_ARGB8888 );
+	//! @brief Shuts down the manager and closes the window.
+	void DestroyManager();
+	// Get the width of the play buffer
+	inline int GetBufferWidth() { return Play::Window::GetWidth(); }
+	// Get the height of the play buffer
+	inline int GetBufferHeight() { return Play::Window::GetHeight(); }
+
+	// PlayWindow functions
+	//**************************************************************************************************
+
+	//! @brief Copies the contents of the drawing buffer to the window
+	void PresentDrawingBuffer();
+	//! @brief Gets the co-ordinates of the mouse cursor within the display buffer
+	//! @return The x/y coordinates of the mouse cursor in pixels.
+	inline Point2D GetMousePos() { return Play::Input::GetMousePos(); }
+	//! @brief Gets the status of the mouse buttons
+	//! @param button Mouse button to check
+	//! @return The x/y coordinates of the mouse cursor in pixels.
+	inline bool GetMouseButton( Align button ) { return Play::Input::GetMouseDown( static_cast<Play::Input::MouseButton>(button) ); }
+	//! @brief Gets the width of the display buffer
+	//! @return Width of the display buffer in pixels.
+	int GetBufferWidth();
+	//! @brief Gets the height of the display buffer
+	//! @return Height of the display buffer in pixels.
+	int GetBufferHeight();
+
+	// PlayAudio functions
+	//**************************************************************************************************
+
+	//! @brief Plays an audio file from the "Data/Audio" directory, in WAV format.
+	//! @param wavFilename The filename of the audio file you want to play.
+	//! @return The id of the sound that is playing.
+	inline int PlayAudio( const char* wavFilename ) { return Play::Audio::StartSound( wavFilename, false, 1.0f, 1.0f ); }
+	//! @brief Plays an audio file from the "Data/Audio" directory, in WAV format, at a random pitch from min to max percent.
+	//! @param wavFilename The filename of the audio file you want to play.
+	//! @param minPercent Minimum random pitch, as a percentage.
+	//! @param maxPercent Maximum random pitch, as a percentage.
+	//! @return The id of the sound that is playing.
+	int PlayAudioPitch( const char* wavFilename, int minPercent, int maxPercent );
+	//! @brief Plays an audio file from the "Data/Audio" directory, in WAV format, and loops it repeatedly until you stop it
+	//! @param wavFilename The filename of the audio file you want to play.
+	//! @return The id of the sound that is playing.
+	inline int StartAudioLoop( const char* wavFilename ) { return Play::Audio::StartSound( wavFilename, true, 1.0f, 1.0f ); }
+	//! @brief Stops a looping audio file, using the sound ID that the StartAudioLoop function returned.
+	//! @param soundId The ID of the sound you want to stop.
+	//! @return Whether the sound stopped playing successfully.
+	inline bool StopAudioLoop( int soundId ) { return Play::Audio::StopSound( soundId ); }
+	//! @brief Stops a sound, based upon the filename
+	//! @param fileName The filename of the audio file you want to stop. This can be either a normal sound or a looping sound.
+	//! @return Whether the sound stopped playing successfully.
+	inline bool StopAudio( const char* fileName ) { return Play::Audio::StopSound( fileName ); }
+
+	// Camera functions
+	//**************************************************************************************************
+
+	//! @brief Move the camera to the position specified
+	//! @param pos The desired position of the camera
+	inline void SetCameraPosition( Point2f pos ) { cameraPos = pos; }
+	//! @brief Changes the drawing space for all drawing functions.
+	//! @param space What drawing space should the item be drawn in.
+	inline void SetDrawingSpace( DrawingSpace space ) { drawSpace = space; }
+	//! @brief Get the camera's current position
+	//! @return The position of the camera
+	inline Point2f GetCameraPosition( void ) { return cameraPos; }
+	//! @brief Gets the current drawing space.
+	//! @return What drawing space PlayBuffer is currently using
+	inline DrawingSpace GetDrawingSpace( void ) { return drawSpace; }
+
+	// PlayGraphics functions
+	//**************************************************************************************************
+
+	//! @brief Clears the display buffer using the colour provided
+	//! @param col The colour to clear the drawing buffer with.
+	void ClearDrawingBuffer( Colour col );
+	//! @brief Loads a PNG file as a background image for the window.
+	//! The image must be the same size as the drawing buffer. It cannot be smaller or larger. Multiple backgrounds can be loaded, and will have it's own index (from zero).
+	//! @param pngFilename The full path and filename of the background image in PNG format.
+	//! @return The index of the newly loaded background
+	inline int LoadBackground( const char* pngFilename ) { return Play::Graphics::LoadBackground( pngFilename ); }
+	//! @brief Draws the background image previously loaded with Play::LoadBackground() into the drawing buffer.
+	//! @param background Optional argument to specify the background index. Defaults to zero (the first loaded background).
+	inline void DrawBackground( int background = 0 ) { Play::Graphics::DrawBackground( background ); }
+	//! @brief Draws text to the screen, using the built in debug font.
+	//! @param pos Position of the text on screen. This position is affected by the Drawing Space.
+	//! @param text The text you want to draw, as a string literal.
+	//! @param col Optional argument to set the colour of the text (defaults to white).
+	//! @param centred Optional argument to centre the text (defaults to true).
+	void DrawDebugText( Point2D pos, const char* text, Colour col = cWhite, bool centred = true );
+
+	//! @brief Gets the sprite ID of the first matching sprite whose filename contains the given text.
+	//! @param spriteName The name of the sprite you want to find the ID for. 
+	//! @return The ID of the sprite, if PlayBuffer could find it. If PlayBuffer couldn't find the sprite, then it returns -1
+	inline int GetSpriteId( const char* spriteName ) { return Play::Graphics::GetSpriteId( spriteName ); }
+	//! @brief Gets the pixel height of a sprite
+	//! @param spriteName The name of the sprite you want to find the height of. 
+	//! @return The height of the sprite in pixels
+	inline int GetSpriteHeight( const char* spriteName ) { return static_cast<int>(Play::Graphics::GetSpriteSize( GetSpriteId( spriteName ) ).height); }
+	//! @brief Gets the pixel width of a sprite
+	//! @param spriteName The name of the sprite you want to find the width of. 
+	//! @return The width of the sprite in pixels
+	inline int GetSpriteWidth( const char* spriteName ) { return static_cast<int>(Play::Graphics::GetSpriteSize( GetSpriteId( spriteName ) ).width); }
+	//! @brief Gets the pixel height of a sprite
+	//! @param spriteId The Id number of the sprite you want to find the height of. 
+	//! @return The height of the sprite in pixels.
+	inline int GetSpriteHeight( int spriteId ) { return static_cast<int>(Play::Graphics::GetSpriteSize( spriteId ).height); }
+	//! @brief Gets the pixel width of a sprite
+	//! @param spriteId The Id number of the sprite you want to find the width of. 
+	//! @return The width of the sprite in pixels
+	inline int GetSpriteWidth( int spriteId ) { return static_cast<int>(Play::Graphics::GetSpriteSize( spriteId ).width); }
+	//! @brief Gets the stem filename for the sprite this does not include the path or the extension.
+	//! @param spriteId The Id number of the sprite you want to get the filename of.
+	//! @return The stem filename for the sprite
+	inline const char* GetSpriteName( int spriteId ) { return Play::Graphics::GetSpriteName( spriteId ).c_str(); }
+	//! @brief Gets the total number of frames in the sprite.
+	//! @param spriteId The Id number of the sprite you want to find the number of frames of. 
+	//! @return The number of frames that the sprite has
+	inline int GetSpriteFrames( int spriteId ) { return static_cast<int>(Play::Graphics::GetSpriteFrames( spriteId )); }
+	//! @brief Blends the sprite with the given colour.
+	//! This function works best with sprites that are coloured white, as it multiplies the colour of the sprite with the colour that you provide.
+	//! @note Sprite colouring changes the loaded in sprite. This will result in the sprite being permanently coloured for the remainder of the game. (This doesn't affect the sprite on disk!)<br>You can reset the colouring by calling this again, using a white colour.
+	//! @param spriteName The name of the sprite you want to colour.
+	//! @param col The colour you want to blend with the sprite.
+	void ColourSprite( const char* spriteName, Colour col );
+
+	//! @brief Centres the origin of the first sprite found matching the given name
+	//! @param spriteName The name of the sprite you want to centre the origin of.
+	void CentreSpriteOrigin( const char* spriteName );
+	//! @brief Centres the origins of all sprites found with matching parts of their name.
+	//! @param partName A common part of a sprite name to centre all the origins of.
+	void CentreMatchingSpriteOrigins( const char* partName );
+	//! @brief Centres the origins of all loaded sprites.
+	void CentreAllSpriteOrigins();
+	//! @brief Moves the origins of a sprite by a given number of pixels in x and y. A sprite's origin does not have to be inside the sprite itself and can be moved any distance.
+	//! @param spriteName The name of the sprite you want to centre the origin of.
+	//! @param xOffset The number of pixels you want to move the origin to the right (negative value moves left).
+	//! @param yOffset The number of pixels you want to move the origin up (negative value moves down).
+	void MoveSpriteOrigin( const char* spriteName, int xOffset, int yOffset );
+	//! @brief Moves the origins of all sprites found matching the given name by a given number of pixels. A sprite's origin does not have to be inside the sprite itself and can be moved any distance.
+	//! @param partName A common part of a sprite name to centre all the origins of.
+	//! @param xoffset The number of pixels you want to move the origin to the right (negative value moves left).
+	//! @param yoffset The number of pixels you want to move the origin up (negative value moves down).
+	inline void MoveMatchingSpriteOrigins( const char* partName, int xoffset, int yoffset ) { Play::Graphics::SetSpriteOrigins( partName, { xoffset, yoffset }, true ); }
+	//! @brief Moves the origins of all sprites by a given number of pixels in x and y. A sprite's origin does not have to be inside the sprite itself and can be moved any distance.
+	//! @param xoffset The number of pixels you want to move the origin to the right (negative value moves left).
+	//! @param yoffset The number of pixels you want to move the origin up (negative value moves down).
+	void MoveAllSpriteOrigins( int xoffset, int yoffset );
+	//! @brief Sets the origins of a sprite, to the x and y coordinates, relative to the bottom left corner of the sprite. A sprite's origin does not have to be inside the sprite itself and can be positioned anywhere.
+	//! @param spriteName The name of the sprite you want to set the origin of.
+	//! @param xOrigin Where you want to move the origin on the x axis, relative to the left of the sprite.
+	//! @param yOrigin Where you want to move the origin on the y axis, relative to the bottom of the sprite.
+	void SetSpriteOrigin( const char* spriteName, int xOrigin, int yOrigin );
+	//! @brief Sets the origins of a sprite, to the x and y coordinates, relative to the bottom left corner of the sprite. A sprite's origin does not have to be inside the sprite itself and can be positioned anywhere.
+	//! @param spriteId The id of the sprite you want to set the origin of. 
+	//! @param xOrigin Where you want to move the origin on the x axis, relative to the left of the sprite.
+	//! @param yOrigin Where you want to move the origin on the y axis, relative to the bottom of the sprite.
+	inline void SetSpriteOrigin( int spriteId, int xOrigin, int yOrigin ) { Play::Graphics::SetSpriteOrigin( spriteId, { xOrigin, yOrigin } ); }
+	//! @brief Gets the origin of the first sprite found matching the given name. This value is relative to the bottom left corner of the sprite.
+	//! @param spriteName The name of the sprite you want to get the origin of.
+	inline Point2D GetSpriteOrigin( const char* spriteName ) { return Play::Graphics::GetSpriteOrigin( GetSpriteId( spriteName ) ); }
+	//! @brief Gets the origin of the sprite with the given ID. This value is relative to the bottom left corner of the sprite.
+	//! @param spriteId The ID of the sprite you want to get the origin of.
+	//! @return The origin of the sprite, relative to it's bottom left corner.
+	inline Point2D GetSpriteOrigin( int spriteId ) { return Play::Graphics::GetSpriteOrigin( spriteId ); }
+	//! @brief Gets a pointer to the raw pixel data of the sprite. The pixel data is read-only, and cannot be edited.
+	//! @param spriteId The ID of the sprite you want to get the pixel data of.
+	//! @return A pointer to the raw pixel data. Read-only.
+	inline const PixelData* GetSpritePixelData( int spriteId ) { return Play::Graphics::GetSpritePixelData( spriteId ); }
+
+	//! @brief Set the blend mode for all subsequent drawing operations that support different blend modes.
+	//! @param blendMode The blend mode that you want to draw things with.
+	inline void SetDrawingBlendMode( BlendMode blendMode ) { Graphics::SetBlendMode( static_cast<Graphics::BlendMode>(blendMode) ); }
+	//! @brief Sets whether rotated and scaled sprites are smoothed (filtered) for all subsequent drawing operations. Smoothing is slower, but stops sprites shimmering as they turn.
+	//! @param smooth True to filter sprites, false to draw the nearest pixel (the default).
+	inline void SetDrawingSmoothing( bool smooth ) { Graphics::SetSamplingMode( smooth ? Render::SAMPLE_BILINEAR : Render::SAMPLE_NEAREST ); }
+	//! @brief Sets whether drawing is deferred and shared between several threads. Deferred drawing is recorded and then drawn in parallel when the drawing buffer is presented, with exactly the same result.
+	//! @param deferred True to defer drawing, false to draw everything immediately (the default).
+	//! @param numThreads The number of threads to draw with, or 0 for one thread per hardware core.
+	inline void SetDrawingDeferred( bool deferred, int numThreads = 0 ) { Graphics::SetDeferredDrawing( deferred, numThreads ); }
+	//! @brief Sets whether drawing is queued and sorted by layer when the drawing buffer is presented, rather than drawn in the order it happens.
+	//! @param sorted True to sort drawing by layer, false to draw everything in order (the default).
+	//! @param bySprite True to also sort each layer by sprite and blend mode. This is faster, but can change which of two overlapping sprites on the same layer is on top.
+	inline void SetDrawingSorted( bool sorted, bool bySprite = false ) { Graphics::SetDrawOrder( !sorted ? Graphics::ORDER_SUBMITTED : bySprite ? Graphics::ORDER_LAYER_STATE : Graphics::ORDER_LAYER ); }
+	//! @brief Sets the layer for all subsequent drawing. When drawing is sorted, lower layers are drawn before higher ones.
+	//! @param layer The layer to draw on (0 by default).
+	inline void SetDrawingLayer( int layer ) { Graphics::SetDrawingLayer( layer ); }
+	//! @brief Sets whether the parts of the drawing buffer which are drawn into are tracked. This lets ClearDrawingBuffer and DrawBackground only restore what was drawn over,
+	//! and PresentDrawingBuffer only copy the parts which have changed to the window.
+	//! @param tracking True to track dirty rectangles, false to clear and present the whole drawing buffer every frame (the default).
+	inline void SetDrawingDirtyTracking( bool tracking ) { Graphics::SetDirtyTracking( tracking ); }
+	//! @brief Draws the first matching sprite whose filename contains the given text.
+	//! @param spriteName The name of the sprite you want to draw. 
+	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
+	//! @param frameIndex When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
+	//! @param flip Mirrors the sprite around its origin: Render::FLIP_HORIZONTAL, Render::FLIP_VERTICAL or both. This is just as fast as drawing it unflipped.
+	inline void DrawSprite( const char* spriteName, Point2D pos, int frameIndex, int flip = Render::FLIP_NONE ) { Play::Graphics::Draw( Play::Graphics::GetSpriteId( spriteName ), TRANSFORM_SPACE( pos ), frameIndex, flip ); }
+	//! @brief Draws the sprite with the matching sprite ID. Using this is more efficient than drawing it using the sprite name.
+	//! @param spriteID The ID of the sprite you want to draw. 
+	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
+	//! @param frameIndex When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
+	//! @param flip Mirrors the sprite around its origin: Render::FLIP_HORIZONTAL, Render::FLIP_VERTICAL or both. This is just as fast as drawing it unflipped.
+	inline void DrawSprite( int spriteID, Point2D pos, int frameIndex, int flip = Render::FLIP_NONE ) { Play::Graphics::Draw( spriteID, TRANSFORM_SPACE( pos ), frameIndex, flip ); }
+	//! @brief Draws the first matching sprite whose filename contains the given text, using transparency. This is slower than DrawSprite and should only be used if you need transparency.
+	//! @param spriteName The name of the sprite you want to draw. 
+	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
+	//! @param frame When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
+	//! @param opacity Controls how transparent the sprite should be. 0 is completely transparent and 1 is fully opaque (unable to see through it at all).
+	//! @param colour The colour tint of the sprite.
+	//! @param flip Mirrors the sprite around its origin: Render::FLIP_HORIZONTAL, Render::FLIP_VERTICAL or both. This is just as fast as drawing it unflipped.
+	void DrawSpriteTransparent( const char* spriteName, Point2D pos, int frame, float opacity, Colour colour = cWhite, int flip = Render::FLIP_NONE );
+	//! @brief Draws the sprite with the matching sprite ID, using transparency. This is slower than DrawSprite and should only be used if you need transparency.
+	//! @param spriteID The ID of the sprite you want to draw. 
+	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
+	//! @param frame When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
+	//! @param opacity Controls how transparent the sprite should be. 0 is completely transparent and 1 is fully opaque (unable to see through it at all).
+	//! @param colour The colour tint of the sprite. Defaults to white.
+	//! @param flip Mirrors the sprite around its origin: Render::FLIP_HORIZONTAL, Render::FLIP_VERTICAL or both. This is just as fast as drawing it unflipped.
+	void DrawSpriteTransparent( int spriteID, Point2D pos, int frame, float opacity, Colour colour = cWhite, int flip = Render::FLIP_NONE );
+	//! @brief Draws the first matching sprite whose filename contains the given text, using the specified angle, scale, and opacity. Note that this is the slowest sprite draw function and so should only be used when you need rotation or scale.
+	//! @param spriteName The name of the sprite you want to draw. 
+	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
+	//! @param frame When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
+	//! @param angle Angle in radians to rotate the sprite clockwise.
+	//! @param scale Amount to scale the sprite, with 1.0f being full size, 0.5f half size, 2.0f double sized and so on. Defaults to 1.0f (normal scale).
+	//! @param opacity Controls how transparent the sprite should be. 0 is completely transparent and 1 is fully opaque (unable to see through it at all). Defaults to 1.0f (completely opaque).
+	//! @param colour The colour tint of the sprite. Defaults to white.
+	void DrawSpriteRotated( const char* spriteName, Point2D pos, int frame, float angle, float scale = 1.0f, float opacity = 1.0f, Colour colour = cWhite );
+	//! @brief Draws the sprite with the matching sprite ID, using the specified angle, scale, and opacity. Note that this is the slowest sprite draw function and so should only be used when you need rotation or scale.
+	//! @param spriteID The ID of the sprite you want to draw. 
+	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
+	//! @param frame When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
+	//! @param angle Angle in radians to rotate the sprite clockwise.
+	//! @param scale Amount to scale the sprite, with 1.0f being full size, 0.5f half size, 2.0f double sized and so on. Defaults to 1.0f (normal scale).
+	//! @param opacity Controls how transparent the sprite should be. 0 is completely transparent and 1 is fully opaque (unable to see through it at all). Defaults to 1.0f (completely opaque).
+	//! @param colour The colour tint of the sprite. Defaults to white.
+	void DrawSpriteRotated( int spriteID, Point2D pos, int frame, float angle, float scale = 1.0f, float opacity = 1.0f, Colour colour = cWhite );
+	//! @brief Draws the sprite with the matching sprite ID, using a transformation matrix. This can be slower or faster depending on the contents of the matrix.
+	//! @param spriteID The ID of the sprite you want to draw.
+	//! @param transform The transformation matrix that you want to use to draw the sprite with.
+	//! @param frame When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
+	//! @param opacity Controls how transparent the sprite should be. 0 is completely transparent and 1 is fully opaque (unable to see through it at all). Defaults to 1.0f (completely opaque).
+	//! @param colour The colour tint of the sprite. Defaults to white.
+	void DrawSpriteTransformed( int spriteID, const Matrix2D& transform, int frame, float opacity = 1.0f, Colour colour = cWhite );
+	//! @brief Draws a single-pixel wide line between two points in the given colour.
+	//! @param start The x/y coordinate for the start point of the line.
+	//! @param end The x/y coordinate for the end point of the line.
+	//! @param col The colour of the line.
+	void DrawLine( Point2D start, Point2D end, Colour col );
+	//! @brief Draws an anti-aliased line with rounded ends between two points in the given colour. Much faster than DrawSpriteLine.
+	//! @param start The x/y coordinate for the start point of the line.
+	//! @param end The x/y coordinate for the end point of the line.
+	//! @param thickness The width of the line in pixels.
+	//! @param col The colour of the line.
+	void DrawThickLine( Point2D start, Point2D end, float thickness, Colour col );
+	//! @brief Draws a single-pixel wide circle at a given origin.
+	//! @param pos The x/y coordinate for the origin of the circle.
+	//! @param radius The length of the circle's radius in pixels.
+	//! @param col The colour of the circle.
+	//! @param fill Is the circle filled in? Defaults to not filled in.
+	void DrawCircle( Point2D pos, int radius, Colour col, bool fill = false );
+	//! @brief Draws a rectangle, defined by the bottom left and top right corners, in the given colour.
+	//! @param bottomLeft The x/y coordinate for the bottom left corner.
+	//! @param topRight The x/y coordinate for the top right corner.
+	//! @param col The colour of the rectangle.
+	//! @param fill Is the rectangle filled in? Defaults to not filled in.
+	void DrawRect( Point2D bottomLeft, Point2D topRight, Colour col, bool fill = false );
+	//! @brief Draws a line between two points using a sprite as a 'pen', blended with the given colour. Note that colouring affects subsequent DrawSprite calls using the same sprite!
+	//! @param startPos The x/y coordinate for the start point of the line.
+	//! @param endPos The x/y coordinate for the end point of the line.
+ 	//! @param penSprite The sprite to use as the 'pen'.
+	//! @param col The colour of the sprites drawing the line.
+	void DrawSpriteLine( Point2D startPos, Point2D endPos, const char* penSprite, Colour col = cWhite );
+	//! @brief Draws a circle using a sprite as a 'pen', blended with the given colour. Note that colouring affects subsequent DrawSprite calls using the same sprite!
+	//! @param pos The x/y coordinate for the origin of the circle.
+	//! @param radius The length of the circle's radius in pixels.
+	//! @param penSprite The sprite to use as the 'pen'.
+	//! @param col The colour of the sprites drawing the circle.
+	void DrawSpriteCircle( Point2D pos, int radius, const char* penSprite, Colour col = cWhite );
+	//! @brief Draws text using a sprite-based font exported from PlayFontTool.
+	//! @param fontId The unique sprite id of the font you want to use.
+	//! @param text The string containing the text you want to draw.
+	//! @param pos The x/y coordinate for the location for text to be drawn at.
+	//! @param justify Optional argument determining whether the text is left, right, or centre justified (defaults to left justified).
+	void DrawFontText( const char* fontId, std::string_view text, Point2D pos, Align justify = Align::LEFT );
+	//! @brief Draws a single pixel on screen.
+	//! @param pos The x/y coordinate of the pixel you wish to draw.
+	//! @param col The colour of the pixel.
+	void DrawPixel( Point2D pos, Colour col );
+
+	//! @brief Resets the timing bar data and sets the current timing bar segment to a specific colour
+	//! @param colour Colour of the timing bar segment.
+	void BeginTimingBar( Colour colour );
+	// Sets the current timing bar segment to a specific colour
+	//! @param colour Colour of the timing bar segment.
+	//! @return The number of timing segments
+	int ColourTimingBar( Colour colour );
+	//! @brief Draws the timing bar for the previous frame at the given position and size
+	//! @param pos The x/y coordinate you want to draw the timing bar at.
+	//! @param size The size of the timing bar in pixels.
+	inline void DrawTimingBar( Point2f pos, Point2f size ) { Play::Graphics::DrawTimingBar( pos, size ); }
+
+	// Miscellaneous functions
+	//**************************************************************************************************
+
+	//! @brief Returns true if the key has been pressed since it was last released.
+	//! @param key The key that you want to check for.
+	//! @return If the key has been pressed. This will return true on the frame the key is pushed down, but after that point will return false, even if held.
+	inline bool KeyPressed( KeyboardButton key ) { return Play::Input::KeyPress( key, frameCount ); }
+	//! @brief Returns true if the key is currently pressed down.
+	//! @param key The key that you want to check for.
+	//! @return If the key has been pressed. This will return true while it is down, and false if not pressed
+	inline bool KeyDown( KeyboardButton key ) { return Play::Input::KeyHeld( key ); }
+	//! @brief Returns a random number as if you rolled a die with this many sides.
+	//! @param sides How many sides the 'die' has.
+	//! @return The number that was rolled.
+	inline int RandomRoll( int sides ) { return (rand() % sides) + 1; }
+	//! @brief Returns a random number, between the min and max parameters.
+	//! @param min The smallest number that the roll can return.
+	//! @param max The largest number that the roll can return.
+	//! @return The number that was rolled.
+	int RandomRollRange( int min, int max );
+}
+#endif // PLAY_PLAYMANAGER_H
+#ifndef PLAY_PLAYOBJECT_H
+#define PLAY_PLAYOBJECT_H
+//********************************************************************************************************************************
+// PlayBuffer provides a managed Play::GameObject structure which can be extended below. Adding additional member variables to
+// the struct will cause them to be added to ALL GameObjects regardless of their type, so you may want to consider creating your 
+// own GameObject class heirarchy on the longer term.
+// Note: Play::GameObject and its associated functionality is only included if you #define PLAY_USING_GAMEOBJECT_MANAGER
+//********************************************************************************************************************************
+#ifdef PLAY_USING_GAMEOBJECT_MANAGER
+
+	
+//! \brief Main Namespace for PlayBuffer
+namespace Play
+{
+	//! @brief The Gameobject struct. Holds all the data that a GameObject requires, and can be extended by the user.
+	struct GameObject
+	{
+		//! @brief GameObject constructor.
+		//! @param type The type of the GameObject.
+		//! @param pos The initial x/y coordinates of the GameObject.
+		//! @param collisionRadius The radius of the collision circle of this GameObject.
+		//! @param spriteId The sprite ID of the GameObject.
+		GameObject(int type, Point2D pos, int collisionRadius, int spriteId); 
+
+		// Default member variables: don't change these!
+		//! A number representing the type of the GameObject as an int or enum. So a type of 1 might correspond to a health pickup and a type of 2 might correspond to a missile, for example. The only type value defined by PlayManager is -1, which corresponds to "no type". It is up to the user to decide how to assign other GameObject types. PlayManager will simply treat each unique value as a distinct type.
+		int type{ -1 };
+		//! If the object has changed type since it was created, then this holds the previous type of the object.
+		int oldType{ -1 };
+		//! The unique id of the sprite to be associated with the GameObject as used in certain DrawSprite commands.
+		int spriteId{ -1 }; 
+		//! The x/y position where the origin of the GameObject is placed. Used for calculating collisions as well as drawing the sprite.
+		Point2D pos{ 0.0f, 0.0f }; 
+		//! The x/y position of the GameObject from the previous frame.
+		Point2D oldPos{ 0.0f, 0.0f };
+		//! An x/y vector that determines how the position of the GameObject changes each time it is updated. The x-velocity will be added to the x position, and y-velocity to the y position.
+		Vector2D velocity{ 0.0f, 0.0f };
+		//! An x/y vector that determines how the velocity of the GameObject changes each time it is updated. The x-acceleration will be added to the x velocity, and y-acceleration to the y velocity.
+		Vector2D acceleration{ 0.0f, 0.0f };
+		//! The angle by which GameObject should be rotated when it is drawn. Measured in radians, clockwise from 12-o'clock.
+		float rotation{ 0.0f };
+		 //! A constant value which is added to the rotation of the GameObject each time it is updated.
+		float rotSpeed{ 0.0f };
+		//! The angle of rotation of the GameObject from the previous frame.
+		float oldRot{ 0.0f };
+		 //! The sprite frame to use when the GameObject is drawn.
+		int frame{ 0 };
+		//! The fraction of the sprite frame that the animation is currently on. animSpeed adds on to this value every frame, and when this rolls over 1, then it resets back down and increments frame.
+		float framePos{ 0.0f };
+		//! The amount the sprite frame is increased by each time the GameObject is updated. Numbers greater than 1 will result in frame-skipping. Numbers less than 1 will slow the animation down, but are best kept to fractions that divide equally into 1 (0.2, 0.5. 0.333, etc).
+		float animSpeed{ 0.0f };
+		//! The distance away from GameObject's origin to detect collisions. Measured in pixels.
+		int radius{ 0 };
+		//! The size to draw the sprite associated with the GameObject. 1.0f is full size, 0.5f half size, 2.0f double size, and so on.
+		float scale{ 1 };
+		int order{ 0 };
+		//! What frame did this GameObject last get updated on? This stops GameObjects being updated multiple times per frame.
+		int lastFrameUpdated{ -1 };
+
+		// Add your own member variables here and every GameObject will have them
+		// int something{ 0 };
+
+		//! @brief Allows you to get the unique ID of a GameObject if you only have a reference or a copy of it.
+		//! @return This GameObject's unique ID.
+		int GetId() { return m_id; }
+
+	private:
+		// The GameObject's id should never be changed manually so we make it private!
+		int m_id{ -1 };
+
+		// Preventing assignment and copying reduces the potential for bugs
+		GameObject& operator=(const GameObject&) = delete;
+		GameObject(const GameObject&) = delete;
+	};
+
+	// GameObject functions
+	//**************************************************************************************************
+
+	//! @brief Creates a new GameObject and adds it to the managed list.
+	//! @param type The type of the GameObject.
+	//! @param pos The initial x/y coordinates of the GameObject.
+	//! @param collisionRadius The radius of the collision circle of this GameObject.
+	//! @param spriteName The name of the sprite to use for the GameObject.
+	//! @return Returns the new object's unique id.
+	int CreateGameObject(int type, Point2D pos, int collisionRadius, const char* spriteName);
+	//! @brief Retrieves a GameObject from the ID passed to this function.
+	//! @param id The ID of the GameObject you wish to retrieve.
+	//! @return The game object associated with that ID. An object with a type of -1 is returned if no object can be found.
+	GameObject& GetGameObject(int id);
+	//! @brief Retrieves the first GameObject matching the type that you pass through as a parameter.
+	//! @param type The type of the GameObject you wish to retrieve.
+	//! @return The first GameObject that matches the given type. An object with a type of -1 is returned if no object can be found.
+	GameObject& GetGameObjectByType(int type);
+	//! @brief Collects the IDs of all of the GameObjects with the matching type
+	//! @param type The type of the GameObjects you wish to retrieve.
+	//! @return A vector containing IDs of GameObjects of that type. The vector will be empty if no GameObjects match the type.
+	std::vector<int> CollectGameObjectIDsByType(int type);
+	//! @brief Collects the IDs of all of the GameObjects
+	//! @return A vector containing the IDs of all of the GameObjects that the manager contains. The vector will be empty if there are no GameObjects.
+	std::vector<int> CollectAllGameObjectIDs();
+	//! @brief Performs a typical update of the object's position and animation. Changes its velocity by its acceleration, its position by its velocity, its rotation by its rotation speed, and its animation frame by its animation speed.
+	//! @note Can only be called once per object per frame unless allowMultipleUpdatesPerFrame is set to true.
+	//! @param object The GameObject you wish to update.
+	//! @param bWrap Should the object wrap around the edge of the screen to the other side? Defaults to no.
+	//! @param wrapBorderSize If the object is wrapping, then how far off the edge of the screen should the object get before it wraps? Defaults to 0 pixels.
+	//! @param allowMultipleUpdatesPerFrame If set to true, then this allows for the object to be updated again if it already has this frame.
+	void UpdateGameObject(GameObject& object, bool bWrap = false, int wrapBorderSize = 0, bool allowMultipleUpdatesPerFrame = false);
+	//! @brief Deletes the GameObject with the corresponding Id.
+	//! @param id The unique id of the GameObject you wish to delete.
+	void DestroyGameObject(int id);
+	//! @brief Deletes all GameObjects with the corresponding type.
+	//! @param type The type of the GameObjects you wish to delete.
+	void DestroyGameObjectsByType(int type);
+	//! @brief Deletes all GameObjects.
+	void DestroyAllGameObjects();
+
+	//! @brief Checks whether the two GameObjects are within each other's collision radii.
+	//! @param obj1 The first GameObject we want to check has collided.
+	//! @param obj2 The second GameObject we want to check has collided.
+	//! @return Returns true if the GameObjects are overlapping, false otherwise.
+	bool IsColliding(GameObject& obj1, GameObject& obj2);
+	//! @brief Checks whether any part of the GameObject is visible within the DisplayBuffer
+	//! @param obj The GameObject that we want to check for visibility.
+	bool IsVisible(GameObject& obj);
+	//! @brief Checks whether the GameObject is overlapping the edge of the screen and moving outwards.
+	//! @param obj The GameObject that we want to check for overlapping.
+	//! @param dirn Which side of the screen are we checking? Defaults to all sides.
+	//! @return Returns true if the object is overlapping, false otherwise.
+	bool IsLeavingDisplayArea(GameObject& obj, Direction dirn = Direction::ALL);
+	//! @brief Checks whether the animation has completed playing.
+	//! @param obj The GameObject that we want to check.
+	//! @return Returns true if the animation has finished, false if it hasn't.
+	bool IsAnimationComplete(GameObject& obj);
+	//! @brief Sets the velocity and angle of the GameObject.
+	//! @param obj The GameObject you wish to change the velocity and direction of.
+	//! @param speed The number of pixels you want the GameObject to move in a straight line each time it is updated.
+	//! @param rotation The angle you want the GameObject to move in.
+	void SetGameObjectDirection(GameObject& obj, int speed, float rotation);
+	//! @brief Sets the rotation of the object to point towards the target coordinate.
+	//! @param obj The GameObject you wish to change the direction of.
+	//! @param targetX The x coordinate of the point you wish the object to point at.
+	//! @param targetY The y coordinate of the point you wish the object to point at.
+	void PointGameObject(GameObject& obj,int targetX, int targetY);
+	//! @brief Changes the GameObject's current spite and resets its animation frame to the start.
+	//! @param obj The GameObject you wish to set the sprite for.
+	//! @param spriteName The name of the sprite you wish to set for the GameObject.
+	//! @param animSpeed The number of frames to increase the animation by each time the GameObject is updated.
+	void SetSprite(GameObject& obj, const char* spriteName, float animSpeed );
+	//! @brief Changes the GameObject's current spite and resets its animation frame to the start.
+	//! @param obj The GameObject you wish to set the sprite for.
+	//! @param spriteIndex The index of the sprite you wish to set for the GameObject.
+	//! @param animSpeed The number of frames to increase the animation by each time the GameObject is updated.
+	void SetSprite( GameObject& obj, int spriteIndex, float animSpeed );
+	//! @brief Draws the GameObject's sprite without rotation or transparency. This is the fastest way to draw a GameObject, and so should be the preferred method when rotation and alpha are not required.
+	//! @param obj The GameObject you wish to draw.
+	void DrawObject(GameObject& obj);
+	//! @brief Draws the GameObject's sprite with transparency. This is slower than DrawObject and so should only be used if you require transparency.
+	//! @param obj The GameObject you wish to draw.
+	//! @param opacity How transparent the object should be. 0.0f is fully transparent and 1.0f is fully opaque.
+	void DrawObjectTransparent(GameObject& obj, float opacity);
+	//! @brief Draws the object's sprite with rotation, scale, and transparency. This is slower than DrawObject or DrawObjectTransparent and so should only be used if you require rotation or scale. Rotation and scale are taken from the properties of the GameObject.
+	//! @param obj The GameObject you wish to draw.
+	//! @param opacity How transparent the object should be. 0.0f is fully transparent and 1.0f is fully opaque.
+	void DrawObjectRotated(GameObject& obj, float opacity = 1.0f);
+	//! @brief Draws debug info for all of the GameObjects that exist.
+	//! @details This includes the object's ID, sprite name and current animation frame. It will also draw the sprite's boundaries and the collision radius of the object.
+	void DrawGameObjectsDebug();
+}
+#endif
+#endif // PLAY_PLAYOBJECT_H
+
+#endif // PLAYPCH_H
+//*******************************************************************
+//*******************************************************************
+#ifdef PLAY_IMPLEMENTATION
+//*******************************************************************
+//*******************************************************************
+//********************************************************************************************************************************
+//* File:			PlayMemory.cpp
+//* Platform:		Independent
+//* Description:	Implementation of a simple memory tracker to prevent leaks. 
+//*                 Avoids use of STL or anything else which allocates memory as this could create infinite loops!
+//* Notes:          This is a simple approach to support your understanding of overriding the new operator.
+//*                 See below for alternative approaches:
+//*                 1) The CRT Debug Heap Library 
+//*                 https://docs.microsoft.com/en-us/visualstudio/debugger/crt-debug-heap-details?view=vs-2019
+//*                 2) Heap Profiling in the debugger 
+//*                 https://docs.microsoft.com/en-us/visualstudio/profiling/memory-usage?view=vs-2019
+//********************************************************************************************************************************
+
+
+#pragma comment(lib, "DbgHelp.lib")
+
+#ifdef _DEBUG
+
+namespace Play
+{
+	constexpr int MAX_ALLOCATIONS = 8192 * 4;
+	constexpr int MAX_FILENAME = 1024;
+	constexpr int STACKTRACE_OFFSET = 2;
+	constexpr int STACKTRACE_DEPTH = 1;
+
+	static unsigned int g_allocId = 0;
+
+	// A structure to store data on each memory allocation
+	struct ALLOC
+	{
+		void* address = 0;
+		size_t sizeBytes = 0;
+		int id = 0;
+		void* stack[STACKTRACE_DEPTH];
+		int frames;
+	};
+
+	ALLOC g_allocations[MAX_ALLOCATIONS];
+	unsigned int g_allocCount = 0;
+	int g_id = -1;
+	void* g_allocDeleted = nullptr;
+
+	CRITICAL_SECTION g_allocCritSec;
+
+	// A method for printing out all the memory allocation immediately before program exit (or as close as you can get)
+	// This is achieved by creating a class as a static object before the first memory allocation, which stays in scope until
+	// after everything else is destroyed. When it is cleaned up its destructor prints the allocations to show us any leaks!
+	class DestroyedLast
+	{
+	public:
+		DestroyedLast()
+		{
+			InitializeCriticalSectionAndSpinCount(&g_allocCritSec, 64);
+
+#ifdef _DEBUG
+			HANDLE process = GetCurrentProcess();
+			SymInitialize(process, NULL, TRUE);
+			SymSetOptions(SYMOPT_LOAD_LINES);
+#endif
+
+			PrintAllocations("<STARTUP>");
+		}
+		~DestroyedLast()
+		{
+			if (g_allocCount > 0)
+			{
+				PrintAllocations("<MEMORY LEAK>");
+			}
+			else
+			{
+				DebugOutput("**************************************************\n");
+				DebugOutput("NO MEMORY LEAKS!\n");
+				DebugOutput("**************************************************\n");
+			}
+
+			DeleteCriticalSection(&g_allocCritSec);
+		}
+	};
+
+	void CreateStaticObject(void)
+	{
+		static DestroyedLast last;
+	}
+
+	void TrackAllocation(void* ptr, std::size_t sizeBytes)
+	{
+		CreateStaticObject();
+
+		EnterCriticalSection(&g_allocCritSec);
+
+		PLAY_ASSERT(g_allocCount < MAX_ALLOCATIONS);
+		ALLOC& rAlloc(g_allocations[g_allocCount++]);
+		rAlloc.address = ptr;
+		rAlloc.sizeBytes = sizeBytes;
+		rAlloc.frames = RtlCaptureStackBackTrace(STACKTRACE_OFFSET, STACKTRACE_DEPTH, rAlloc.stack, NULL);
+
+		LeaveCriticalSection(&g_allocCritSec);
+	}
+
+	void UntrackAllocation(void* ptr)
+	{
+		EnterCriticalSection(&g_allocCritSec);
+		g_allocDeleted = ptr;
+
+		for (unsigned int i = 0; i < g_allocCount; i++)
+		{
+			if (g_allocations[i].address == ptr)
+			{
+				if (g_allocations[i].id == g_id)
+					g_allocations[i].id = g_id;
+
+				g_allocations[i] = g_allocations[g_allocCount - 1];
+				g_allocations[g_allocCount - 1].address = nullptr;
+				g_allocCount--;
+
+				// Early out
+				LeaveCriticalSection(&g_allocCritSec);
+				return;
+			}
+		}
+		LeaveCriticalSection(&g_allocCritSec);
+	}
+
+	//********************************************************************************************************************************
+	// Printing allocations
+	//********************************************************************************************************************************
+
+	void PrintAllocation(const char* tagText, const ALLOC& rAlloc)
+	{
+		char buffer[MAX_FILENAME * 2] = { 0 };
+
+		if (rAlloc.address != nullptr)
+		{
+			HANDLE process = GetCurrentProcess();
+
+			DWORD  dwDisplacement;
+
+			IMAGEHLP_LINE64 line;
+			constexpr size_t MAX_SYM_NAME_LENGTH = 255;
+			SYMBOL_INFO* symbol = (SYMBOL_INFO*)malloc(sizeof(SYMBOL_INFO) + MAX_SYM_NAME_LENGTH + 1);
+			symbol->MaxNameLen = MAX_SYM_NAME_LENGTH;
+			symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+
+			sprintf_s(buffer, "%s 0x%02p %d bytes [%d]: \n", tagText, rAlloc.address, static_cast<int>(rAlloc.sizeBytes), rAlloc.id);
+			DebugOutput(buffer);
+			for (int i = 0; i < rAlloc.frames; ++i)
+			{
+				SymFromAddr(process, (DWORD64)(rAlloc.stack[i]), 0, symbol);
+				SymGetLineFromAddr64(process, (DWORD64)rAlloc.stack[i], &dwDisplacement, &line);
+
+				// Format in such a way that VS can double click to jump to the allocation.
+				sprintf_s(buffer, "%s(%d): %s\n", line.FileName, line.LineNumber, symbol->Name);
+
+				DebugOutput(buffer);
+			}
+
+			free(symbol);
+		}
+	}
+
+	void PrintAllocations(const char* tagText)
+	{
+		EnterCriticalSection(&g_allocCritSec);
+
+		int bytes = 0;
+		char buffer[MAX_FILENAME * 2] = { 0 };
+		DebugOutput("****************************************************\n");
+		DebugOutput("MEMORY ALLOCATED\n");
+		DebugOutput("****************************************************\n");
+		for (unsigned int n = 0; n < g_allocCount; n++)
+		{
+			ALLOC& a = g_allocations[n];
+			PrintAllocation(tagText, a);
+			bytes += static_cast<int>(a.sizeBytes);
+		}
+		sprintf_s(buffer, "%s Total = %d bytes\n", tagText, bytes);
+		DebugOutput(buffer);
+		DebugOutput("**************************************************\n");
+
+		LeaveCriticalSection(&g_allocCritSec);
+	}
+
+} // namespace Play
+
+//********************************************************************************************************************************
+// Overrides for new operator (x2)
+//********************************************************************************************************************************
+void* operator new  (std::size_t sizeBytes)
+{
+	void* ptr = malloc(sizeBytes);
+	Play::TrackAllocation(ptr, sizeBytes);
+	return ptr;
+}
+
+void* operator new[](std::size_t sizeBytes)
+{
+	void* ptr = malloc(sizeBytes);
+	Play::TrackAllocation(ptr, sizeBytes);
+	return ptr;
+}
+
+//********************************************************************************************************************************
+// Overrides for delete operator (x2)
+//********************************************************************************************************************************
+void operator delete  (void* ptr) noexcept
+{
+	Play::UntrackAllocation(ptr);
+	free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	Play::UntrackAllocation(ptr);
+	free(ptr);
+}
+#endif
+
+//********************************************************************************************************************************
+// File:		PlayWindow.cpp
+// Description:	Platform specific code to provide a window to draw into
+// Platform:	Windows
+// Notes:		Uses a 32-bit ARGB or 16-bit RGB565 display buffer
+//********************************************************************************************************************************
+
+using namespace Play; 
+
+// Instruct Visual Studio to add these to the list of libraries to link
+#pragma comment(lib, "gdiplus.lib")
+#pragma comment(lib, "dwmapi.lib")
+
+// External functions which must be implemented by the user 
+extern void MainGameEntry( int argc, char* argv[] ); 
+extern bool MainGameUpdate( float ); // Called every frame
+extern int MainGameExit( void ); // Called on quit
+	
+ULONG_PTR g_pGDIToken = 0;
+
+#define ASSERT_WINDOW PLAY_ASSERT_MSG( Play::Window::m_bCreated, "Window Manager not initialised. Call Window::CreateManager() before using the Play::Window library functions.")
+
+int WINAPI WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nShowCmd )
+{
+	// Initialize GDI+
+	Gdiplus::GdiplusStartupInput startupInput;
+	ULONG_PTR token;
+	Gdiplus::Status gdiStatus = Gdiplus::GdiplusStartup(&token, &startupInput, NULL);
+	PLAY_ASSERT(Gdiplus::Ok == gdiStatus);
+	g_pGDIToken = token;
+
+	MainGameEntry(__argc, __argv);
+
+	return Play::Window::HandleWindows( hInstance, hPrevInstance, lpCmdLine, nShowCmd, L"PlayBuffer" );
+}
+
+namespace Play::Window
+{
+	// Private data
+	int m_scale{ 0 };
+	PixelData* m_pPlayBuffer{ nullptr };
+	MouseData* m_pMouseData{ nullptr };
+	HWND m_hWindow{ nullptr };
+	bool m_bCreated = false;
+	bool m_bRepaint = true; // Set when the window needs the whole display buffer to be copied to it
+
+	// A BITMAPINFO with room for the three colour masks a 16-bit BI_BITFIELDS bitmap needs
+	struct DisplayBitmapInfo
+	{
+		BITMAPINFOHEADER header;
+		DWORD colourMasks[3];
+	};
+
+	// Describes the pixel format of the display buffer to GDI
+	// > A 16-bit buffer is given as RGB565 bit fields, so GDI expands it as it copies it to the window without it being converted first
+	DisplayBitmapInfo GetDisplayBitmapInfo()
+	{
+		bool rgb565 = m_pPlayBuffer->format == PIXEL_RGB565;
+		BITMAPINFOHEADER bitmap_info_header
+		{
+				sizeof(BITMAPINFOHEADER),								// size of its own data,
+				m_pPlayBuffer->width, m_pPlayBuffer->height,		// width and height
+				1, static_cast<WORD>(rgb565 ? 16 : 32),				// planes must always be set to 1 (docs), 16 or 32-bit pixel data
+				static_cast<DWORD>(rgb565 ? BI_BITFIELDS : BI_RGB),	// 32-bit data is uncompressed, 16-bit data has its colour masks after the header
+				0, 0, 0, 0, 0				// rest can be set to 0 as this has no palette
+		};
+
+		return { bitmap_info_header, { 0xF800, 0x07E0, 0x001F } };
+	}
+
+	//********************************************************************************************************************************
+	// Create / Destroy functions for the Window Manager
+	//********************************************************************************************************************************
+
+	bool CreateManager( PixelData* pDisplayBuffer, int nScale )
+	{
+		PLAY_ASSERT(pDisplayBuffer);
+		PLAY_ASSERT(nScale > 0);
+		m_pPlayBuffer = pDisplayBuffer;
+		m_scale = nScale;
+		m_bCreated = true;
+		return true;
+	}
+
+	bool DestroyManager( void )
+	{
+		ASSERT_WINDOW;
+		m_bCreated = false;
+		return true;
+	}
+
+	//********************************************************************************************************************************
+	// Windows functions
+	//********************************************************************************************************************************
+
+	int HandleWindows( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow, LPCWSTR windowName )
+	{
+		ASSERT_WINDOW;
+
+		UNREFERENCED_PARAMETER(hPrevInstance);
+		UNREFERENCED_PARAMETER(lpCmdLine);
+
+		WNDCLASSEXW wcex;
+
+		wcex.cbSize = sizeof(WNDCLASSEX);
+
+		wcex.style = CS_HREDRAW | CS_VREDRAW;
+		wcex.lpfnWndProc = Play::Window::WndProc;
+		wcex.cbClsExtra = 0;
+		wcex.cbWndExtra = 0;
+		wcex.hInstance = hInstance;
+		wcex.hIcon = LoadIcon(hInstance, IDI_APPLICATION);
+		wcex.hCursor = LoadCursor(nullptr, IDC_ARROW);
+		wcex.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
+		wcex.lpszMenuName = nullptr;
+		wcex.lpszClassName = windowName;
+		wcex.hIconSm = LoadIcon(wcex.hInstance, IDI_APPLICATION);
+
+		RegisterClassExW(&wcex);
+
+		int	w = m_pPlayBuffer->width * m_scale;
+		int h = m_pPlayBuffer->height * m_scale;
+
+		UINT dwStyle = WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU;
+		RECT rect = { 0, 0, w, h };
+		AdjustWindowRect(&rect, dwStyle, FALSE);
+		HWND hWnd = CreateWindowW(windowName, windowName, dwStyle, CW_USEDEFAULT, CW_USEDEFAULT, rect.right - rect.left, rect.bottom - rect.top, nullptr, nullptr, hInstance, nullptr);
+
+		if (!hWnd)
+			return FALSE;
+
+		m_hWindow = hWnd;
+
+		ShowWindow(hWnd, nCmdShow);
+		UpdateWindow(hWnd);
+
+		HACCEL hAccelTable = LoadAccelerators(hInstance, windowName);
+
+		LARGE_INTEGER frequency;
+		double elapsedTime = 0.0;
+		static LARGE_INTEGER lastDrawTime;
+		LARGE_INTEGER now;
+
+		MSG msg{};
+		bool quit = false;
+
+		// Set up counters for timing the frame
+		QueryPerformanceCounter(&lastDrawTime);
+		QueryPerformanceFrequency(&frequency);
 
-	//! @brief Copies the contents of the drawing buffer to the window
-	void PresentDrawingBuffer();
-	//! @brief Gets the co-ordinates of the mouse cursor within the display buffer
-	//! @return The x/y coordinates of the mouse cursor in pixels.
-	inline Point2D GetMousePos() { return Play::Input::GetMousePos(); }
-	//! @brief Gets the status of the mouse buttons
-	//! @param button Mouse button to check
-	//! @return The x/y coordinates of the mouse cursor in pixels.
-	inline bool GetMouseButton( Align button ) { return Play::Input::GetMouseDown( static_cast<Play::Input::MouseButton>(button) ); }
-	//! @brief Gets the width of the display buffer
-	//! @return Width of the display buffer in pixels.
-	int GetBufferWidth();
-	//! @brief Gets the height of the display buffer
-	//! @return Height of the display buffer in pixels.
-	int GetBufferHeight();
+		// Standard windows message loop
+		while (!quit)
+		{
+			// Hangle windows messages
+			if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
+			{
+				if (msg.message == WM_QUIT)
+					break;
 
-	// PlayAudio functions
-	//**************************************************************************************************
+				if (!TranslateAccelerator(msg.hwnd, hAccelTable, &msg))
+				{
+					TranslateMessage(&msg);
+					DispatchMessage(&msg);
+				}
+			}
 
-	//! @brief Plays an audio file from the "Data/Audio" directory, in WAV format.
-	//! @param wavFilename The filename of the audio file you want to play.
-	//! @return The id of the sound that is playing.
-	inline int PlayAudio( const char* wavFilename ) { return Play::Audio::StartSound( wavFilename, false, 1.0f, 1.0f ); }
-	//! @brief Plays an audio file from the "Data/Audio" directory, in WAV format, at a random pitch from min to max percent.
-	//! @param wavFilename The filename of the audio file you want to play.
-	//! @param minPercent Minimum random pitch, as a percentage.
-	//! @param maxPercent Maximum random pitch, as a percentage.
-	//! @return The id of the sound that is playing.
-	int PlayAudioPitch( const char* wavFilename, int minPercent, int maxPercent );
-	//! @brief Plays an audio file from the "Data/Audio" directory, in WAV format, and loops it repeatedly until you stop it
-	//! @param wavFilename The filename of the audio file you want to play.
-	//! @return The id of the sound that is playing.
-	inline int StartAudioLoop( const char* wavFilename ) { return Play::Audio::StartSound( wavFilename, true, 1.0f, 1.0f ); }
-	//! @brief Stops a looping audio file, using the sound ID that the StartAudioLoop function returned.
-	//! @param soundId The ID of the sound you want to stop.
-	//! @return Whether the sound stopped playing successfully.
-	inline bool StopAudioLoop( int soundId ) { return Play::Audio::StopSound( soundId ); }
-	//! @brief Stops a sound, based upon the filename
-	//! @param fileName The filename of the audio file you want to stop. This can be either a normal sound or a looping sound.
-	//! @return Whether the sound stopped playing successfully.
-	inline bool StopAudio( const char* fileName ) { return Play::Audio::StopSound( fileName ); }
+			do
+			{
+				QueryPerformanceCounter(&now);
+				elapsedTime = (now.QuadPart - lastDrawTime.QuadPart) * 1000.0 / frequency.QuadPart;
+
+			} while (elapsedTime < 1000.0f / FRAMES_PER_SECOND);
+
+			// Call the main game update function (only while we have the input focus in release mode)
+#ifndef _DEBUG
+			if (GetFocus() == m_hWindow)
+#endif
+				quit = MainGameUpdate(static_cast<float>(elapsedTime) / 1000.0f);
+
+			lastDrawTime = now;
+
+			DwmFlush(); // Waits for DWM compositor to finish
+		}
+
+		// Call the main game cleanup function
+		MainGameExit();
+
+		PLAY_ASSERT(g_pGDIToken);
+		Gdiplus::GdiplusShutdown(g_pGDIToken);
+
+		return static_cast<int>(msg.wParam);
+	}
+
+	LRESULT CALLBACK WndProc( HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam )
+	{
+		ASSERT_WINDOW;
+
+		switch (message)
+		{
+		case WM_PAINT:
+			PAINTSTRUCT ps;
+			BeginPaint(hWnd, &ps);
+			EndPaint(hWnd, &ps);
+			m_bRepaint = true; // The next present can't just copy the parts which have changed
+			break;
+
+		case WM_DESTROY:
+			PostQuitMessage(0);
+			break;
+		case WM_LBUTTONDOWN:
+			if (m_pMouseData)
+				m_pMouseData->left = true;
+			break;
+		case WM_LBUTTONUP:
+			if (m_pMouseData)
+				m_pMouseData->left = false;
+			break;
+		case WM_RBUTTONDOWN:
+			if (m_pMouseData)
+				m_pMouseData->right = true;
+			break;
+		case WM_RBUTTONUP:
+			if (m_pMouseData)
+				m_pMouseData->right = false;
+			break;
+		case WM_MOUSEMOVE:
+			if (m_pMouseData)
+			{
+				m_pMouseData->pos.x = static_cast<float>(GET_X_LPARAM(lParam) / m_scale);
+				m_pMouseData->pos.y = m_pPlayBuffer->height - static_cast<float>(GET_Y_LPARAM(lParam) / m_scale);
+			}
+			break;
+		case WM_MOUSELEAVE:
+			m_pMouseData->pos.x = -1;
+			m_pMouseData->pos.y = -1;
+			break;
+		default:
+			return DefWindowProc(hWnd, message, wParam, lParam);
+		}
+		return 0;
+	}
+
+	double Present( void )
+	{
+		ASSERT_WINDOW;
+
+		LARGE_INTEGER frequency;
+		LARGE_INTEGER before;
+		LARGE_INTEGER after;
+		QueryPerformanceCounter(&before);
+		QueryPerformanceFrequency(&frequency);
+
+		// Set up a BitmapInfo structure to represent the pixel format of the display buffer
+		DisplayBitmapInfo bitmap_info = GetDisplayBitmapInfo();
+
+		HDC hDC = GetDC(m_hWindow);
+
+		// Copy the display buffer to the window: GDI only implements up scaling using simple pixel duplication, but that's what we want
+		// Note that GDI+ DrawImage would do the same thing, but it's much slower! 
+		StretchDIBits(hDC, 0, 0, m_pPlayBuffer->width * m_scale, m_pPlayBuffer->height * m_scale, 0, m_pPlayBuffer->height + 1, m_pPlayBuffer->width, -m_pPlayBuffer->height, m_pPlayBuffer->pPixels, reinterpret_cast<BITMAPINFO*>(&bitmap_info), DIB_RGB_COLORS, SRCCOPY); // We flip h because Bitmaps store pixel data upside down.
+
+		ReleaseDC(m_hWindow, hDC);
+		m_bRepaint = false;
+
+		QueryPerformanceCounter(&after);
+
+		double elapsedTime = (after.QuadPart - before.QuadPart) * 1000.0 / frequency.QuadPart;
+
+		return elapsedTime;
+	}
+
+	double PresentRects( const RECT* pRects, int numRects )
+	{
+		ASSERT_WINDOW;
+
+		if( m_bRepaint )
+			return Present();
+
+		LARGE_INTEGER frequency;
+		LARGE_INTEGER before;
+		LARGE_INTEGER after;
+		QueryPerformanceCounter(&before);
+		QueryPerformanceFrequency(&frequency);
+
+		if( numRects > 0 )
+		{
+			DisplayBitmapInfo bitmap_info = GetDisplayBitmapInfo();
+
+			HDC hDC = GetDC(m_hWindow);
+
+			// Each rectangle is mapped in exactly the same (flipped) way as the whole buffer is in Present
+			for( int i = 0; i < numRects; i++ )
+			{
+				const RECT& r = pRects[i];
+				int width = r.right - r.left;
+				int height = r.bottom - r.top;
+				StretchDIBits(hDC, r.left * m_scale, r.top * m_scale, width * m_scale, height * m_scale, r.left, m_pPlayBuffer->height + 1 - r.top, width, -height, m_pPlayBuffer->pPixels, reinterpret_cast<BITMAPINFO*>(&bitmap_info), DIB_RGB_COLORS, SRCCOPY);
+			}
+
+			ReleaseDC(m_hWindow, hDC);
+		}
+
+		QueryPerformanceCounter(&after);
+
+		double elapsedTime = (after.QuadPart - before.QuadPart) * 1000.0 / frequency.QuadPart;
+
+		return elapsedTime;
+	}
+
+	void RegisterMouse( MouseData* pMouseData ) 
+	{ 
+		ASSERT_WINDOW;
+		m_pMouseData = pMouseData; 
+	}
+
+	int GetWidth() 
+	{ 
+		ASSERT_WINDOW;
+		return m_pPlayBuffer->width; 
+	}
+
+	int GetHeight() 
+	{ 
+		ASSERT_WINDOW;
+		return m_pPlayBuffer->height;
+	}
+
+	int GetScale() 
+	{ 
+		ASSERT_WINDOW;
+		return m_scale; 
+	}
+
+}
+
+//********************************************************************************************************************************
+// Loading functions
+//********************************************************************************************************************************
+
+int ReadPNGImage(std::string& fileAndPath, int& width, int& height)
+{
+	// Convert filename from single to wide string for GDI+ compatibility
+	size_t newsize = strlen(fileAndPath.c_str()) + 1;
+	wchar_t* wcstring = new wchar_t[newsize];
+	size_t convertedChars = 0;
+	mbstowcs_s(&convertedChars, wcstring, newsize, fileAndPath.c_str(), _TRUNCATE);
+
+	HBITMAP hBitmap = NULL;
+
+	// Use GDI+ to load file into Bitmap structure
+	Gdiplus::Bitmap* bitmap = Gdiplus::Bitmap::FromFile(wcstring, false);
+	int status = bitmap->GetLastStatus();
+
+	if (status != Gdiplus::Ok)
+		return -status;
+
+	bitmap->GetHBITMAP(Gdiplus::Color(255, 255, 255), &hBitmap);
+
+	width = bitmap->GetWidth();
+	height = bitmap->GetHeight();
+
+	delete bitmap;
+	delete[] wcstring;
+
+	return 1;
+}
+
+int LoadPNGImage(std::string& fileAndPath, PixelData& destImage)
+{
+	// Convert filename from single to wide string for GDI+ compatibility
+	size_t newsize = strlen(fileAndPath.c_str()) + 1;
+	wchar_t* wcstring = new wchar_t[newsize];
+	size_t convertedChars = 0;
+	mbstowcs_s(&convertedChars, wcstring, newsize, fileAndPath.c_str(), _TRUNCATE);
+
+	HBITMAP hBitmap = NULL;
+
+	// Use GDI+ to load file into Bitmap structure
+	Gdiplus::Bitmap* bitmap = Gdiplus::Bitmap::FromFile(wcstring, false);
+	int status = bitmap->GetLastStatus();
+
+	if (status != Gdiplus::Ok)
+		return -status;
+
+	bitmap->GetHBITMAP(Gdiplus::Color(255, 255, 255), &hBitmap);
 
-	// Camera functions
-	//**************************************************************************************************
+	// Create BitmapData structure to pull the data into
+	Gdiplus::BitmapData* bitmapData = new Gdiplus::BitmapData;
 
-	//! @brief Move the camera to the position specified
-	//! @param pos The desired position of the camera
-	inline void SetCameraPosition( Point2f pos ) { cameraPos = pos; }
-	//! @brief Changes the drawing space for all drawing functions.
-	//! @param space What drawing space should the item be drawn in.
-	inline void SetDrawingSpace( DrawingSpace space ) { drawSpace = space; }
-	//! @brief Get the camera's current position
-	//! @return The position of the camera
-	inline Point2f GetCameraPosition( void ) { return cameraPos; }
-	//! @brief Gets the current drawing space.
-	//! @return What drawing space PlayBuffer is currently using
-	inline DrawingSpace GetDrawingSpace( void ) { return drawSpace; }
+	destImage.width = bitmap->GetWidth();
+	destImage.height = bitmap->GetHeight();
 
-	// PlayGraphics functions
-	//**************************************************************************************************
+	// Lock the bitmap in advance of reading its data
+	Gdiplus::Rect rect(0, 0, destImage.width, destImage.height);
+	bitmap->LockBits(&rect, Gdiplus::ImageLockModeRead, PixelFormat32bppARGB, bitmapData);
 
-	//! @brief Clears the display buffer using the colour provided
-	//! @param col The colour to clear the drawing buffer with.
-	void ClearDrawingBuffer( Colour col );
-	//! @brief Loads a PNG file as a background image for the window.
-	//! The image must be the same size as the drawing buffer. It cannot be smaller or larger. Multiple backgrounds can be loaded, and will have it's own index (from zero).
-	//! @param pngFilename The full path and filename of the background image in PNG format.
-	//! @return The index of the newly loaded background
-	inline int LoadBackground( const char* pngFilename ) { return Play::Graphics::LoadBackground( pngFilename ); }
-	//! @brief Draws the background image previously loaded with Play::LoadBackground() into the drawing buffer.
-	//! @param background Optional argument to specify the background index. Defaults to zero (the first loaded background).
-	inline void DrawBackground( int background = 0 ) { Play::Graphics::DrawBackground( background ); }
-	//! @brief Draws text to the screen, using the built in debug font.
-	//! @param pos Position of the text on screen. This position is affected by the Drawing Space.
-	//! @param text The text you want to draw, as a string literal.
-	//! @param col Optional argument to set the colour of the text (defaults to white).
-	//! @param centred Optional argument to centre the text (defaults to true).
-	void DrawDebugText( Point2D pos, const char* text, Colour col = cWhite, bool centred = true );
+	// Get a pointer to the actual bit data
+	Pixel* sourcePixels = static_cast<Pixel*>(bitmapData->Scan0);
 
-	//! @brief Gets the sprite ID of the first matching sprite whose filename contains the given text.
-	//! @param spriteName The name of the sprite you want to find the ID for. 
-	//! @return The ID of the sprite, if PlayBuffer could find it. If PlayBuffer couldn't find the sprite, then it returns -1
-	inline int GetSpriteId( const char* spriteName ) { return Play::Graphics::GetSpriteId( spriteName ); }
-	//! @brief Gets the pixel height of a sprite
-	//! @param spriteName The name of the sprite you want to find the height of. 
-	//! @return The height of the sprite in pixels
-	inline int GetSpriteHeight( const char* spriteName ) { return static_cast<int>(Play::Graphics::GetSpriteSize( GetSpriteId( spriteName ) ).height); }
-	//! @brief Gets the pixel width of a sprite
-	//! @param spriteName The name of the sprite you want to find the width of. 
-	//! @return The width of the sprite in pixels
-	inline int GetSpriteWidth( const char* spriteName ) { return static_cast<int>(Play::Graphics::GetSpriteSize( GetSpriteId( spriteName ) ).width); }
-	//! @brief Gets the pixel height of a sprite
-	//! @param spriteId The Id number of the sprite you want to find the height of. 
-	//! @return The height of the sprite in pixels.
-	inline int GetSpriteHeight( int spriteId ) { return static_cast<int>(Play::Graphics::GetSpriteSize( spriteId ).height); }
-	//! @brief Gets the pixel width of a sprite
-	//! @param spriteId The Id number of the sprite you want to find the width of. 
-	//! @return The width of the sprite in pixels
-	inline int GetSpriteWidth( int spriteId ) { return static_cast<int>(Play::Graphics::GetSpriteSize( spriteId ).width); }
-	//! @brief Gets the stem filename for the sprite this does not include the path or the extension.
-	//! @param spriteId The Id number of the sprite you want to get the filename of.
-	//! @return The stem filename for the sprite
-	inline const char* GetSpriteName( int spriteId ) { return Play::Graphics::GetSpriteName( spriteId ).c_str(); }
-	//! @brief Gets the total number of frames in the sprite.
-	//! @param spriteId The Id number of the sprite you want to find the number of frames of. 
-	//! @return The number of frames that the sprite has
-	inline int GetSpriteFrames( int spriteId ) { return static_cast<int>(Play::Graphics::GetSpriteFrames( spriteId )); }
-	//! @brief Blends the sprite with the given colour.
-	//! This function works best with sprites that are coloured white, as it multiplies the colour of the sprite with the colour that you provide.
-	//! @note Sprite colouring changes the loaded in sprite. This will result in the sprite being permanently coloured for the remainder of the game. (This doesn't affect the sprite on disk!)<br>You can reset the colouring by calling this again, using a white colour.
-	//! @param spriteName The name of the sprite you want to colour.
-	//! @param col The colour you want to blend with the sprite.
-	void ColourSprite( const char* spriteName, Colour col );
+	destImage.pPixels = new Pixel[destImage.width * destImage.height];
+	memset(destImage.pPixels, 0, sizeof(Pixel) * destImage.width * destImage.height);
 
-	//! @brief Centres the origin of the first sprite found matching the given name
-	//! @param spriteName The name of the sprite you want to centre the origin of.
-	void CentreSpriteOrigin( const char* spriteName );
-	//! @brief Centres the origins of all sprites found with matching parts of their name.
-	//! @param partName A common part of a sprite name to centre all the origins of.
-	void CentreMatchingSpriteOrigins( const char* partName );
-	//! @brief Centres the origins of all loaded sprites.
-	void CentreAllSpriteOrigins();
-	//! @brief Moves the origins of a sprite by a given number of pixels in x and y. A sprite's origin does not have to be inside the sprite itself and can be moved any distance.
-	//! @param spriteName The name of the sprite you want to centre the origin of.
-	//! @param xOffset The number of pixels you want to move the origin to the right (negative value moves left).
-	//! @param yOffset The number of pixels you want to move the origin up (negative value moves down).
-	void MoveSpriteOrigin( const char* spriteName, int xOffset, int yOffset );
-	//! @brief Moves the origins of all sprites found matching the given name by a given number of pixels. A sprite's origin does not have to be inside the sprite itself and can be moved any distance.
-	//! @param partName A common part of a sprite name to centre all the origins of.
-	//! @param xoffset The number of pixels you want to move the origin to the right (negative value moves left).
-	//! @param yoffset The number of pixels you want to move the origin up (negative value moves down).
-	inline void MoveMatchingSpriteOrigins( const char* partName, int xoffset, int yoffset ) { Play::Graphics::SetSpriteOrigins( partName, { xoffset, yoffset }, true ); }
-	//! @brief Moves the origins of all sprites by a given number of pixels in x and y. A sprite's origin does not have to be inside the sprite itself and can be moved any distance.
-	//! @param xoffset The number of pixels you want to move the origin to the right (negative value moves left).
-	//! @param yoffset The number of pixels you want to move the origin up (negative value moves down).
-	void MoveAllSpriteOrigins( int xoffset, int yoffset );
-	//! @brief Sets the origins of a sprite, to the x and y coordinates, relative to the bottom left corner of the sprite. A sprite's origin does not have to be inside the sprite itself and can be positioned anywhere.
-	//! @param spriteName The name of the sprite you want to set the origin of.
-	//! @param xOrigin Where you want to move the origin on the x axis, relative to the left of the sprite.
-	//! @param yOrigin Where you want to move the origin on the y axis, relative to the bottom of the sprite.
-	void SetSpriteOrigin( const char* spriteName, int xOrigin, int yOrigin );
-	//! @brief Sets the origins of a sprite, to the x and y coordinates, relative to the bottom left corner of the sprite. A sprite's origin does not have to be inside the sprite itself and can be positioned anywhere.
-	//! @param spriteId The id of the sprite you want to set the origin of. 
-	//! @param xOrigin Where you want to move the origin on the x axis, relative to the left of the sprite.
-	//! @param yOrigin Where you want to move the origin on the y axis, relative to the bottom of the sprite.
-	inline void SetSpriteOrigin( int spriteId, int xOrigin, int yOrigin ) { Play::Graphics::SetSpriteOrigin( spriteId, { xOrigin, yOrigin } ); }
-	//! @brief Gets the origin of the first sprite found matching the given name. This value is relative to the bottom left corner of the sprite.
-	//! @param spriteName The name of the sprite you want to get the origin of.
-	inline Point2D GetSpriteOrigin( const char* spriteName ) { return Play::Graphics::GetSpriteOrigin( GetSpriteId( spriteName ) ); }
-	//! @brief Gets the origin of the sprite with the given ID. This value is relative to the bottom left corner of the sprite.
-	//! @param spriteId The ID of the sprite you want to get the origin of.
-	//! @return The origin of the sprite, relative to it's bottom left corner.
-	inline Point2D GetSpriteOrigin( int spriteId ) { return Play::Graphics::GetSpriteOrigin( spriteId ); }
-	//! @brief Gets a pointer to the raw pixel data of the sprite. The pixel data is read-only, and cannot be edited.
-	//! @param spriteId The ID of the sprite you want to get the pixel data of.
-	//! @return A pointer to the raw pixel data. Read-only.
-	inline const PixelData* GetSpritePixelData( int spriteId ) { return Play::Graphics::GetSpritePixelData( spriteId ); }
+	Pixel* destPixels = destImage.pPixels;
 
-	//! @brief Set the blend mode for all subsequent drawing operations that support different blend modes.
-	//! @param blendMode The blend mode that you want to draw things with.
-	inline void SetDrawingBlendMode( BlendMode blendMode ) { Graphics::SetBlendMode( static_cast<Graphics::BlendMode>(blendMode) ); }
-	//! @brief Draws the first matching sprite whose filename contains the given text.
-	//! @param spriteName The name of the sprite you want to draw. 
-	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
-	//! @param frameIndex When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
-	inline void DrawSprite( const char* spriteName, Point2D pos, int frameIndex ) { Play::Graphics::Draw( Play::Graphics::GetSpriteId( spriteName ), TRANSFORM_SPACE( pos ), frameIndex ); }
-	//! @brief Draws the sprite with the matching sprite ID. Using this is more efficient than drawing it using the sprite name.
-	//! @param spriteID The ID of the sprite you want to draw. 
-	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
-	//! @param frameIndex When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
-	inline void DrawSprite( int spriteID, Point2D pos, int frameIndex ) { Play::Graphics::Draw( spriteID, TRANSFORM_SPACE( pos ), frameIndex ); }
-	//! @brief Draws the first matching sprite whose filename contains the given text, using transparency. This is slower than DrawSprite and should only be used if you need transparency.
-	//! @param spriteName The name of the sprite you want to draw. 
-	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
-	//! @param frame When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
-	//! @param opacity Controls how transparent the sprite should be. 0 is completely transparent and 1 is fully opaque (unable to see through it at all).
-	//! @param colour The colour tint of the sprite.
-	void DrawSpriteTransparent( const char* spriteName, Point2D pos, int frame, float opacity, Colour colour = cWhite );
-	//! @brief Draws the sprite with the matching sprite ID, using transparency. This is slower than DrawSprite and should only be used if you need transparency.
-	//! @param spriteID The ID of the sprite you want to draw. 
-	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
-	//! @param frame When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
-	//! @param opacity Controls how transparent the sprite should be. 0 is completely transparent and 1 is fully opaque (unable to see through it at all).
-	//! @param colour The colour tint of the sprite. Defaults to white.
-	void DrawSpriteTransparent( int spriteID, Point2D pos, int frame, float opacity, Colour colour = cWhite );
-	//! @brief Draws the first matching sprite whose filename contains the given text, using the specified angle, scale, and opacity. Note that this is the slowest sprite draw function and so should only be used when you need rotation or scale.
-	//! @param spriteName The name of the sprite you want to draw. 
-	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
-	//! @param frame When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
-	//! @param angle Angle in radians to rotate the sprite clockwise.
-	//! @param scale Amount to scale the sprite, with 1.0f being full size, 0.5f half size, 2.0f double sized and so on. Defaults to 1.0f (normal scale).
-	//! @param opacity Controls how transparent the sprite should be. 0 is completely transparent and 1 is fully opaque (unable to see through it at all). Defaults to 1.0f (completely opaque).
-	//! @param colour The colour tint of the sprite. Defaults to white.
-	void DrawSpriteRotated( const char* spriteName, Point2D pos, int frame, float angle, float scale = 1.0f, float opacity = 1.0f, Colour colour = cWhite );
-	//! @brief Draws the sprite with the matching sprite ID, using the specified angle, scale, and opacity. Note that this is the slowest sprite draw function and so should only be used when you need rotation or scale.
-	//! @param spriteID The ID of the sprite you want to draw. 
-	//! @param pos The x/y position on the display you want to draw the sprite. Specifically, the point where the origin of the sprite will be drawn.
-	//! @param frame When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
-	//! @param angle Angle in radians to rotate the sprite clockwise.
-	//! @param scale Amount to scale the sprite, with 1.0f being full size, 0.5f half size, 2.0f double sized and so on. Defaults to 1.0f (normal scale).
-	//! @param opacity Controls how transparent the sprite should be. 0 is completely transparent and 1 is fully opaque (unable to see through it at all). Defaults to 1.0f (completely opaque).
-	//! @param colour The colour tint of the sprite. Defaults to white.
-	void DrawSpriteRotated( int spriteID, Point2D pos, int frame, float angle, float scale = 1.0f, float opacity = 1.0f, Colour colour = cWhite );
-	//! @brief Draws the sprite with the matching sprite ID, using a transformation matrix. This can be slower or faster depending on the contents of the matrix.
-	//! @param spriteID The ID of the sprite you want to draw.
-	//! @param transform The transformation matrix that you want to use to draw the sprite with.
-	//! @param frame When sprites consist of multiple frames the frame index determines which frame is drawn, starting at frame 0. Where a sprite has only one frame, this argument has no effect.
-	//! @param opacity Controls how transparent the sprite should be. 0 is completely transparent and 1 is fully opaque (unable to see through it at all). Defaults to 1.0f (completely opaque).
-	//! @param colour The colour tint of the sprite. Defaults to white.
-	void DrawSpriteTransformed( int spriteID, const Matrix2D& transform, int frame, float opacity = 1.0f, Colour colour = cWhite );
-	//! @brief Draws a single-pixel wide line between two points in the given colour.
-	//! @param start The x/y coordinate for the start point of the line.
-	//! @param end The x/y coordinate for the end point of the line.
-	//! @param col The colour of the line.
-	void DrawLine( Point2D start, Point2D end, Colour col );
-	//! @brief Draws a single-pixel wide circle at a given origin.
-	//! @param pos The x/y coordinate for the origin of the circle.
-	//! @param radius The length of the circle's radius in pixels.
-	//! @param col The colour of the circle.
-	void DrawCircle( Point2D pos, int radius, Colour col );
-	//! @brief Draws a rectangle, defined by the bottom left and top right corners, in the given colour.
-	//! @param bottomLeft The x/y coordinate for the bottom left corner.
-	//! @param topRight The x/y coordinate for the top right corner.
-	//! @param col The colour of the rectangle.
-	//! @param fill Is the rectangle filled in? Defaults to not filled in.
-	void DrawRect( Point2D bottomLeft, Point2D topRight, Colour col, bool fill = false );
-	//! @brief Draws a line between two points using a sprite as a 'pen', blended with the given colour. Note that colouring affects subsequent DrawSprite calls using the same sprite!
-	//! @param startPos The x/y coordinate for the start point of the line.
-	//! @param endPos The x/y coordinate for the end point of the line.
- 	//! @param penSprite The sprite to use as the 'pen'.
-	//! @param col The colour of the sprites drawing the line.
-	void DrawSpriteLine( Point2D startPos, Point2D endPos, const char* penSprite, Colour col = cWhite );
-	//! @brief Draws a circle using a sprite as a 'pen', blended with the given colour. Note that colouring affects subsequent DrawSprite calls using the same sprite!
-	//! @param pos The x/y coordinate for the origin of the circle.
-	//! @param radius The length of the circle's radius in pixels.
-	//! @param penSprite The sprite to use as the 'pen'.
-	//! @param col The colour of the sprites drawing the circle.
-	void DrawSpriteCircle( Point2D pos, int radius, const char* penSprite, Colour col = cWhite );
-	//! @brief Draws text using a sprite-based font exported from PlayFontTool.
-	//! @param fontId The unique sprite id of the font you want to use.
-	//! @param text The string containing the text you want to draw.
-	//! @param pos The x/y coordinate for the location for text to be drawn at.
-	//! @param justify Optional argument determining whether the text is left, right, or centre justified (defaults to left justified).
-	void DrawFontText( const char* fontId, std::string text, Point2D pos, Align justify = Align::LEFT );
-	//! @brief Draws a single pixel on screen.
-	//! @param pos The x/y coordinate of the pixel you wish to draw.
-	//! @param col The colour of the pixel.
-	void DrawPixel( Point2D pos, Colour col );
+	// Copy the data across
+	for (int b = 0; b < destImage.width * destImage.height; b++)
+		*destPixels++ = *sourcePixels++;
 
-	//! @brief Resets the timing bar data and sets the current timing bar segment to a specific colour
-	//! @param colour Colour of the timing bar segment.
-	void BeginTimingBar( Colour colour );
-	// Sets the current timing bar segment to a specific colour
-	//! @param colour Colour of the timing bar segment.
-	//! @return The number of timing segments
-	int ColourTimingBar( Colour colour );
-	//! @brief Draws the timing bar for the previous frame at the given position and size
-	//! @param pos The x/y coordinate you want to draw the timing bar at.
-	//! @param size The size of the timing bar in pixels.
-	inline void DrawTimingBar( Point2f pos, Point2f size ) { Play::Graphics::DrawTimingBar( pos, size ); }
+	//Unlock the bitmap
+	bitmap->UnlockBits(bitmapData);
 
-	// Miscellaneous functions
-	//**************************************************************************************************
+	delete bitmap;
+	delete bitmapData;
+	delete[] wcstring;
 
-	//! @brief Returns true if the key has been pressed since it was last released.
-	//! @param key The key that you want to check for.
-	//! @return If the key has been pressed. This will return true on the frame the key is pushed down, but after that point will return false, even if held.
-	inline bool KeyPressed( KeyboardButton key ) { return Play::Input::KeyPress( key, frameCount ); }
-	//! @brief Returns true if the key is currently pressed down.
-	//! @param key The key that you want to check for.
-	//! @return If the key has been pressed. This will return true while it is down, and false if not pressed
-	inline bool KeyDown( KeyboardButton key ) { return Play::Input::KeyHeld( key ); }
-	//! @brief Returns a random number as if you rolled a die with this many sides.
-	//! @param sides How many sides the 'die' has.
-	//! @return The number that was rolled.
-	inline int RandomRoll( int sides ) { return (rand() % sides) + 1; }
-	//! @brief Returns a random number, between the min and max parameters.
-	//! @param min The smallest number that the roll can return.
-	//! @param max The largest number that the roll can return.
-	//! @return The number that was rolled.
-	int RandomRollRange( int min, int max );
+	return 1;
 }
-#endif // PLAY_PLAYMANAGER_H
-#ifndef PLAY_PLAYOBJECT_H
-#define PLAY_PLAYOBJECT_H
-//********************************************************************************************************************************
-// PlayBuffer provides a managed Play::GameObject structure which can be extended below. Adding additional member variables to
-// the struct will cause them to be added to ALL GameObjects regardless of their type, so you may want to consider creating your 
-// own GameObject class heirarchy on the longer term.
-// Note: Play::GameObject and its associated functionality is only included if you #define PLAY_USING_GAMEOBJECT_MANAGER
-//********************************************************************************************************************************
-#ifdef PLAY_USING_GAMEOBJECT_MANAGER
 
-	
-//! \brief Main Namespace for PlayBuffer
-namespace Play
+int GetEncoderClsid( const WCHAR* format, CLSID* pClsid )
 {
-	//! @brief The Gameobject struct. Holds all the data that a GameObject requires, and can be extended by the user.
-	struct GameObject
+	UINT num = 0;
+	UINT size = 0;
+
+	Gdiplus::GetImageEncodersSize( &num, &size );
+	if( size == 0 )
+		return -1;
+
+	Gdiplus::ImageCodecInfo* imageCodecInfo = (Gdiplus::ImageCodecInfo*)(malloc( size ));
+	if( imageCodecInfo == NULL )
+		return -1;
+
+	Gdiplus::GetImageEncoders( num, size, imageCodecInfo );
+
+	for( UINT j = 0; j < num; ++j )
 	{
-		//! @brief GameObject constructor.
-		//! @param type The type of the GameObject.
-		//! @param pos The initial x/y coordinates of the GameObject.
-		//! @param collisionRadius The radius of the collision circle of this GameObject.
-		//! @param spriteId The sprite ID of the GameObject.
-		GameObject(int type, Point2D pos, int collisionRadius, int spriteId); 
+		if( wcscmp( imageCodecInfo[ j ].MimeType, format ) == 0 )
+		{
+			*pClsid = imageCodecInfo[ j ].Clsid;
+			free( imageCodecInfo );
+			return j;
+		}
+	}
 
-		// Default member variables: don't change these!
-		//! A number representing the type of the GameObject as an int or enum. So a type of 1 might correspond to a health pickup and a type of 2 might correspond to a missile, for example. The only type value defined by PlayManager is -1, which corresponds to "no type". It is up to the user to decide how to assign other GameObject types. PlayManager will simply treat each unique value as a distinct type.
-		int type{ -1 };
-		//! If the object has changed type since it was created, then this holds the previous type of the object.
-		int oldType{ -1 };
-		//! The unique id of the sprite to be associated with the GameObject as used in certain DrawSprite commands.
-		int spriteId{ -1 }; 
-		//! The x/y position where the origin of the GameObject is placed. Used for calculating collisions as well as drawing the sprite.
-		Point2D pos{ 0.0f, 0.0f }; 
-		//! The x/y position of the GameObject from the previous frame.
-		Point2D oldPos{ 0.0f, 0.0f };
-		//! An x/y vector that determines how the position of the GameObject changes each time it is updated. The x-velocity will be added to the x position, and y-velocity to the y position.
-		Vector2D velocity{ 0.0f, 0.0f };
-		//! An x/y vector that determines how the velocity of the GameObject changes each time it is updated. The x-acceleration will be added to the x velocity, and y-acceleration to the y velocity.
-		Vector2D acceleration{ 0.0f, 0.0f };
-		//! The angle by which GameObject should be rotated when it is drawn. Measured in radians, clockwise from 12-o'clock.
-		float rotation{ 0.0f };
-		 //! A constant value which is added to the rotation of the GameObject each time it is updated.
-		float rotSpeed{ 0.0f };
-		//! The angle of rotation of the GameObject from the previous frame.
-		float oldRot{ 0.0f };
-		 //! The sprite frame to use when the GameObject is drawn.
-		int frame{ 0 };
-		//! The fraction of the sprite frame that the animation is currently on. animSpeed adds on to this value every frame, and when this rolls over 1, then it resets back down and increments frame.
-		float framePos{ 0.0f };
-		//! The amount the sprite frame is increased by each time the GameObject is updated. Numbers greater than 1 will result in frame-skipping. Numbers less than 1 will slow the animation down, but are best kept to fractions that divide equally into 1 (0.2, 0.5. 0.333, etc).
-		float animSpeed{ 0.0f };
-		//! The distance away from GameObject's origin to detect collisions. Measured in pixels.
-		int radius{ 0 };
-		//! The size to draw the sprite associated with the GameObject. 1.0f is full size, 0.5f half size, 2.0f double size, and so on.
-		float scale{ 1 };
-		int order{ 0 };
-		//! What frame did this GameObject last get updated on? This stops GameObjects being updated multiple times per frame.
-		int lastFrameUpdated{ -1 };
+	free( imageCodecInfo );
+	return -1;
+}
 
-		// Add your own member variables here and every GameObject will have them
-		// int something{ 0 };
+int SavePNGImage( std::string& fileAndPath, const PixelData& sourceImage )
+{
+	// Convert filename from single to wide string for GDI+ compatibility
+	size_t newsize = strlen( fileAndPath.c_str() ) + 1;
+	wchar_t* wcstring = new wchar_t[ newsize ];
+	size_t convertedChars = 0;
+	mbstowcs_s( &convertedChars, wcstring, newsize, fileAndPath.c_str(), _TRUNCATE );
 
-		//! @brief Allows you to get the unique ID of a GameObject if you only have a reference or a copy of it.
-		//! @return This GameObject's unique ID.
-		int GetId() { return m_id; }
+	Gdiplus::Bitmap* bitmap = new Gdiplus::Bitmap( sourceImage.width, sourceImage.height, PixelFormat32bppARGB );
+	Gdiplus::Rect rect( 0, 0, sourceImage.width, sourceImage.height );
+	Gdiplus::BitmapData bitmapData;
 
-	private:
-		// The GameObject's id should never be changed manually so we make it private!
-		int m_id{ -1 };
+	// Lock the bitmap in advance of writing its data
+	bitmap->LockBits( &rect, Gdiplus::ImageLockModeWrite, PixelFormat32bppARGB, &bitmapData );
 
-		// Preventing assignment and copying reduces the potential for bugs
-		GameObject& operator=(const GameObject&) = delete;
-		GameObject(const GameObject&) = delete;
-	};
+	Pixel* sourcePixels = sourceImage.pPixels;
+	Pixel* destPixels = static_cast<Pixel*>(bitmapData.Scan0);
 
-	// GameObject functions
-	//**************************************************************************************************
+	// Copy the data from source image to destination bitmap
+	for( int b = 0; b < sourceImage.width * sourceImage.height; b++ )
+		*destPixels++ = *sourcePixels++;
 
-	//! @brief Creates a new GameObject and adds it to the managed list.
-	//! @param type The type of the GameObject.
-	//! @param pos The initial x/y coordinates of the GameObject.
-	//! @param collisionRadius The radius of the collision circle of this GameObject.
-	//! @param spriteName The name of the sprite to use for the GameObject.
-	//! @return Returns the new object's unique id.
-	int CreateGameObject(int type, Point2D pos, int collisionRadius, const char* spriteName);
-	//! @brief Retrieves a GameObject from the ID passed to this function.
-	//! @param id The ID of the GameObject you wish to retrieve.
-	//! @return The game object associated with that ID. An object with a type of -1 is returned if no object can be found.
-	GameObject& GetGameObject(int id);
-	//! @brief Retrieves the first GameObject matching the type that you pass through as a parameter.
-	//! @param type The type of the GameObject you wish to retrieve.
-	//! @return The first GameObject that matches the given type. An object with a type of -1 is returned if no object can be found.
-	GameObject& GetGameObjectByType(int type);
-	//! @brief Collects the IDs of all of the GameObjects with the matching type
-	//! @param type The type of the GameObjects you wish to retrieve.
-	//! @return A vector containing IDs of GameObjects of that type. The vector will be empty if no GameObjects match the type.
-	std::vector<int> CollectGameObjectIDsByType(int type);
-	//! @brief Collects the IDs of all of the GameObjects
-	//! @return A vector containing the IDs of all of the GameObjects that the manager contains. The vector will be empty if there are no GameObjects.
-	std::vector<int> CollectAllGameObjectIDs();
-	//! @brief Performs a typical update of the object's position and animation. Changes its velocity by its acceleration, its position by its velocity, its rotation by its rotation speed, and its animation frame by its animation speed.
-	//! @note Can only be called once per object per frame unless allowMultipleUpdatesPerFrame is set to true.
-	//! @param object The GameObject you wish to update.
-	//! @param bWrap Should the object wrap around the edge of the screen to the other side? Defaults to no.
-	//! @param wrapBorderSize If the object is wrapping, then how far off the edge of the screen should the object get before it wraps? Defaults to 0 pixels.
-	//! @param allowMultipleUpdatesPerFrame If set to true, then this allows for the object to be updated again if it already has this frame.
-	void UpdateGameObject(GameObject& object, bool bWrap = false, int wrapBorderSize = 0, bool allowMultipleUpdatesPerFrame = false);
-	//! @brief Deletes the GameObject with the corresponding Id.
-	//! @param id The unique id of the GameObject you wish to delete.
-	void DestroyGameObject(int id);
-	//! @brief Deletes all GameObjects with the corresponding type.
-	//! @param type The type of the GameObjects you wish to delete.
-	void DestroyGameObjectsByType(int type);
-	//! @brief Deletes all GameObjects.
-	void DestroyAllGameObjects();
+	// Unlock the bitmap
+	bitmap->UnlockBits( &bitmapData );
 
-	//! @brief Checks whether the two GameObjects are within each other's collision radii.
-	//! @param obj1 The first GameObject we want to check has collided.
-	//! @param obj2 The second GameObject we want to check has collided.
-	//! @return Returns true if the GameObjects are overlapping, false otherwise.
-	bool IsColliding(GameObject& obj1, GameObject& obj2);
-	//! @brief Checks whether any part of the GameObject is visible within the DisplayBuffer
-	//! @param obj The GameObject that we want to check for visibility.
-	bool IsVisible(GameObject& obj);
-	//! @brief Checks whether the GameObject is overlapping the edge of the screen and moving outwards.
-	//! @param obj The GameObject that we want to check for overlapping.
-	//! @param dirn Which side of the screen are we checking? Defaults to all sides.
-	//! @return Returns true if the object is overlapping, false otherwise.
-	bool IsLeavingDisplayArea(GameObject& obj, Direction dirn = Direction::ALL);
-	//! @brief Checks whether the animation has completed playing.
-	//! @param obj The GameObject that we want to check.
-	//! @return Returns true if the animation has finished, false if it hasn't.
-	bool IsAnimationComplete(GameObject& obj);
-	//! @brief Sets the velocity and angle of the GameObject.
-	//! @param obj The GameObject you wish to change the velocity and direction of.
-	//! @param speed The number of pixels you want the GameObject to move in a straight line each time it is updated.
-	//! @param rotation The angle you want the GameObject to move in.
-	void SetGameObjectDirection(GameObject& obj, int speed, float rotation);
-	//! @brief Sets the rotation of the object to point towards the target coordinate.
-	//! @param obj The GameObject you wish to change the direction of.
-	//! @param targetX The x coordinate of the point you wish the object to point at.
-	//! @param targetY The y coordinate of the point you wish the object to point at.
-	void PointGameObject(GameObject& obj,int targetX, int targetY);
-	//! @brief Changes the GameObject's current spite and resets its animation frame to the start.
-	//! @param obj The GameObject you wish to set the sprite for.
-	//! @param spriteName The name of the sprite you wish to set for the GameObject.
-	//! @param animSpeed The number of frames to increase the animation by each time the GameObject is updated.
-	void SetSprite(GameObject& obj, const char* spriteName, float animSpeed );
-	//! @brief Changes the GameObject's current spite and resets its animation frame to the start.
-	//! @param obj The GameObject you wish to set the sprite for.
-	//! @param spriteIndex The index of the sprite you wish to set for the GameObject.
-	//! @param animSpeed The number of frames to increase the animation by each time the GameObject is updated.
-	void SetSprite( GameObject& obj, int spriteIndex, float animSpeed );
-	//! @brief Draws the GameObject's sprite without rotation or transparency. This is the fastest way to draw a GameObject, and so should be the preferred method when rotation and alpha are not required.
-	//! @param obj The GameObject you wish to draw.
-	void DrawObject(GameObject& obj);
-	//! @brief Draws the GameObject's sprite with transparency. This is slower than DrawObject and so should only be used if you require transparency.
-	//! @param obj The GameObject you wish to draw.
-	//! @param opacity How transparent the object should be. 0.0f is fully transparent and 1.0f is fully opaque.
-	void DrawObjectTransparent(GameObject& obj, float opacity);
-	//! @brief Draws the object's sprite with rotation, scale, and transparency. This is slower than DrawObject or DrawObjectTransparent and so should only be used if you require rotation or scale. Rotation and scale are taken from the properties of the GameObject.
-	//! @param obj The GameObject you wish to draw.
-	//! @param opacity How transparent the object should be. 0.0f is fully transparent and 1.0f is fully opaque.
-	void DrawObjectRotated(GameObject& obj, float opacity = 1.0f);
-	//! @brief Draws debug info for all of the GameObjects that exist.
-	//! @details This includes the object's ID, sprite name and current animation frame. It will also draw the sprite's boundaries and the collision radius of the object.
-	void DrawGameObjectsDebug();
+	// Save the bitmap as a PNG file
+	CLSID pngClsid;
+	GetEncoderClsid( L"image/png", &pngClsid );
+	int status = bitmap->Save( wcstring, &pngClsid, NULL );
+
+	delete bitmap;
+	delete[] wcstring;
+
+	if( status != Gdiplus::Ok )
+		return -status;
+
+	return 1;
 }
-#endif
-#endif // PLAY_PLAYOBJECT_H
 
-#endif // PLAYPCH_H
-//*******************************************************************
-//*******************************************************************
-#ifdef PLAY_IMPLEMENTATION
-//*******************************************************************
-//*******************************************************************
 //********************************************************************************************************************************
-//* File:			PlayMemory.cpp
-//* Platform:		Independent
-//* Description:	Implementation of a simple memory tracker to prevent leaks. 
-//*                 Avoids use of STL or anything else which allocates memory as this could create infinite loops!
-//* Notes:          This is a simple approach to support your understanding of overriding the new operator.
-//*                 See below for alternative approaches:
-//*                 1) The CRT Debug Heap Library 
-//*                 https://docs.microsoft.com/en-us/visualstudio/debugger/crt-debug-heap-details?view=vs-2019
-//*                 2) Heap Profiling in the debugger 
-//*                 https://docs.microsoft.com/en-us/visualstudio/profiling/memory-usage?view=vs-2019
+// Miscellaneous functions
 //********************************************************************************************************************************
 
+void AssertFailMessage( const char* message, const char* file, long line )
+{
+	// file - the file in which the assertion failed ( __FILE__ )
+	// line - the line of code where the assertion failed ( __LINE__ )
+	std::filesystem::path p = file;
+	std::string s = p.filename().string() + " : LINE " + std::to_string(line);
+	s += "\n" + std::string(message);
+	int wide_count = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, NULL, 0);
+	wchar_t* wide = new wchar_t[wide_count];
+	MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, wide, wide_count);
+	MessageBox(NULL, wide, (LPCWSTR)L"Assertion Failure", MB_ICONWARNING);
+	delete[] wide;
+}
+
+void DebugOutput( const char* s )
+{
+	OutputDebugStringA(s);
+}
+
+void DebugOutput( std::string s )
+{
+	OutputDebugStringA(s.c_str());
+}
+
+void TracePrintf( const char* file, int line, const char* fmt, ... )
+{
+	constexpr size_t kMaxBufferSize = 512u;
+	char buffer[kMaxBufferSize];
+
+	va_list args;
+	va_start(args, fmt);
+	// format should be double click-able in VS 
+	int len = sprintf_s(buffer, kMaxBufferSize, "%s(%d): ", file, line);
+	vsprintf_s(buffer + len, kMaxBufferSize - len, fmt, args);
+	DebugOutput(buffer);
+	va_end(args);
+}
+
+//********************************************************************************************************************************
+// File:		PlayRender.cpp
+// Description:	A software pixel renderer for drawing 2D primitives into a PixelData buffer
+// Platform:	Independent
+//********************************************************************************************************************************
 
-#pragma comment(lib, "DbgHelp.lib")
 
-#ifdef _DEBUG
+#define ASSERT_RENDERTARGET	PLAY_ASSERT_MSG( Play::Render::m_pRenderTarget, "Render Target not initialised. Call Render::SetRenderTarget() before using the Play::Render library functions.")
 
-namespace Play
+namespace Play::Render
 {
-	constexpr int MAX_ALLOCATIONS = 8192 * 4;
-	constexpr int MAX_FILENAME = 1024;
-	constexpr int STACKTRACE_OFFSET = 2;
-	constexpr int STACKTRACE_DEPTH = 1;
+	// Internal (private) namespace variables
+	PixelData* m_pRenderTarget{ nullptr };
 
-	static unsigned int g_allocId = 0;
+	PixelData* SetRenderTarget( PixelData* pRenderTarget ) 
+	{ 
+		PixelData* old = m_pRenderTarget; 
+		m_pRenderTarget = pRenderTarget; 
+		return old; 
+	}
 
-	// A structure to store data on each memory allocation
-	struct ALLOC
+	thread_local ClipRect m_clipRect;
+
+	void SetClipRect( const ClipRect& clipRect )
 	{
-		void* address = 0;
-		size_t sizeBytes = 0;
-		int id = 0;
-		void* stack[STACKTRACE_DEPTH];
-		int frames;
-	};
+		m_clipRect = clipRect;
+	}
 
-	ALLOC g_allocations[MAX_ALLOCATIONS];
-	unsigned int g_allocCount = 0;
-	int g_id = -1;
-	void* g_allocDeleted = nullptr;
+	ClipRect GetClipRect()
+	{
+		return m_clipRect;
+	}
 
-	CRITICAL_SECTION g_allocCritSec;
+	void ClearClipRect()
+	{
+		m_clipRect = ClipRect();
+	}
 
-	// A method for printing out all the memory allocation immediately before program exit (or as close as you can get)
-	// This is achieved by creating a class as a static object before the first memory allocation, which stays in scope until
-	// after everything else is destroyed. When it is cleaned up its destructor prints the allocations to show us any leaks!
-	class DestroyedLast
+	SimdLevel DetectSimdLevel()
 	{
-	public:
-		DestroyedLast()
+#ifdef PLAY_SIMD_X86
+		int info[4];
+		__cpuid( info, 0 );
+		int maxLeaf = info[0];
+		__cpuid( info, 1 );
+		bool sse2 = ( info[3] >> 26 ) & 1;
+		bool osxsave = ( info[2] >> 27 ) & 1;
+		bool avx = ( info[2] >> 28 ) & 1;
+
+		// AVX2 also needs the operating system to preserve the 256-bit registers
+		if( maxLeaf >= 7 && osxsave && avx && ( _xgetbv( 0 ) & 0x6 ) == 0x6 )
 		{
-			InitializeCriticalSectionAndSpinCount(&g_allocCritSec, 64);
+			__cpuidex( info, 7, 0 );
+			if( ( info[1] >> 5 ) & 1 )
+				return SimdLevel::AVX2;
+		}
 
-#ifdef _DEBUG
-			HANDLE process = GetCurrentProcess();
-			SymInitialize(process, NULL, TRUE);
-			SymSetOptions(SYMOPT_LOAD_LINES);
+		if( sse2 )
+			return SimdLevel::SSE2;
 #endif
+		return SimdLevel::SCALAR;
+	}
 
-			PrintAllocations("<STARTUP>");
-		}
-		~DestroyedLast()
-		{
-			if (g_allocCount > 0)
-			{
-				PrintAllocations("<MEMORY LEAK>");
-			}
-			else
-			{
-				DebugOutput("**************************************************\n");
-				DebugOutput("NO MEMORY LEAKS!\n");
-				DebugOutput("**************************************************\n");
-			}
-
-			DeleteCriticalSection(&g_allocCritSec);
-		}
-	};
+	SimdLevel m_simdLevel{ DetectSimdLevel() };
 
-	void CreateStaticObject(void)
+	SimdLevel GetSimdLevel()
 	{
-		static DestroyedLast last;
+		return m_simdLevel;
 	}
 
-	void TrackAllocation(void* ptr, std::size_t sizeBytes)
+	void SetSimdLevel( SimdLevel level )
 	{
-		CreateStaticObject();
+		m_simdLevel = std::min( level, DetectSimdLevel() );
+	}
 
-		EnterCriticalSection(&g_allocCritSec);
+	SamplingMode m_samplingMode{ SAMPLE_NEAREST };
 
-		PLAY_ASSERT(g_allocCount < MAX_ALLOCATIONS);
-		ALLOC& rAlloc(g_allocations[g_allocCount++]);
-		rAlloc.address = ptr;
-		rAlloc.sizeBytes = sizeBytes;
-		rAlloc.frames = RtlCaptureStackBackTrace(STACKTRACE_OFFSET, STACKTRACE_DEPTH, rAlloc.stack, NULL);
+	void SetSamplingMode( SamplingMode mode )
+	{
+		m_samplingMode = mode;
+	}
 
-		LeaveCriticalSection(&g_allocCritSec);
+	SamplingMode GetSamplingMode()
+	{
+		return m_samplingMode;
 	}
 
-	void UntrackAllocation(void* ptr)
+	// Opaque or transparent runs shorter than this are left for the blend functions, as they handle them at least as quickly
+	constexpr int MIN_SPAN_LENGTH = 4;
+
+	void BuildSpanTable( const PixelData& preMultData, int frameWidth, SpanTable& spanTable )
 	{
-		EnterCriticalSection(&g_allocCritSec);
-		g_allocDeleted = ptr;
+		PLAY_ASSERT_MSG( frameWidth > 0, "Span table frame width must be greater than zero" );
 
-		for (unsigned int i = 0; i < g_allocCount; i++)
+		// A canvas which isn't an exact multiple of the frame width has a partial frame at the end of each row (as in PreMultiplyAlpha)
+		spanTable.framesPerRow = ( preMultData.width + frameWidth - 1 ) / frameWidth;
+		spanTable.rowIndex.clear();
+		spanTable.spans.clear();
+		spanTable.rowIndex.reserve( static_cast<size_t>( preMultData.height ) * spanTable.framesPerRow + 1 );
+
+		auto classify = []( uint32_t pixel ) { return pixel >= 0xFF000000 ? SPAN_TRANSPARENT : ( pixel >> 24 ) == 0 ? SPAN_OPAQUE : SPAN_TRANSLUCENT; };
+
+		for( int y = 0; y < preMultData.height; y++ )
 		{
-			if (g_allocations[i].address == ptr)
+			for( int frameX = 0; frameX < preMultData.width; frameX += frameWidth )
 			{
-				if (g_allocations[i].id == g_id)
-					g_allocations[i].id = g_id;
+				const uint32_t* pRow = &preMultData.pPixels[ ( y * preMultData.width ) + frameX ].bits;
+				int rowWidth = std::min( frameWidth, preMultData.width - frameX );
+				size_t firstSpan = spanTable.spans.size();
+				spanTable.rowIndex.push_back( static_cast<uint32_t>( firstSpan ) );
 
-				g_allocations[i] = g_allocations[g_allocCount - 1];
-				g_allocations[g_allocCount - 1].address = nullptr;
-				g_allocCount--;
+				for( int x = 0; x < rowWidth; )
+				{
+					SpanType type = classify( pRow[x] );
+					int end = x + 1;
+					while( end < rowWidth && classify( pRow[end] ) == type )
+						end++;
 
-				// Early out
-				LeaveCriticalSection(&g_allocCritSec);
-				return;
+					if( end - x < MIN_SPAN_LENGTH )
+						type = SPAN_TRANSLUCENT;
+
+					// Join up with the previous span in this row if they are drawn the same way
+					if( spanTable.spans.size() > firstSpan && spanTable.spans.back().type == type )
+						spanTable.spans.back().length += end - x;
+					else
+						spanTable.spans.push_back( { x, end - x, type } );
+
+					x = end;
+				}
 			}
 		}
-		LeaveCriticalSection(&g_allocCritSec);
+		spanTable.rowIndex.push_back( static_cast<uint32_t>( spanTable.spans.size() ) );
 	}
 
-	//********************************************************************************************************************************
-	// Printing allocations
-	//********************************************************************************************************************************
-
-	void PrintAllocation(const char* tagText, const ALLOC& rAlloc)
+	void PackRowRGB565( const uint32_t* pSrc, uint16_t* pDest, int count )
 	{
-		char buffer[MAX_FILENAME * 2] = { 0 };
-
-		if (rAlloc.address != nullptr)
+		int x = 0;
+#ifdef PLAY_SIMD_X86
+		if( m_simdLevel == SimdLevel::AVX2 )
 		{
-			HANDLE process = GetCurrentProcess();
-
-			DWORD  dwDisplacement;
-
-			IMAGEHLP_LINE64 line;
-			constexpr size_t MAX_SYM_NAME_LENGTH = 255;
-			SYMBOL_INFO* symbol = (SYMBOL_INFO*)malloc(sizeof(SYMBOL_INFO) + MAX_SYM_NAME_LENGTH + 1);
-			symbol->MaxNameLen = MAX_SYM_NAME_LENGTH;
-			symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
-
-			sprintf_s(buffer, "%s 0x%02p %d bytes [%d]: \n", tagText, rAlloc.address, static_cast<int>(rAlloc.sizeBytes), rAlloc.id);
-			DebugOutput(buffer);
-			for (int i = 0; i < rAlloc.frames; ++i)
+			const __m256i redMask = _mm256_set1_epi32( 0xF800 );
+			const __m256i greenMask = _mm256_set1_epi32( 0x07E0 );
+			const __m256i blueMask = _mm256_set1_epi32( 0x001F );
+			for( ; x + 16 <= count; x += 16 )
 			{
-				SymFromAddr(process, (DWORD64)(rAlloc.stack[i]), 0, symbol);
-				SymGetLineFromAddr64(process, (DWORD64)rAlloc.stack[i], &dwDisplacement, &line);
-
-				// Format in such a way that VS can double click to jump to the allocation.
-				sprintf_s(buffer, "%s(%d): %s\n", line.FileName, line.LineNumber, symbol->Name);
+				__m256i packed[2];
+				for( int half = 0; half < 2; half++ )
+				{
+					__m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( pSrc + x + ( half * 8 ) ) );
+					__m256i red = _mm256_and_si256( _mm256_srli_epi32( src, 8 ), redMask );
+					__m256i green = _mm256_and_si256( _mm256_srli_epi32( src, 5 ), greenMask );
+					__m256i blue = _mm256_and_si256( _mm256_srli_epi32( src, 3 ), blueMask );
+					packed[half] = _mm256_or_si256( _mm256_or_si256( red, green ), blue );
+				}
 
-				DebugOutput(buffer);
+				// Packing works within each 128-bit lane, so the middle two groups of four come out swapped
+				__m256i result = _mm256_permute4x64_epi64( _mm256_packus_epi32( packed[0], packed[1] ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( pDest + x ), result );
 			}
-
-			free(symbol);
+		}
+#endif
+		for( ; x < count; x++ )
+		{
+			uint32_t src = pSrc[x];
+			pDest[x] = static_cast<uint16_t>( ( ( src >> 8 ) & 0xF800 ) | ( ( src >> 5 ) & 0x07E0 ) | ( ( src >> 3 ) & 0x001F ) );
 		}
 	}
 
-	void PrintAllocations(const char* tagText)
+	void ExpandRowRGB565( const uint16_t* pSrc, uint32_t* pDest, int count )
 	{
-		EnterCriticalSection(&g_allocCritSec);
-
-		int bytes = 0;
-		char buffer[MAX_FILENAME * 2] = { 0 };
-		DebugOutput("****************************************************\n");
-		DebugOutput("MEMORY ALLOCATED\n");
-		DebugOutput("****************************************************\n");
-		for (unsigned int n = 0; n < g_allocCount; n++)
+		int x = 0;
+#ifdef PLAY_SIMD_X86
+		if( m_simdLevel == SimdLevel::AVX2 )
 		{
-			ALLOC& a = g_allocations[n];
-			PrintAllocation(tagText, a);
-			bytes += static_cast<int>(a.sizeBytes);
+			const __m256i opaque = _mm256_set1_epi32( 0xFF000000 );
+			for( ; x + 8 <= count; x += 8 )
+			{
+				__m256i src = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + x ) ) );
+				__m256i red = _mm256_or_si256( _mm256_slli_epi32( _mm256_and_si256( src, _mm256_set1_epi32( 0xF800 ) ), 8 ), _mm256_slli_epi32( _mm256_and_si256( src, _mm256_set1_epi32( 0xE000 ) ), 3 ) );
+				__m256i green = _mm256_or_si256( _mm256_slli_epi32( _mm256_and_si256( src, _mm256_set1_epi32( 0x07E0 ) ), 5 ), _mm256_srli_epi32( _mm256_and_si256( src, _mm256_set1_epi32( 0x0600 ) ), 1 ) );
+				__m256i blue = _mm256_or_si256( _mm256_slli_epi32( _mm256_and_si256( src, _mm256_set1_epi32( 0x001F ) ), 3 ), _mm256_srli_epi32( _mm256_and_si256( src, _mm256_set1_epi32( 0x001C ) ), 2 ) );
+				__m256i result = _mm256_or_si256( _mm256_or_si256( red, green ), _mm256_or_si256( blue, opaque ) );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>( pDest + x ), result );
+			}
 		}
-		sprintf_s(buffer, "%s Total = %d bytes\n", tagText, bytes);
-		DebugOutput(buffer);
-		DebugOutput("**************************************************\n");
-
-		LeaveCriticalSection(&g_allocCritSec);
-	}
-
-} // namespace Play
-
-//********************************************************************************************************************************
-// Overrides for new operator (x2)
-//********************************************************************************************************************************
-void* operator new  (std::size_t sizeBytes)
-{
-	void* ptr = malloc(sizeBytes);
-	Play::TrackAllocation(ptr, sizeBytes);
-	return ptr;
-}
-
-void* operator new[](std::size_t sizeBytes)
-{
-	void* ptr = malloc(sizeBytes);
-	Play::TrackAllocation(ptr, sizeBytes);
-	return ptr;
-}
-
-//********************************************************************************************************************************
-// Overrides for delete operator (x2)
-//********************************************************************************************************************************
-void operator delete  (void* ptr) noexcept
-{
-	Play::UntrackAllocation(ptr);
-	free(ptr);
-}
-
-void operator delete[](void* ptr) noexcept
-{
-	Play::UntrackAllocation(ptr);
-	free(ptr);
-}
 #endif
+		for( ; x < count; x++ )
+		{
+			uint32_t src = pSrc[x];
+			uint32_t red = ( ( src & 0xF800 ) << 8 ) | ( ( src & 0xE000 ) << 3 );
+			uint32_t green = ( ( src & 0x07E0 ) << 5 ) | ( ( src & 0x0600 ) >> 1 );
+			uint32_t blue = ( ( src & 0x001F ) << 3 ) | ( ( src & 0x001C ) >> 2 );
+			pDest[x] = 0xFF000000 | red | green | blue;
+		}
+	}
 
-//********************************************************************************************************************************
-// File:		PlayWindow.cpp
-// Description:	Platform specific code to provide a window to draw into
-// Platform:	Windows
-// Notes:		Uses a 32-bit ARGB display buffer
-//********************************************************************************************************************************
-
-using namespace Play; 
-
-// Instruct Visual Studio to add these to the list of libraries to link
-#pragma comment(lib, "gdiplus.lib")
-#pragma comment(lib, "dwmapi.lib")
-
-// External functions which must be implemented by the user 
-extern void MainGameEntry( int argc, char* argv[] ); 
-extern bool MainGameUpdate( float ); // Called every frame
-extern int MainGameExit( void ); // Called on quit
-	
-ULONG_PTR g_pGDIToken = 0;
-
-#define ASSERT_WINDOW PLAY_ASSERT_MSG( Play::Window::m_bCreated, "Window Manager not initialised. Call Window::CreateManager() before using the Play::Window library functions.")
-
-int WINAPI WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nShowCmd )
-{
-	// Initialize GDI+
-	Gdiplus::GdiplusStartupInput startupInput;
-	ULONG_PTR token;
-	Gdiplus::Status gdiStatus = Gdiplus::GdiplusStartup(&token, &startupInput, NULL);
-	PLAY_ASSERT(Gdiplus::Ok == gdiStatus);
-	g_pGDIToken = token;
+	void ClearRenderTarget( Pixel colour ) 
+	{
+		ASSERT_RENDERTARGET;
+		ClipRect clip = GetDrawableRect();
 
-	MainGameEntry(__argc, __argv);
+		uint16_t packed = 0;
+		PackRowRGB565( &colour.bits, &packed, 1 );
 
-	return Play::Window::HandleWindows( hInstance, hPrevInstance, lpCmdLine, nShowCmd, L"PlayBuffer" );
-}
+		for (int y = clip.top; y < clip.bottom && clip.left < clip.right; y++)
+		{
+			if (m_pRenderTarget->format == PIXEL_RGB565)
+			{
+				uint16_t* pRow = reinterpret_cast<uint16_t*>(m_pRenderTarget->pPixels) + (m_pRenderTarget->width * y);
+				std::fill(pRow + clip.left, pRow + clip.right, packed);
+				continue;
+			}
 
-namespace Play::Window
-{
-	// Private data
-	int m_scale{ 0 };
-	PixelData* m_pPlayBuffer{ nullptr };
-	MouseData* m_pMouseData{ nullptr };
-	HWND m_hWindow{ nullptr };
-	bool m_bCreated = false;
+			Pixel* pRow = m_pRenderTarget->pPixels + (m_pRenderTarget->width * y);
+			std::fill(pRow + clip.left, pRow + clip.right, colour);
+		}
 
-	//********************************************************************************************************************************
-	// Create / Destroy functions for the Window Manager
-	//********************************************************************************************************************************
+		// Only written when it changes, as other threads may be clearing other parts of the same target
+		if (m_pRenderTarget->preMultiplied)
+			m_pRenderTarget->preMultiplied = false;
+	}
 
-	bool CreateManager( PixelData* pDisplayBuffer, int nScale )
+	void BlitBackground( PixelData& backgroundImage ) 
 	{
-		PLAY_ASSERT(pDisplayBuffer);
-		PLAY_ASSERT(nScale > 0);
-		m_pPlayBuffer = pDisplayBuffer;
-		m_scale = nScale;
-		m_bCreated = true;
-		return true;
+		ASSERT_RENDERTARGET;
+		PLAY_ASSERT_MSG(backgroundImage.height == m_pRenderTarget->height && backgroundImage.width == m_pRenderTarget->width, "Background size doesn't match render target!");
+		ClipRect clip = GetDrawableRect();
+		if (clip.left >= clip.right)
+			return;
+
+		// Takes about 1ms for 720p screen on i7-8550U
+		for (int y = clip.top; y < clip.bottom; y++)
+		{
+			int offset = (m_pRenderTarget->width * y) + clip.left;
+			if (m_pRenderTarget->format == PIXEL_RGB565)
+				PackRowRGB565(&backgroundImage.pPixels[offset].bits, reinterpret_cast<uint16_t*>(m_pRenderTarget->pPixels) + offset, clip.right - clip.left);
+			else
+				memcpy(m_pRenderTarget->pPixels + offset, backgroundImage.pPixels + offset, sizeof(Pixel) * (clip.right - clip.left));
+		}
 	}
 
-	bool DestroyManager( void )
+	bool GetTransformedArea( int srcDrawWidth, int srcDrawHeight, const Point2f& srcOrigin, const Matrix2D& transform, TransformedArea& area )
 	{
-		ASSERT_WINDOW;
-		m_bCreated = false;
-		return true;
-	}
+		ASSERT_RENDERTARGET;
 
-	//********************************************************************************************************************************
-	// Windows functions
-	//********************************************************************************************************************************
+		// We flip the y screen coordinate and reverse the rotatation to be consistant with a right-handed Cartesian co-ordinate system 
+		Matrix2D right;
+		right.row[0] = { transform.row[0].x, transform.row[1].x, 0.0f };
+		right.row[1] = { transform.row[0].y, transform.row[1].y, 0.0f };
+		right.row[2] = { transform.row[2].x, m_pRenderTarget->height - transform.row[2].y, 1.0f };
 
-	int HandleWindows( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow, LPCWSTR windowName )
-	{
-		ASSERT_WINDOW;
+		static float inf = std::numeric_limits<float>::infinity();
+		float dst_minx{ inf }, dst_miny{ inf }, dst_maxx{ -inf }, dst_maxy{ -inf };
 
-		UNREFERENCED_PARAMETER(hPrevInstance);
-		UNREFERENCED_PARAMETER(lpCmdLine);
+		float x[2] = { -srcOrigin.x, srcDrawWidth - srcOrigin.x };
+		float y[2] = { -srcOrigin.y, srcDrawHeight - srcOrigin.y };
+		Point2f vertices[4] = { { x[0], y[0] }, { x[1], y[0] }, { x[1], y[1] }, { x[0], y[1] } };
 
-		WNDCLASSEXW wcex;
+		// Calculate the extremes of the rotated corners.
+		for (int i = 0; i < 4; i++)
+		{
+			vertices[i] = right.Transform(vertices[i]);
+			dst_minx = floor(dst_minx < vertices[i].x ? dst_minx : vertices[i].x);
+			dst_maxx = ceil(dst_maxx > vertices[i].x ? dst_maxx : vertices[i].x);
+			dst_miny = floor(dst_miny < vertices[i].y ? dst_miny : vertices[i].y);
+			dst_maxy = ceil(dst_maxy > vertices[i].y ? dst_maxy : vertices[i].y);
+		}
 
-		wcex.cbSize = sizeof(WNDCLASSEX);
+		int dst_buffer_width = m_pRenderTarget->width;
+		int dst_buffer_height = m_pRenderTarget->height;
 
-		wcex.style = CS_HREDRAW | CS_VREDRAW;
-		wcex.lpfnWndProc = Play::Window::WndProc;
-		wcex.cbClsExtra = 0;
-		wcex.cbWndExtra = 0;
-		wcex.hInstance = hInstance;
-		wcex.hIcon = LoadIcon(hInstance, IDI_APPLICATION);
-		wcex.hCursor = LoadCursor(nullptr, IDC_ARROW);
-		wcex.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
-		wcex.lpszMenuName = nullptr;
-		wcex.lpszClassName = windowName;
-		wcex.hIconSm = LoadIcon(wcex.hInstance, IDI_APPLICATION);
+		// Nothing within the render target to draw, so don't bother with the inverse transform
+		if (dst_maxx <= 0.0f || dst_maxy <= 0.0f || dst_minx >= (float)dst_buffer_width || dst_miny >= (float)dst_buffer_height)
+			return false;
 
-		RegisterClassExW(&wcex);
+		// Calculate the minimum drawing area which would contain the rotated corners
+		int dst_draw_width = static_cast<int>(dst_maxx - dst_minx);
+		int dst_draw_height = static_cast<int>(dst_maxy - dst_miny);
 
-		int	w = m_pPlayBuffer->width * m_scale;
-		int h = m_pPlayBuffer->height * m_scale;
+		// Clip the drawing area if any of the rotated corners are outside of the render target buffer
+		if (dst_miny < 0) { dst_draw_height += (int)dst_miny; dst_miny = 0; }
+		if (dst_maxy > (float)dst_buffer_height) { dst_draw_height -= (int)dst_maxy - dst_buffer_height; dst_maxy = (float)dst_buffer_height; }
+		if (dst_minx < 0) { dst_draw_width += (int)dst_minx; dst_minx = 0; }
+		if (dst_maxx > (float)dst_buffer_width) { dst_draw_width -= (int)dst_maxx - dst_buffer_width;  dst_maxx = (float)dst_buffer_width; }
 
-		UINT dwStyle = WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU;
-		RECT rect = { 0, 0, w, h };
-		AdjustWindowRect(&rect, dwStyle, FALSE);
-		HWND hWnd = CreateWindowW(windowName, windowName, dwStyle, CW_USEDEFAULT, CW_USEDEFAULT, rect.right - rect.left, rect.bottom - rect.top, nullptr, nullptr, hInstance, nullptr);
+		if (dst_draw_width <= 0 || dst_draw_height <= 0)
+			return false;
 
-		if (!hWnd)
-			return FALSE;
+		// Only the rows and columns inside the clip rectangle are drawn, but pixel positions are still worked out from the whole drawing area
+		// > This way the clip rectangle can't change the result of any individual pixel
+		ClipRect clip = GetDrawableRect();
+		int row_begin = std::max(clip.top - static_cast<int>(dst_miny), 0);
+		int row_end = std::min(clip.bottom - static_cast<int>(dst_miny), dst_draw_height);
+		int column_begin = std::max(clip.left - static_cast<int>(dst_minx), 0);
+		int column_end = std::min(clip.right - static_cast<int>(dst_minx), dst_draw_width);
 
-		m_hWindow = hWnd;
+		if (row_begin >= row_end || column_begin >= column_end)
+			return false;
 
-		ShowWindow(hWnd, nCmdShow);
-		UpdateWindow(hWnd);
+		// Calculate the inverse transform so that we can iterate through the render target's pixels within the sprite's space
+		if (Determinant(right) == 0.0f) return false;
+		Matrix2D invTransform = right;
+		invTransform.Inverse();
 
-		HACCEL hAccelTable = LoadAccelerators(hInstance, windowName);
+		// Transform the starting position within the render target into the sprite's space 
+		Point2f dst_pixel_start{ dst_minx, dst_miny };
+		area.srcStart = invTransform.Transform(dst_pixel_start) + srcOrigin;
+		area.invTransform = invTransform;
+		area.dstX = static_cast<int>(dst_pixel_start.x);
+		area.dstY = static_cast<int>(dst_pixel_start.y);
+		area.width = dst_draw_width;
+		area.height = dst_draw_height;
+		area.rowBegin = row_begin;
+		area.rowEnd = row_end;
+		area.columnBegin = column_begin;
+		area.columnEnd = column_end;
+		return true;
+	}
 
-		LARGE_INTEGER frequency;
-		double elapsedTime = 0.0;
-		static LARGE_INTEGER lastDrawTime;
-		LARGE_INTEGER now;
+	void TransformToPixels( const PixelData& srcPixelData, int srcFrameOffset, int srcDrawWidth, int srcDrawHeight, const Point2f& srcOrigin, const Matrix2D& transform, BlendColour globalMultiply, SamplingMode samplingMode, PixelData& result, int& offsetX, int& offsetY )
+	{
+		// The same flipped transform that TransformPixels uses, but around the origin
+		Matrix2D right;
+		right.row[0] = { transform.row[0].x, transform.row[1].x, 0.0f };
+		right.row[1] = { transform.row[0].y, transform.row[1].y, 0.0f };
+		right.row[2] = { 0.0f, 0.0f, 1.0f };
 
-		MSG msg{};
-		bool quit = false;
+		result = PixelData();
+		offsetX = offsetY = 0;
+		if( Determinant( right ) == 0.0f )
+			return;
 
-		// Set up counters for timing the frame
-		QueryPerformanceCounter(&lastDrawTime);
-		QueryPerformanceFrequency(&frequency);
+		float x[2] = { -srcOrigin.x, srcDrawWidth - srcOrigin.x };
+		float y[2] = { -srcOrigin.y, srcDrawHeight - srcOrigin.y };
+		Point2f vertices[4] = { { x[0], y[0] }, { x[1], y[0] }, { x[1], y[1] }, { x[0], y[1] } };
 
-		// Standard windows message loop
-		while (!quit)
+		float minX = std::numeric_limits<float>::infinity(), minY = minX;
+		float maxX = -minX, maxY = -minX;
+		for( Point2f& v : vertices )
 		{
-			// Hangle windows messages
-			if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
+			v = right.Transform( v );
+			minX = std::min( minX, v.x );
+			maxX = std::max( maxX, v.x );
+			minY = std::min( minY, v.y );
+			maxY = std::max( maxY, v.y );
+		}
+
+		offsetX = static_cast<int>( std::floor( minX ) );
+		offsetY = static_cast<int>( std::floor( minY ) );
+		result.width = static_cast<int>( std::ceil( maxX ) ) - offsetX;
+		result.height = static_cast<int>( std::ceil( maxY ) ) - offsetY;
+		result.pPixels = new Pixel[static_cast<size_t>( result.width ) * result.height];
+		result.preMultiplied = true;
+
+		// Step through the sprite in 16.16 fixed point from the top left of the result, in the same way as TransformPixels
+		Matrix2D invTransform = right;
+		invTransform.Inverse();
+		Point2f start = invTransform.Transform( Point2f{ static_cast<float>( offsetX ), static_cast<float>( offsetY ) } ) + srcOrigin;
+		int64_t fix_posx = ToFixed16( start.x );
+		int64_t fix_posy = ToFixed16( start.y );
+		int64_t fix_xincx = ToFixed16( invTransform.row[0].x );
+		int64_t fix_xincy = ToFixed16( invTransform.row[0].y );
+		int64_t fix_yincx = ToFixed16( invTransform.row[1].x );
+		int64_t fix_yincy = ToFixed16( invTransform.row[1].y );
+
+		if( samplingMode == SAMPLE_DEFAULT ) samplingMode = m_samplingMode;
+		bool bilinear = samplingMode == SAMPLE_BILINEAR;
+		bool unitMultiply = globalMultiply.alpha == 1.0f && globalMultiply.red == 1.0f && globalMultiply.green == 1.0f && globalMultiply.blue == 1.0f;
+		BlendFactors factors = GetBlendFactors( globalMultiply );
+		const uint32_t* src_frame = &srcPixelData.pPixels->bits + srcFrameOffset;
+
+		for( int row = 0; row < result.height; row++ )
+		{
+			uint32_t* dest = &result.pPixels[row * result.width].bits;
+			int64_t posx = fix_posx + row * fix_yincx;
+			int64_t posy = fix_posy + row * fix_yincy;
+			for( int column = 0; column < result.width; column++, posx += fix_xincx, posy += fix_xincy )
 			{
-				if (msg.message == WM_QUIT)
-					break;
+				uint32_t pixel = 0xFF000000;
+				if( bilinear )
+				{
+					if( ( posx >> 16 ) >= -1 && ( posy >> 16 ) >= -1 && ( posx >> 16 ) < srcDrawWidth && ( posy >> 16 ) < srcDrawHeight )
+						pixel = SampleBilinear( src_frame, srcPixelData.width, srcDrawWidth, srcDrawHeight, posx, posy );
+				}
+				else
+				{
+					// SAMPLE_NEAREST_FLOAT is sampled in fixed point as well
+					int64_t roundX = ( posx + 0x8000 ) >> 16;
+					int64_t roundY = ( posy + 0x8000 ) >> 16;
+					if( roundX >= 0 && roundY >= 0 && roundX < srcDrawWidth && roundY < srcDrawHeight )
+						pixel = src_frame[roundX + ( roundY * srcPixelData.width )];
+				}
 
-				if (!TranslateAccelerator(msg.hwnd, hAccelTable, &msg))
+				// The global multiply scales the colours and the alpha in the same way as the blend functions do
+				if( !unitMultiply && pixel < 0xFF000000 )
 				{
-					TranslateMessage(&msg);
-					DispatchMessage(&msg);
+					uint32_t alpha = DivideBy255( ( 0xFF - ( pixel >> 24 ) ) * factors.alpha );
+					uint32_t red = std::min( ( ( ( pixel >> 16 ) & 0xFF ) * factors.red ) >> 8, 0xFFu );
+					uint32_t green = std::min( ( ( ( pixel >> 8 ) & 0xFF ) * factors.green ) >> 8, 0xFFu );
+					uint32_t blue = std::min( ( ( pixel & 0xFF ) * factors.blue ) >> 8, 0xFFu );
+					pixel = ( ( 0xFF - alpha ) << 24 ) | ( red << 16 ) | ( green << 8 ) | blue;
 				}
+				dest[column] = pixel;
 			}
+			CountTransparentRuns( dest, result.width );
+		}
+	}
 
-			do
-			{
-				QueryPerformanceCounter(&now);
-				elapsedTime = (now.QuadPart - lastDrawTime.QuadPart) * 1000.0 / frequency.QuadPart;
-
-			} while (elapsedTime < 1000.0f / FRAMES_PER_SECOND);
+	ClipRect GetTransformedBounds( int srcDrawWidth, int srcDrawHeight, const Point2f& srcOrigin, const Matrix2D& transform )
+	{
+		ASSERT_RENDERTARGET;
 
-			// Call the main game update function (only while we have the input focus in release mode)
-#ifndef _DEBUG
-			if (GetFocus() == m_hWindow)
-#endif
-				quit = MainGameUpdate(static_cast<float>(elapsedTime) / 1000.0f);
+		// The same flipped transform that TransformPixels uses
+		Matrix2D right;
+		right.row[0] = { transform.row[0].x, transform.row[1].x, 0.0f };
+		right.row[1] = { transform.row[0].y, transform.row[1].y, 0.0f };
+		right.row[2] = { transform.row[2].x, m_pRenderTarget->height - transform.row[2].y, 1.0f };
 
-			lastDrawTime = now;
+		float x[2] = { -srcOrigin.x, srcDrawWidth - srcOrigin.x };
+		float y[2] = { -srcOrigin.y, srcDrawHeight - srcOrigin.y };
+		Point2f vertices[4] = { { x[0], y[0] }, { x[1], y[0] }, { x[1], y[1] }, { x[0], y[1] } };
 
-			DwmFlush(); // Waits for DWM compositor to finish
+		float minX = std::numeric_limits<float>::infinity(), minY = minX;
+		float maxX = -minX, maxY = -minX;
+		for (Point2f& v : vertices)
+		{
+			v = right.Transform(v);
+			minX = std::min(minX, v.x);
+			maxX = std::max(maxX, v.x);
+			minY = std::min(minY, v.y);
+			maxY = std::max(maxY, v.y);
 		}
 
-		// Call the main game cleanup function
-		MainGameExit();
+		// Leave a pixel spare for rounding, and keep well within the range of an int
+		ClipRect bounds;
+		bounds.left = static_cast<int>(std::max(std::floor(minX), -1e8f)) - 1;
+		bounds.top = static_cast<int>(std::max(std::floor(minY), -1e8f)) - 1;
+		bounds.right = static_cast<int>(std::min(std::ceil(maxX), 1e8f)) + 1;
+		bounds.bottom = static_cast<int>(std::min(std::ceil(maxY), 1e8f)) + 1;
+		return bounds;
+	}
+}
+//********************************************************************************************************************************
+// File:		PlayGraphics.cpp
+// Description:	Manages 2D graphics operations on a PixelData buffer 
+// Platform:	Independent
+// Notes:		Uses PNG format. The end of the filename indicates the number of frames e.g. "bat_4.png" or "tiles_10x10.png"
+//********************************************************************************************************************************
 
-		PLAY_ASSERT(g_pGDIToken);
-		Gdiplus::GdiplusShutdown(g_pGDIToken);
 
-		return static_cast<int>(msg.wParam);
-	}
+#define ASSERT_GRAPHICS PLAY_ASSERT_MSG( Play::Graphics::m_bCreated, "Graphics Manager not initialised. Call Graphics::CreateManager() before using the Play::Graphics library functions.")
 
-	LRESULT CALLBACK WndProc( HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam )
+namespace Play::Graphics
+{
+	// Internal (private) declarations
+	// 
+	// Flag to record whether the manager has been created
+	bool m_bCreated = false;
+	// Count of the total number of sprites loaded
+	int m_nTotalSprites{ 0 };
+	// Buffer pointers
+	PixelData m_playBuffer;
+	// A buffer for unpacking the debug font into 
+	uint8_t* m_pDebugFontBuffer{ nullptr };
+	// The debug font as sprite sheets of 16x3 characters, so debug text can be blitted a character at a time (made with the buffer above)
+	Sprite m_debugFontGlyphs;
+	// Every debug font character grown by a pixel on the diagonals, with a one pixel border around each character to fit it in
+	Sprite m_debugFontOutlines;
+
+	// A vector of all the loaded sprites
+	std::vector< Sprite > m_vSpriteData;
+	// A vector of all the loaded backgrounds
+	std::vector< PixelData > m_vBackgroundData;
+
+	// Multiplies the sprite image by its own alpha transparency values to save repeating this calculation on every draw
+	// > A colour multiplication can also be applied at this stage, which affects all subseqent drawing operations on the sprite
+	void PreMultiplyAlpha( Pixel* source, Pixel* dest, int width, int height, int maxSkipWidth, float alphaMultiply, Pixel colourMultiply );
+	// Works out how much each pixel of the sprite image multiplies the destination colours by, so multiply blending doesn't need to do it on every draw
+	// > Fully transparent pixels are stored in the same way as the pre-multiplied alpha buffer, so they can be skipped
+	void PreMultiplyFactors( Pixel* source, Pixel* dest, int width, int height, int maxSkipWidth );
+	// Allocates a buffer for the debug font and copies the font pixel data to it
+	void DecompressDubugFont( void );
+	// Returns the pixel width of a string using the debug font
+	int GetDebugStringWidth( const std::string& s );
+	// Creates one of the debug font sprite sheets from the unpacked debug font
+	void CreateDebugFontSheet( Sprite& sheet, bool outlined );
+	// Gets the index of a character in the debug font sprite sheets, or -1 if the font doesn't have it
+	int GetDebugGlyph( char c );
+	// Draws a string using one of the debug font sprite sheets, tinted with the given colour
+	void DrawDebugGlyphs( Sprite& sheet, int border, Point2f pos, const std::string& s, Pixel pix );
+	// Draws the offset points from the origin in all octants
+	void DrawCircleOctants( int posX, int posY, int offX, int offY, Pixel pix );
+	// Ends the current timing segment and calculates the duration
+	LARGE_INTEGER EndTimingSegment();
+
+	struct TimingSegment
 	{
-		ASSERT_WINDOW;
+		Pixel pix;
+		long long begin{ 0 };
+		long long end{ 0 };
+		float millisecs{ 0 };
+	};
 
-		switch (message)
-		{
-		case WM_PAINT:
-			PAINTSTRUCT ps;
-			BeginPaint(hWnd, &ps);
-			EndPaint(hWnd, &ps);
-			break;
+	// Vectors of timing data segments
+	std::vector<TimingSegment> m_vTimings;
+	std::vector<TimingSegment> m_vPrevTimings;
 
-		case WM_DESTROY:
-			PostQuitMessage(0);
-			break;
-		case WM_LBUTTONDOWN:
-			if (m_pMouseData)
-				m_pMouseData->left = true;
-			break;
-		case WM_LBUTTONUP:
-			if (m_pMouseData)
-				m_pMouseData->left = false;
-			break;
-		case WM_RBUTTONDOWN:
-			if (m_pMouseData)
-				m_pMouseData->right = true;
-			break;
-		case WM_RBUTTONUP:
-			if (m_pMouseData)
-				m_pMouseData->right = false;
-			break;
-		case WM_MOUSEMOVE:
-			if (m_pMouseData)
-			{
-				m_pMouseData->pos.x = static_cast<float>(GET_X_LPARAM(lParam) / m_scale);
-				m_pMouseData->pos.y = m_pPlayBuffer->height - static_cast<float>(GET_Y_LPARAM(lParam) / m_scale);
-			}
-			break;
-		case WM_MOUSELEAVE:
-			m_pMouseData->pos.x = -1;
-			m_pMouseData->pos.y = -1;
-			break;
-		default:
-			return DefWindowProc(hWnd, message, wParam, lParam);
-		}
-		return 0;
-	}
+	// The blend mode state
+	BlendMode blendMode{ BLEND_NORMAL };
 
-	double Present( void )
+	// A drawing operation recorded in deferred mode
+	struct DrawCommand
 	{
-		ASSERT_WINDOW;
+		Render::ClipRect clip; // The clip rectangle when the operation was recorded
+		BlendMode blendMode{ BLEND_NORMAL };
+		std::function< void() > draw;
+	};
 
-		LARGE_INTEGER frequency;
-		LARGE_INTEGER before;
-		LARGE_INTEGER after;
-		QueryPerformanceCounter(&before);
-		QueryPerformanceFrequency(&frequency);
+	// The size of the square screen tiles used by deferred drawing
+	constexpr int DRAW_TILE_SIZE = 64;
 
-		// Set up a BitmapInfo structure to represent the pixel format of the display buffer
-		BITMAPINFOHEADER bitmap_info_header
-		{
-				sizeof(BITMAPINFOHEADER),								// size of its own data,
-				m_pPlayBuffer->width, m_pPlayBuffer->height,		// width and height
-				1, 32, BI_RGB,				// planes must always be set to 1 (docs), 32-bit pixel data, uncompressed 
-				0, 0, 0, 0, 0				// rest can be set to 0 as this is uncompressed and has no palette
-		};
+	// Deferred drawing state
+	bool m_bDeferred = false;
+	thread_local bool m_bReplaying = false; // Set while a thread is drawing recorded operations
+	thread_local const DrawCommand* m_pReplayCommand = nullptr; // The recorded operation a drawing thread is drawing
+	std::vector< DrawCommand > m_vDrawCommands;
+	std::vector< std::vector< uint32_t > > m_vTileCommands; // The indices of the commands affecting each tile, in the order they were recorded
+	int m_nTilesWide{ 0 };
+	std::atomic< int > m_nextTile{ 0 };
 
-		BITMAPINFO bitmap_info{ bitmap_info_header, { 0,0,0,0 } };	// No palette data required for this bitmap
+	// The pool of drawing threads (the thread which flushes the drawing also helps)
+	std::vector< std::thread > m_vDrawThreads;
+	std::mutex m_drawMutex;
+	std::condition_variable m_drawStart;
+	std::condition_variable m_drawFinished;
+	unsigned int m_drawGeneration{ 0 };
+	int m_nDrawThreadsBusy{ 0 };
+	bool m_bStopDrawThreads = false;
 
-		HDC hDC = GetDC(m_hWindow);
+	// Gets the blend mode to draw with: the one the operation was recorded with while the drawing threads replay it, otherwise the current one
+	// > The drawing threads never read or change blendMode, as the thread which records the drawing can change it at any time
+	BlendMode GetDrawingBlendMode()
+	{
+		return m_pReplayCommand ? m_pReplayCommand->blendMode : blendMode;
+	}
 
-		// Copy the display buffer to the window: GDI only implements up scaling using simple pixel duplication, but that's what we want
-		// Note that GDI+ DrawImage would do the same thing, but it's much slower! 
-		StretchDIBits(hDC, 0, 0, m_pPlayBuffer->width * m_scale, m_pPlayBuffer->height * m_scale, 0, m_pPlayBuffer->height + 1, m_pPlayBuffer->width, -m_pPlayBuffer->height, m_pPlayBuffer->pPixels, &bitmap_info, DIB_RGB_COLORS, SRCCOPY); // We flip h because Bitmaps store pixel data upside down.
+	// Returns true if drawing operations should be recorded instead of drawn
+	bool IsRecording()
+	{
+		return m_bDeferred && !m_bReplaying && Render::m_pRenderTarget == &m_playBuffer;
+	}
 
-		ReleaseDC(m_hWindow, hDC);
+	// A sprite drawing operation with its position already worked out
+	struct SpriteCommand
+	{
+		int spriteId{ -1 };
+		int frameIndex{ 0 }; // Already wrapped to the number of frames
+		bool transformed{ false };
+		int destX{ 0 }, destY{ 0 }; // The top left corner of untransformed sprites
+		int flip{ Render::FLIP_NONE }; // How untransformed sprites are mirrored
+		Matrix2D transform; // The transform and origin of transformed sprites
+		Vector2f origin{ 0.0f, 0.0f };
+		BlendColour globalMultiply{ 1.0f, 1.0f, 1.0f, 1.0f };
+		Render::SamplingMode samplingMode{ Render::SAMPLE_NEAREST };
+	};
 
-		QueryPerformanceCounter(&after);
+	// A drawing operation waiting in the queue to be sorted
+	struct QueuedDrawing
+	{
+		int layer{ 0 };
+		BlendMode blendMode{ BLEND_NORMAL };
+		Render::ClipRect clip; // The clip rectangle when the operation was queued
+		SpriteCommand sprite; // Sprites are stored directly (with a spriteId of -1 for anything else)
+		Render::ClipRect bounds; // Everything else is stored as a function and the area it affects
+		std::function< void() > draw;
+	};
 
-		double elapsedTime = (after.QuadPart - before.QuadPart) * 1000.0 / frequency.QuadPart;
+	// Draw order state
+	DrawOrder m_drawOrder{ ORDER_SUBMITTED };
+	int m_drawingLayer{ 0 };
+	bool m_bFlushingQueue = false;
+	std::vector< QueuedDrawing > m_vDrawingQueue;
+	std::vector< uint32_t > m_vQueueOrder;
 
-		return elapsedTime;
+	// Returns true if drawing operations should be queued for sorting instead of drawn
+	bool IsQueueing()
+	{
+		return m_drawOrder != ORDER_SUBMITTED && !m_bFlushingQueue && !m_bReplaying && Render::m_pRenderTarget == &m_playBuffer;
 	}
 
-	void RegisterMouse( MouseData* pMouseData ) 
-	{ 
-		ASSERT_WINDOW;
-		m_pMouseData = pMouseData; 
+	// Adds a drawing operation to the queue on the current layer
+	void QueueDrawing( const SpriteCommand& sprite, Render::ClipRect bounds, std::function< void() >&& draw )
+	{
+		QueuedDrawing& queued = m_vDrawingQueue.emplace_back();
+		queued.layer = m_drawingLayer;
+		queued.blendMode = blendMode;
+		queued.clip = Render::GetClipRect();
+		queued.sprite = sprite;
+		queued.bounds = bounds;
+		queued.draw = std::move( draw );
 	}
 
-	int GetWidth() 
-	{ 
-		ASSERT_WINDOW;
-		return m_pPlayBuffer->width; 
+	// Sorts the queued drawing and passes it on to be drawn (or recorded for the drawing threads)
+	void FlushDrawingQueue();
+
+	// Flushes the queue and then draws without queueing, so nothing queued before or after can be sorted to the other side of the drawing
+	// > Used for clears and backgrounds, which would otherwise erase drawing queued on lower layers in the same frame
+	template< typename TDraw > void DrawQueueBarrier( TDraw&& draw )
+	{
+		FlushDrawingQueue();
+		m_bFlushingQueue = true;
+		draw();
+		m_bFlushingQueue = false;
 	}
+	// Draws (or records) a sprite whose position has already been worked out
+	void DrawSpriteCommand( const SpriteCommand& command );
 
-	int GetHeight() 
-	{ 
-		ASSERT_WINDOW;
-		return m_pPlayBuffer->height;
+	// Draws a transformed sprite frame, using the much faster ScalePixels when the transform doesn't rotate
+	template< typename TBlend > void DrawTransformedPixels( const PixelData& pixels, int frameOffset, const Sprite& sprite, const Vector2f& origin, const Matrix2D& trans, BlendColour globalMultiply, Render::SamplingMode samplingMode )
+	{
+		if( Render::IsAxisAligned( trans ) && samplingMode != Render::SAMPLE_BILINEAR )
+			Render::ScalePixels<TBlend>( pixels, frameOffset, sprite.width, sprite.height, origin, trans, globalMultiply, samplingMode );
+		else
+			Render::TransformPixels<TBlend>( pixels, frameOffset, sprite.width, sprite.height, origin, trans, globalMultiply, samplingMode );
 	}
 
-	int GetScale() 
-	{ 
-		ASSERT_WINDOW;
-		return m_scale; 
+	// Pre-multiplies the palette of an indexed sprite with its own alpha and the sprite colour
+	void PreMultiplyPalette( Sprite& s )
+	{
+		s.preMultPalette.resize( s.palette.size() );
+		if( !s.palette.empty() )
+			PreMultiplyAlpha( s.palette.data(), s.preMultPalette.data(), static_cast<int>( s.palette.size() ), 1, 1, 1.0f, s.colour );
 	}
 
-}
+	// Creates the 32-bit canvas of an indexed sprite for GetSpritePixelData, unless it already has one
+	// > It is kept, as the caller can hold on to it (and change it before calling UpdateSprite)
+	void ExpandIndexedSprite( Sprite& s )
+	{
+		if( s.indices.empty() || s.canvasBuffer.pPixels )
+			return;
 
-//********************************************************************************************************************************
-// Loading functions
-//********************************************************************************************************************************
+		size_t pixelCount = static_cast<size_t>( s.canvasBuffer.width ) * s.canvasBuffer.height;
+		s.canvasBuffer.pPixels = new Pixel[pixelCount];
+		for( size_t i = 0; i < pixelCount; i++ )
+			s.canvasBuffer.pPixels[i] = s.palette[s.indices[i]];
+	}
 
-int ReadPNGImage(std::string& fileAndPath, int& width, int& height)
-{
-	// Convert filename from single to wide string for GDI+ compatibility
-	size_t newsize = strlen(fileAndPath.c_str()) + 1;
-	wchar_t* wcstring = new wchar_t[newsize];
-	size_t convertedChars = 0;
-	mbstowcs_s(&convertedChars, wcstring, newsize, fileAndPath.c_str(), _TRUNCATE);
+	// 32-bit pixels looked up from part of an indexed sprite, for drawing which can't use the indices directly
+	struct ExpandedPixels
+	{
+		PixelData pixels;
 
-	HBITMAP hBitmap = NULL;
+		ExpandedPixels() = default;
+		ExpandedPixels( const ExpandedPixels& ) = delete;
+		ExpandedPixels& operator=( const ExpandedPixels& ) = delete;
+		~ExpandedPixels() { delete[] pixels.pPixels; }
+	};
 
-	// Use GDI+ to load file into Bitmap structure
-	Gdiplus::Bitmap* bitmap = Gdiplus::Bitmap::FromFile(wcstring, false);
-	int status = bitmap->GetLastStatus();
+	// The form of the pixels made by ExpandIndexedPixels, matching the sprite's canvas buffer, pre-multiplied data or multiply factors
+	enum class Expansion { CANVAS, PRE_MULTIPLIED, MULTIPLY_FACTORS };
 
-	if (status != Gdiplus::Ok)
-		return -status;
+	// Looks up a width x height area of an indexed sprite (usually a single frame) starting at offset in its canvas
+	// > Made when the drawing is submitted and shared with the drawing threads, so it is freed as soon as the drawing is done
+	// > and an indexed sprite never keeps a 32-bit copy of itself. The run lengths are the same as they would be for the whole canvas
+	std::shared_ptr< const ExpandedPixels > ExpandIndexedPixels( const Sprite& s, int offset, int width, int height, Expansion expansion )
+	{
+		auto expanded = std::make_shared< ExpandedPixels >();
+		PixelData& pixels = expanded->pixels;
+		pixels.width = width;
+		pixels.height = height;
+		pixels.pPixels = new Pixel[static_cast<size_t>( width ) * height];
+		for( int y = 0; y < height; y++ )
+			Render::LookUpPalette( s.indices.data() + offset + ( y * s.canvasBuffer.width ), s.palette.data(), pixels.pPixels + ( y * width ), width );
 
-	bitmap->GetHBITMAP(Gdiplus::Color(255, 255, 255), &hBitmap);
+		if( expansion == Expansion::CANVAS )
+			return expanded;
 
-	width = bitmap->GetWidth();
-	height = bitmap->GetHeight();
+		Pixel* pConverted = new Pixel[static_cast<size_t>( width ) * height];
+		if( expansion == Expansion::PRE_MULTIPLIED )
+			PreMultiplyAlpha( pixels.pPixels, pConverted, width, height, s.width, 1.0f, s.colour );
+		else
+			PreMultiplyFactors( pixels.pPixels, pConverted, width, height, s.width );
+		delete[] pixels.pPixels;
+		pixels.pPixels = pConverted;
+		return expanded;
+	}
 
-	delete bitmap;
-	delete[] wcstring;
+	// Gets the multiply factor buffer for a sprite, creating it the first time it is needed
+	// > Indexed sprites use ExpandIndexedPixels instead, so they don't keep one
+	const PixelData& GetMultiplyFactors( Sprite& s )
+	{
+		if( !s.multiplyFactors.pPixels )
+		{
+			s.multiplyFactors.pPixels = new Pixel[static_cast<size_t>( s.canvasBuffer.width ) * s.canvasBuffer.height];
+			s.multiplyFactors.width = s.canvasBuffer.width;
+			s.multiplyFactors.height = s.canvasBuffer.height;
+			PreMultiplyFactors( s.canvasBuffer.pPixels, s.multiplyFactors.pPixels, s.canvasBuffer.width, s.canvasBuffer.height, s.width );
+		}
+		return s.multiplyFactors;
+	}
 
-	return 1;
-}
+	// Frees the multiply factor buffer for a sprite, so it gets created again from new pixel data
+	void FreeMultiplyFactors( Sprite& s )
+	{
+		delete[] s.multiplyFactors.pPixels;
+		s.multiplyFactors.pPixels = nullptr;
+	}
 
-int LoadPNGImage(std::string& fileAndPath, PixelData& destImage)
-{
-	// Convert filename from single to wide string for GDI+ compatibility
-	size_t newsize = strlen(fileAndPath.c_str()) + 1;
-	wchar_t* wcstring = new wchar_t[newsize];
-	size_t convertedChars = 0;
-	mbstowcs_s(&convertedChars, wcstring, newsize, fileAndPath.c_str(), _TRUNCATE);
+	// A sprite frame rendered by DrawRotated, kept so it can be blitted the next time it is drawn the same way
+	struct CachedFrame
+	{
+		PixelData pixels; // Pre-multiplied, with the run lengths of transparent pixels
+		Render::SpanTable spans;
+		int offsetX{ 0 }, offsetY{ 0 }; // The top left of the pixels relative to the sprite origin (in pixels from the top left)
+		int originX{ 0 }, originY{ 0 }; // The sprite origin it was rendered with, as moving the origin changes the result
+		size_t bytes{ 0 };
 
-	HBITMAP hBitmap = NULL;
+		CachedFrame() = default;
+		CachedFrame( const CachedFrame& ) = delete;
+		CachedFrame& operator=( const CachedFrame& ) = delete;
+		~CachedFrame() { delete[] pixels.pPixels; }
+	};
 
-	// Use GDI+ to load file into Bitmap structure
-	Gdiplus::Bitmap* bitmap = Gdiplus::Bitmap::FromFile(wcstring, false);
-	int status = bitmap->GetLastStatus();
+	// Everything a cached frame depends on, with the angle and scale rounded to whole steps
+	struct CachedFrameKey
+	{
+		int spriteId{ -1 };
+		int frameIndex{ 0 };
+		int angleStep{ 0 };
+		int scaleStep{ 0 };
+		int samplingMode{ 0 };
+		float alpha{ 1.0f }, red{ 1.0f }, green{ 1.0f }, blue{ 1.0f };
 
-	if (status != Gdiplus::Ok)
-		return -status;
+		bool operator<( const CachedFrameKey& rhs ) const
+		{
+			return std::tie( spriteId, frameIndex, angleStep, scaleStep, samplingMode, alpha, red, green, blue )
+				< std::tie( rhs.spriteId, rhs.frameIndex, rhs.angleStep, rhs.scaleStep, rhs.samplingMode, rhs.alpha, rhs.red, rhs.green, rhs.blue );
+		}
+	};
 
-	bitmap->GetHBITMAP(Gdiplus::Color(255, 255, 255), &hBitmap);
+	// The rotation cache state
+	// > Drawing which has been recorded or queued keeps its own reference to a frame, so frames can be thrown away at any time
+	struct RotationCache
+	{
+		size_t budget{ 0 }; // Turned off
+		int angleSteps{ 256 };
+		float scaleStep{ 1.0f / 32.0f };
+		std::list< CachedFrameKey > recent; // The most recently used frame is at the front
+		std::map< CachedFrameKey, std::pair< std::shared_ptr< CachedFrame >, std::list< CachedFrameKey >::iterator > > frames;
+		RotationCacheStats stats;
+	};
+	RotationCache m_rotationCache;
 
-	// Create BitmapData structure to pull the data into
-	Gdiplus::BitmapData* bitmapData = new Gdiplus::BitmapData;
+	// Throws away a cached frame
+	void EvictCachedFrame( std::map< CachedFrameKey, std::pair< std::shared_ptr< CachedFrame >, std::list< CachedFrameKey >::iterator > >::iterator it )
+	{
+		m_rotationCache.stats.bytesUsed -= it->second.first->bytes;
+		m_rotationCache.recent.erase( it->second.second );
+		m_rotationCache.frames.erase( it );
+		m_rotationCache.stats.frames = m_rotationCache.frames.size();
+	}
 
-	destImage.width = bitmap->GetWidth();
-	destImage.height = bitmap->GetHeight();
+	// Throws away the cached frames of a sprite whose pixels have changed
+	void ForgetCachedFrames( int spriteId )
+	{
+		for( auto it = m_rotationCache.frames.begin(); it != m_rotationCache.frames.end(); )
+		{
+			auto next = std::next( it );
+			if( it->first.spriteId == spriteId )
+				EvictCachedFrame( it );
+			it = next;
+		}
+	}
 
-	// Lock the bitmap in advance of reading its data
-	Gdiplus::Rect rect(0, 0, destImage.width, destImage.height);
-	bitmap->LockBits(&rect, Gdiplus::ImageLockModeRead, PixelFormat32bppARGB, bitmapData);
+	// Draws a rotated sprite by blitting a cached frame, rendering it first if it isn't in the cache
+	// > Returns false if the drawing can't be cached, so it needs to be drawn the normal way
+	bool DrawRotatedCached( int spriteId, Point2f pos, int frameIndex, float angle, float scale, BlendColour globalMultiply, Render::SamplingMode samplingMode );
 
-	// Get a pointer to the actual bit data
-	Pixel* sourcePixels = static_cast<Pixel*>(bitmapData->Scan0);
+	// The character widths of a sprite-based font, read once from the bottom row of its canvas (where PlayFontTool hides them)
+	struct Font
+	{
+		std::array< uint8_t, 256 > advance{}; // Indexed by the character as an unsigned char (0 for characters the font doesn't have)
+	};
+	std::map< int, Font > m_fonts;
 
-	destImage.pPixels = new Pixel[destImage.width * destImage.height];
-	memset(destImage.pPixels, 0, sizeof(Pixel) * destImage.width * destImage.height);
+	// Gets the character widths of a font, reading them the first time the font is used
+	const Font& GetFont( int fontId );
 
-	Pixel* destPixels = destImage.pPixels;
+	// A character of a laid out string, and where to find its frame in the font sprite
+	struct TextGlyph
+	{
+		int x{ 0 }; // Relative to the start of the string
+		int frameOffset{ 0 };
+		int spanRow{ 0 };
+	};
 
-	// Copy the data across
-	for (int b = 0; b < destImage.width * destImage.height; b++)
-		*destPixels++ = *sourcePixels++;
+	// A string laid out with a font
+	// > Drawing which has been recorded or queued keeps its own reference to a run, so runs can be thrown away at any time
+	struct TextRun
+	{
+		std::vector< TextGlyph > glyphs; // Only the characters the font has
+		int width{ 0 };
+	};
 
-	//Unlock the bitmap
-	bitmap->UnlockBits(bitmapData);
+	// Orders text runs by font and then text, so they can be found with a string_view without making a std::string first
+	struct TextRunOrder
+	{
+		using is_transparent = void;
 
-	delete bitmap;
-	delete bitmapData;
-	delete[] wcstring;
+		template< typename TKeyA, typename TKeyB > bool operator()( const TKeyA& lhs, const TKeyB& rhs ) const
+		{
+			if( lhs.first != rhs.first )
+				return lhs.first < rhs.first;
+			return std::string_view( lhs.second ) < std::string_view( rhs.second );
+		}
+	};
 
-	return 1;
-}
+	// The text run cache state
+	struct TextRunCache
+	{
+		int maxRuns{ 256 };
+		std::list< std::pair< int, std::string > > recent; // The most recently drawn string is at the front
+		std::map< std::pair< int, std::string >, std::pair< std::shared_ptr< const TextRun >, std::list< std::pair< int, std::string > >::iterator >, TextRunOrder > runs;
+	};
+	TextRunCache m_textRunCache;
 
-int GetEncoderClsid( const WCHAR* format, CLSID* pClsid )
-{
-	UINT num = 0;
-	UINT size = 0;
+	// Gets a string laid out with a font, from the text run cache if it has been drawn recently
+	std::shared_ptr< const TextRun > GetTextRun( int fontId, std::string_view text );
+	// Throws away the character widths and laid out strings of a font whose sprite has changed
+	void ForgetFontLayout( int fontId );
 
-	Gdiplus::GetImageEncodersSize( &num, &size );
-	if( size == 0 )
-		return -1;
+	constexpr size_t RENDER_TARGET_ALIGNMENT = 64; // A cache line (and a whole number of vector registers)
+	constexpr size_t RENDER_TARGET_MIN_CAPACITY = 4096; // In pixels, so small targets share one bucket
 
-	Gdiplus::ImageCodecInfo* imageCodecInfo = (Gdiplus::ImageCodecInfo*)(malloc( size ));
-	if( imageCodecInfo == NULL )
-		return -1;
+	// An offscreen render target in the pool, whose pixels are allocated on a cache line boundary
+	struct PooledTarget
+	{
+		PixelData pixels;
+		size_t capacity{ 0 }; // The number of pixels allocated, which is always a power of two
+		bool inUse{ false };
 
-	Gdiplus::GetImageEncoders( num, size, imageCodecInfo );
+		PooledTarget() = default;
+		PooledTarget( const PooledTarget& ) = delete;
+		PooledTarget& operator=( const PooledTarget& ) = delete;
+		~PooledTarget() { ::operator delete[]( pixels.pPixels, std::align_val_t( RENDER_TARGET_ALIGNMENT ) ); }
+	};
+	std::vector< std::unique_ptr< PooledTarget > > m_vTargetPool;
 
-	for( UINT j = 0; j < num; ++j )
+	constexpr size_t SPRITE_ATLAS_ALIGNMENT = 64; // Every sprite starts on a cache line boundary
+
+	// A page of pre-multiplied sprite pixels (see PackSpriteAtlas)
+	struct AtlasPage
 	{
-		if( wcscmp( imageCodecInfo[ j ].MimeType, format ) == 0 )
+		Pixel* pPixels{ nullptr };
+		size_t capacity{ 0 }; // In pixels
+		size_t used{ 0 };
+
+		AtlasPage() = default;
+		AtlasPage( const AtlasPage& ) = delete;
+		AtlasPage& operator=( const AtlasPage& ) = delete;
+		~AtlasPage() { ::operator delete[]( pPixels, std::align_val_t( SPRITE_ATLAS_ALIGNMENT ) ); }
+	};
+	std::vector< std::unique_ptr< AtlasPage > > m_vAtlasPages;
+
+	// What to go back to when a render target is popped
+	struct PushedTarget
+	{
+		PixelData* pPrevious{ nullptr };
+		Render::ClipRect clip;
+	};
+	std::vector< PushedTarget > m_vTargetStack;
+
+	// The size of the square screen tiles used to track dirty rectangles
+	constexpr int DIRTY_TILE_SIZE = 32;
+
+	// The reasons a dirty tile needs attention
+	enum DirtyFlags : uint8_t
+	{
+		DIRTY_DRAWN = 1, // Drawn into since the display buffer was last cleared
+		DIRTY_CHANGED = 2, // Written to since the display buffer was last presented
+	};
+
+	// What the display buffer was last cleared to
+	enum class ClearState
+	{
+		NONE,
+		COLOUR,
+		BACKGROUND,
+	};
+
+	// Dirty rectangle state
+	bool m_bDirtyTracking = false;
+	std::vector< uint8_t > m_vDirtyTiles;
+	int m_nDirtyTilesWide{ 0 };
+	ClearState m_clearState{ ClearState::NONE };
+	Pixel m_clearColour{ 0 };
+	int m_clearBackground{ -1 };
+	std::vector< Pixel > m_vPresentedPixels; // A copy of the display buffer as it was last presented
+	bool m_bPresentedValid = false;
+	std::vector< Render::ClipRect > m_vDirtyRuns;
+
+	// Returns true if drawing operations should mark the tiles they affect as dirty
+	bool IsTracking()
+	{
+		return m_bDirtyTracking && !m_bReplaying && Render::m_pRenderTarget == &m_playBuffer;
+	}
+
+	// Marks the dirty tiles overlapping the given area of the display buffer (within the current clip rectangle)
+	void MarkDirty( Render::ClipRect bounds )
+	{
+		Render::ClipRect clip = Render::GetClipRect();
+		bounds.left = std::max( { bounds.left, clip.left, 0 } );
+		bounds.top = std::max( { bounds.top, clip.top, 0 } );
+		bounds.right = std::min( { bounds.right, clip.right, m_playBuffer.width } );
+		bounds.bottom = std::min( { bounds.bottom, clip.bottom, m_playBuffer.height } );
+		if( bounds.left >= bounds.right || bounds.top >= bounds.bottom )
+			return;
+
+		for( int tileY = bounds.top / DIRTY_TILE_SIZE; tileY <= ( bounds.bottom - 1 ) / DIRTY_TILE_SIZE; tileY++ )
 		{
-			*pClsid = imageCodecInfo[ j ].Clsid;
-			free( imageCodecInfo );
-			return j;
+			uint8_t* pTile = &m_vDirtyTiles[( tileY * m_nDirtyTilesWide ) + ( bounds.left / DIRTY_TILE_SIZE )];
+			for( int tileX = bounds.left / DIRTY_TILE_SIZE; tileX <= ( bounds.right - 1 ) / DIRTY_TILE_SIZE; tileX++ )
+				*pTile++ |= DIRTY_DRAWN | DIRTY_CHANGED;
 		}
 	}
 
-	free( imageCodecInfo );
-	return -1;
-}
+	// Returns true if clearing the whole display buffer can be done by only restoring the parts which have been drawn into
+	bool CanClearDrawnTiles()
+	{
+		Render::ClipRect clip = Render::GetClipRect();
+		return IsTracking() && !IsQueueing() && clip.left <= 0 && clip.top <= 0 && clip.right >= m_playBuffer.width && clip.bottom >= m_playBuffer.height;
+	}
 
-int SavePNGImage( std::string& fileAndPath, const PixelData& sourceImage )
-{
-	// Convert filename from single to wide string for GDI+ compatibility
-	size_t newsize = strlen( fileAndPath.c_str() ) + 1;
-	wchar_t* wcstring = new wchar_t[ newsize ];
-	size_t convertedChars = 0;
-	mbstowcs_s( &convertedChars, wcstring, newsize, fileAndPath.c_str(), _TRUNCATE );
+	// Keeps track of what the display buffer has been cleared to after clearing all of it
+	void SetClearState( ClearState state, Pixel colour, int backgroundId )
+	{
+		m_clearState = state;
+		m_clearColour = colour;
+		m_clearBackground = backgroundId;
+		for( uint8_t& tile : m_vDirtyTiles )
+			tile &= ~DIRTY_DRAWN;
+	}
 
-	Gdiplus::Bitmap* bitmap = new Gdiplus::Bitmap( sourceImage.width, sourceImage.height, PixelFormat32bppARGB );
-	Gdiplus::Rect rect( 0, 0, sourceImage.width, sourceImage.height );
-	Gdiplus::BitmapData bitmapData;
+	// Gets the rectangles covering the dirty tiles with the given flag, joining neighbouring tiles on the same row together
+	void GetDirtyRuns( DirtyFlags flag, std::vector< Render::ClipRect >& rects );
+	// Restores the parts of the display buffer which have been drawn into since it was last cleared
+	template< typename TDraw > void RestoreDrawnTiles( TDraw&& draw );
 
-	// Lock the bitmap in advance of writing its data
-	bitmap->LockBits( &rect, Gdiplus::ImageLockModeWrite, PixelFormat32bppARGB, &bitmapData );
+	// Records a drawing operation which affects the given area of the display buffer, or draws it straight away if drawing isn't deferred
+	template< typename TDraw > void SubmitDrawing( Render::ClipRect bounds, TDraw&& draw )
+	{
+		if( IsQueueing() )
+		{
+			QueueDrawing( SpriteCommand(), bounds, std::forward< TDraw >( draw ) );
+			return;
+		}
 
-	Pixel* sourcePixels = sourceImage.pPixels;
-	Pixel* destPixels = static_cast<Pixel*>(bitmapData.Scan0);
+		if( IsTracking() )
+			MarkDirty( bounds );
 
-	// Copy the data from source image to destination bitmap
-	for( int b = 0; b < sourceImage.width * sourceImage.height; b++ )
-		*destPixels++ = *sourcePixels++;
+		if( !IsRecording() )
+		{
+			draw();
+			return;
+		}
 
-	// Unlock the bitmap
-	bitmap->UnlockBits( &bitmapData );
+		Render::ClipRect clip = Render::GetClipRect();
+		bounds.left = std::max( { bounds.left, clip.left, 0 } );
+		bounds.top = std::max( { bounds.top, clip.top, 0 } );
+		bounds.right = std::min( { bounds.right, clip.right, m_playBuffer.width } );
+		bounds.bottom = std::min( { bounds.bottom, clip.bottom, m_playBuffer.height } );
+		if( bounds.left >= bounds.right || bounds.top >= bounds.bottom )
+			return;
+
+		uint32_t index = static_cast<uint32_t>( m_vDrawCommands.size() );
+		m_vDrawCommands.push_back( { clip, blendMode, std::forward< TDraw >( draw ) } );
+
+		// Every tile the operation overlaps needs to draw it
+		for( int tileY = bounds.top / DRAW_TILE_SIZE; tileY <= ( bounds.bottom - 1 ) / DRAW_TILE_SIZE; tileY++ )
+		{
+			for( int tileX = bounds.left / DRAW_TILE_SIZE; tileX <= ( bounds.right - 1 ) / DRAW_TILE_SIZE; tileX++ )
+				m_vTileCommands[( tileY * m_nTilesWide ) + tileX].push_back( index );
+		}
+	}
+
+	// Calls a drawing function with the blend policy for the current blend mode (as an empty object), and whether colours need pre-multiplying
+	template< typename TDraw > void DrawWithBlendMode( TDraw&& draw )
+	{
+		switch( GetDrawingBlendMode() )
+		{
+			case BLEND_NORMAL:
+				draw( Render::AlphaBlendPolicy(), true );
+				break;
+			case BLEND_ADD:
+				draw( Render::AdditiveBlendPolicy(), true );
+				break;
+			case BLEND_MULTIPLY:
+				draw( Render::MultiplyBlendPolicy(), false );
+				break;
+			case BLEND_PRECISE:
+				draw( Render::PreciseAlphaBlendPolicy(), true );
+				break;
+			case BLEND_SUBTRACT:
+				draw( Render::SubtractBlendPolicy(), true );
+				break;
+			case BLEND_DARKEN:
+				draw( Render::DarkenBlendPolicy(), true );
+				break;
+			case BLEND_LIGHTEN:
+				draw( Render::LightenBlendPolicy(), true );
+				break;
+			default:
+				PLAY_ASSERT_MSG( false, "Unsupported blend mode" )
+				break;
+		}
+	}
+
+	// Draws a line between two pixels in Cartesian co-ordinates using the current blend mode
+	void DrawCartesianLine( int startX, int startY, int endX, int endY, Pixel pix )
+	{
+		int height = Render::m_pRenderTarget->height; // Flip the y-coordinates to be consistant with a Cartesian co-ordinate system
+		DrawWithBlendMode( [=]( auto policy, bool preMultiply )
+		{
+			Render::DrawLine< decltype( policy ) >( startX, height - startY, endX, height - endY, pix, preMultiply );
+		} );
+	}
+
+	// Gets the area of the display buffer (in pixels from the top left) covering two points in Cartesian co-ordinates
+	// > Leaves a couple of pixels spare for rounding
+	Render::ClipRect GetDisplayBounds( Point2f a, Point2f b )
+	{
+		float minX = std::max( std::min( a.x, b.x ), -1e8f );
+		float maxX = std::min( std::max( a.x, b.x ), 1e8f );
+		float minY = std::max( std::min( a.y, b.y ), -1e8f );
+		float maxY = std::min( std::max( a.y, b.y ), 1e8f );
 
-	// Save the bitmap as a PNG file
-	CLSID pngClsid;
-	GetEncoderClsid( L"image/png", &pngClsid );
-	int status = bitmap->Save( wcstring, &pngClsid, NULL );
+		Render::ClipRect bounds;
+		bounds.left = static_cast<int>( std::floor( minX ) ) - 2;
+		bounds.right = static_cast<int>( std::ceil( maxX ) ) + 2;
+		bounds.top = m_playBuffer.height - static_cast<int>( std::ceil( maxY ) ) - 2;
+		bounds.bottom = m_playBuffer.height - static_cast<int>( std::floor( minY ) ) + 2;
+		return bounds;
+	}
 
-	delete bitmap;
-	delete[] wcstring;
+	// Draws the recorded operations for each tile in turn until there are none left
+	// > Only one thread ever draws a tile, so no locking is needed
+	void DrawTiles()
+	{
+		Render::ClipRect oldClip = Render::GetClipRect();
+		m_bReplaying = true;
 
-	if( status != Gdiplus::Ok )
-		return -status;
+		int totalTiles = static_cast<int>( m_vTileCommands.size() );
+		for( int tile = m_nextTile++; tile < totalTiles; tile = m_nextTile++ )
+		{
+			Render::ClipRect tileRect;
+			tileRect.left = ( tile % m_nTilesWide ) * DRAW_TILE_SIZE;
+			tileRect.top = ( tile / m_nTilesWide ) * DRAW_TILE_SIZE;
+			tileRect.right = tileRect.left + DRAW_TILE_SIZE;
+			tileRect.bottom = tileRect.top + DRAW_TILE_SIZE;
 
-	return 1;
-}
+			for( uint32_t index : m_vTileCommands[tile] )
+			{
+				const DrawCommand& command = m_vDrawCommands[index];
+				Render::ClipRect clip;
+				clip.left = std::max( tileRect.left, command.clip.left );
+				clip.top = std::max( tileRect.top, command.clip.top );
+				clip.right = std::min( tileRect.right, command.clip.right );
+				clip.bottom = std::min( tileRect.bottom, command.clip.bottom );
+				Render::SetClipRect( clip );
+				m_pReplayCommand = &command;
+				command.draw();
+			}
+		}
 
-//********************************************************************************************************************************
-// Miscellaneous functions
-//********************************************************************************************************************************
+		m_pReplayCommand = nullptr;
+		m_bReplaying = false;
+		Render::SetClipRect( oldClip );
+	}
 
-void AssertFailMessage( const char* message, const char* file, long line )
-{
-	// file - the file in which the assertion failed ( __FILE__ )
-	// line - the line of code where the assertion failed ( __LINE__ )
-	std::filesystem::path p = file;
-	std::string s = p.filename().string() + " : LINE " + std::to_string(line);
-	s += "\n" + std::string(message);
-	int wide_count = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, NULL, 0);
-	wchar_t* wide = new wchar_t[wide_count];
-	MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, wide, wide_count);
-	MessageBox(NULL, wide, (LPCWSTR)L"Assertion Failure", MB_ICONWARNING);
-	delete[] wide;
-}
+	// The main loop for each thread in the drawing pool
+	void DrawThreadLoop( unsigned int generation )
+	{
+		while( true )
+		{
+			{
+				std::unique_lock< std::mutex > lock( m_drawMutex );
+				m_drawStart.wait( lock, [&generation] { return m_bStopDrawThreads || m_drawGeneration != generation; } );
+				if( m_bStopDrawThreads )
+					return;
+				generation = m_drawGeneration;
+			}
 
-void DebugOutput( const char* s )
-{
-	OutputDebugStringA(s);
-}
+			DrawTiles();
 
-void DebugOutput( std::string s )
-{
-	OutputDebugStringA(s.c_str());
-}
+			std::lock_guard< std::mutex > lock( m_drawMutex );
+			if( --m_nDrawThreadsBusy == 0 )
+				m_drawFinished.notify_one();
+		}
+	}
 
-void TracePrintf( const char* file, int line, const char* fmt, ... )
-{
-	constexpr size_t kMaxBufferSize = 512u;
-	char buffer[kMaxBufferSize];
+	// Shuts down the pool of drawing threads
+	void StopDrawThreads()
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_drawMutex );
+			m_bStopDrawThreads = true;
+		}
+		m_drawStart.notify_all();
 
-	va_list args;
-	va_start(args, fmt);
-	// format should be double click-able in VS 
-	int len = sprintf_s(buffer, kMaxBufferSize, "%s(%d): ", file, line);
-	vsprintf_s(buffer + len, kMaxBufferSize - len, fmt, args);
-	DebugOutput(buffer);
-	va_end(args);
-}
+		for( std::thread& thread : m_vDrawThreads )
+			thread.join();
 
-//********************************************************************************************************************************
-// File:		PlayRender.cpp
-// Description:	A software pixel renderer for drawing 2D primitives into a PixelData buffer
-// Platform:	Independent
-//********************************************************************************************************************************
+		m_vDrawThreads.clear();
+		m_bStopDrawThreads = false;
+	}
 
+	void SetDeferredDrawing( bool enable, int numThreads )
+	{
+		ASSERT_GRAPHICS;
+		FlushDrawing();
+		StopDrawThreads();
 
-#define ASSERT_RENDERTARGET	PLAY_ASSERT_MSG( Play::Render::m_pRenderTarget, "Render Target not initialised. Call Render::SetRenderTarget() before using the Play::Render library functions.")
+		m_bDeferred = enable;
+		if( !enable )
+			return;
 
-namespace Play::Render
-{
-	// Internal (private) namespace variables
-	PixelData* m_pRenderTarget{ nullptr };
+		m_nTilesWide = ( m_playBuffer.width + DRAW_TILE_SIZE - 1 ) / DRAW_TILE_SIZE;
+		int tilesHigh = ( m_playBuffer.height + DRAW_TILE_SIZE - 1 ) / DRAW_TILE_SIZE;
+		m_vTileCommands.assign( static_cast<size_t>( m_nTilesWide ) * tilesHigh, {} );
 
-	PixelData* SetRenderTarget( PixelData* pRenderTarget ) 
-	{ 
-		PixelData* old = m_pRenderTarget; 
-		m_pRenderTarget = pRenderTarget; 
-		return old; 
+		if( numThreads <= 0 )
+			numThreads = static_cast<int>( std::thread::hardware_concurrency() );
+
+		// The thread calling FlushDrawing makes up the numbers
+		for( int t = 1; t < numThreads; t++ )
+			m_vDrawThreads.emplace_back( DrawThreadLoop, m_drawGeneration );
 	}
 
-	void DrawLine( int startX, int startY, int endX, int endY, Pixel pix ) 
+	bool IsDrawingDeferred()
 	{
-		ASSERT_RENDERTARGET;
+		return m_bDeferred;
+	}
 
-		//Implementation of Bresenham's Line Drawing Algorithm
-		int dx = abs(endX - startX);
-		int sx = 1;
-		if (endX < startX) { sx = -1; }
+	void SetDrawOrder( DrawOrder order )
+	{
+		ASSERT_GRAPHICS;
+		FlushDrawing();
+		m_drawOrder = order;
+	}
 
-		int dy = -abs(endY - startY);
-		int sy = 1;
-		if (endY < startY) { sy = -1; }
+	void SetDrawingLayer( int layer )
+	{
+		m_drawingLayer = layer;
+	}
 
-		int err = dx + dy;
+	int GetDrawingLayer()
+	{
+		return m_drawingLayer;
+	}
 
-		if (dx == 0 && dy == 0) return;
+	int GetQueuedDrawingCount()
+	{
+		return static_cast<int>( m_vDrawingQueue.size() );
+	}
 
-		int x = startX;
-		int y = startY;
+	void SetDirtyTracking( bool enable )
+	{
+		ASSERT_GRAPHICS;
+		FlushDrawing();
 
-		while (true)
+		m_bDirtyTracking = enable;
+		m_clearState = ClearState::NONE;
+		m_bPresentedValid = false;
+		if( !enable )
 		{
-			Graphics::DrawPixel({ x, y }, pix); // Axis flipping is performed within
+			m_vDirtyTiles.clear();
+			m_vPresentedPixels.clear();
+			return;
+		}
 
-			if (x == endX && y == endY)
-				break;
+		// Nothing is known about the display buffer yet, so everything starts off dirty
+		m_nDirtyTilesWide = ( m_playBuffer.width + DIRTY_TILE_SIZE - 1 ) / DIRTY_TILE_SIZE;
+		int tilesHigh = ( m_playBuffer.height + DIRTY_TILE_SIZE - 1 ) / DIRTY_TILE_SIZE;
+		m_vDirtyTiles.assign( static_cast<size_t>( m_nDirtyTilesWide ) * tilesHigh, DIRTY_DRAWN | DIRTY_CHANGED );
+	}
 
-			int e2 = 2 * err;
-			if (e2 >= dy)
-			{
-				err += dy;
-				x += sx;
-			}
-			if (e2 <= dx)
+	bool IsDirtyTracking()
+	{
+		return m_bDirtyTracking;
+	}
+
+	void GetDirtyRuns( DirtyFlags flag, std::vector< Render::ClipRect >& rects )
+	{
+		rects.clear();
+		int tilesHigh = static_cast<int>( m_vDirtyTiles.size() ) / std::max( m_nDirtyTilesWide, 1 );
+		for( int tileY = 0; tileY < tilesHigh; tileY++ )
+		{
+			const uint8_t* pRow = &m_vDirtyTiles[static_cast<size_t>( tileY ) * m_nDirtyTilesWide];
+			for( int tileX = 0; tileX < m_nDirtyTilesWide; tileX++ )
 			{
-				err += dx;
-				y += sy;
+				if( !( pRow[tileX] & flag ) )
+					continue;
+
+				Render::ClipRect run;
+				run.left = tileX * DIRTY_TILE_SIZE;
+				run.top = tileY * DIRTY_TILE_SIZE;
+				while( tileX + 1 < m_nDirtyTilesWide && ( pRow[tileX + 1] & flag ) )
+					tileX++;
+				run.right = std::min( ( tileX + 1 ) * DIRTY_TILE_SIZE, m_playBuffer.width );
+				run.bottom = std::min( run.top + DIRTY_TILE_SIZE, m_playBuffer.height );
+				rects.push_back( run );
 			}
 		}
 	}
 
-	void ClearRenderTarget( Pixel colour ) 
+	template< typename TDraw > void RestoreDrawnTiles( TDraw&& draw )
 	{
-		ASSERT_RENDERTARGET;
-		static std::vector<Pixel> row = { colour };
-		
-		if (row[0].bits != colour.bits || row.size() != m_pRenderTarget->width)
+		GetDirtyRuns( DIRTY_DRAWN, m_vDirtyRuns );
+
+		// Each run is drawn with the clip rectangle narrowed to it
+		Render::ClipRect oldClip = Render::GetClipRect();
+		for( const Render::ClipRect& run : m_vDirtyRuns )
 		{
-			row.assign(m_pRenderTarget->width, colour);
+			Render::SetClipRect( run );
+			SubmitDrawing( run, draw );
 		}
+		Render::SetClipRect( oldClip );
 
-		Pixel* pBuffEnd = m_pRenderTarget->pPixels + (m_pRenderTarget->width * m_pRenderTarget->height);
-		for (Pixel* pBuff = m_pRenderTarget->pPixels; pBuff < pBuffEnd; pBuff += m_pRenderTarget->width)
-			memcpy(pBuff, row.data(), sizeof(Pixel) * m_pRenderTarget->width);
-		m_pRenderTarget->preMultiplied = false;
+		// Restoring the tiles marks them as changed, but they're no longer drawn into
+		for( uint8_t& tile : m_vDirtyTiles )
+			tile &= ~DIRTY_DRAWN;
 	}
 
-	void BlitBackground( PixelData& backgroundImage ) 
+	void GetChangedRects( std::vector< Render::ClipRect >& rects )
 	{
-		ASSERT_RENDERTARGET;
-		PLAY_ASSERT_MSG(backgroundImage.height == m_pRenderTarget->height && backgroundImage.width == m_pRenderTarget->width, "Background size doesn't match render target!");
-		// Takes about 1ms for 720p screen on i7-8550U
-		memcpy(m_pRenderTarget->pPixels, backgroundImage.pPixels, sizeof(Pixel) * m_pRenderTarget->width * m_pRenderTarget->height);
+		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( m_bDirtyTracking, "Dirty tracking must be enabled to get the changed rectangles" );
+		FlushDrawing();
+
+		// The buffers are compared as bytes, so it doesn't matter what format the pixels are stored in
+		size_t pixelBytes = GetBytesPerPixel( m_playBuffer.format );
+		size_t bufferSize = ( static_cast<size_t>( m_playBuffer.width ) * m_playBuffer.height * pixelBytes ) / sizeof( Pixel );
+		if( !m_bPresentedValid || m_vPresentedPixels.size() != bufferSize )
+		{
+			// Everything has changed the first time
+			m_vPresentedPixels.assign( m_playBuffer.pPixels, m_playBuffer.pPixels + bufferSize );
+			m_bPresentedValid = true;
+			for( uint8_t& tile : m_vDirtyTiles )
+				tile &= ~DIRTY_CHANGED;
+			rects.assign( 1, { 0, 0, m_playBuffer.width, m_playBuffer.height } );
+			return;
+		}
+
+		// Tiles which have been drawn into often end up with the same pixels as before (e.g. when a still sprite is redrawn every frame)
+		// > Comparing them with the last presented copy means only the pixels which really changed get copied to the window
+		int tilesHigh = static_cast<int>( m_vDirtyTiles.size() ) / m_nDirtyTilesWide;
+		for( int tileY = 0; tileY < tilesHigh; tileY++ )
+		{
+			int top = tileY * DIRTY_TILE_SIZE;
+			int bottom = std::min( top + DIRTY_TILE_SIZE, m_playBuffer.height );
+			for( int tileX = 0; tileX < m_nDirtyTilesWide; tileX++ )
+			{
+				uint8_t& tile = m_vDirtyTiles[( tileY * m_nDirtyTilesWide ) + tileX];
+				if( !( tile & DIRTY_CHANGED ) )
+					continue;
+
+				int left = tileX * DIRTY_TILE_SIZE;
+				size_t rowBytes = pixelBytes * ( std::min( left + DIRTY_TILE_SIZE, m_playBuffer.width ) - left );
+				bool changed = false;
+				for( int y = top; y < bottom; y++ )
+				{
+					size_t offset = pixelBytes * ( ( static_cast<size_t>( y ) * m_playBuffer.width ) + left );
+					uint8_t* pBuffer = reinterpret_cast<uint8_t*>( m_playBuffer.pPixels ) + offset;
+					uint8_t* pPresented = reinterpret_cast<uint8_t*>( m_vPresentedPixels.data() ) + offset;
+					if( changed || memcmp( pBuffer, pPresented, rowBytes ) != 0 )
+					{
+						memcpy( pPresented, pBuffer, rowBytes );
+						changed = true;
+					}
+				}
+
+				// The rows before the first difference were already the same
+				if( !changed )
+					tile &= ~DIRTY_CHANGED;
+			}
+		}
+
+		GetDirtyRuns( DIRTY_CHANGED, rects );
+		for( uint8_t& tile : m_vDirtyTiles )
+			tile &= ~DIRTY_CHANGED;
 	}
-}
-//********************************************************************************************************************************
-// File:		PlayGraphics.cpp
-// Description:	Manages 2D graphics operations on a PixelData buffer 
-// Platform:	Independent
-// Notes:		Uses PNG format. The end of the filename indicates the number of frames e.g. "bat_4.png" or "tiles_10x10.png"
-//********************************************************************************************************************************
 
+	void FlushDrawing()
+	{
+		ASSERT_GRAPHICS;
+		if( m_bReplaying || m_bFlushingQueue )
+			return;
 
-#define ASSERT_GRAPHICS PLAY_ASSERT_MSG( Play::Graphics::m_bCreated, "Graphics Manager not initialised. Call Graphics::CreateManager() before using the Play::Graphics library functions.")
+		// The queued drawing is passed on to be drawn (or recorded) first
+		if( !m_vDrawingQueue.empty() )
+		{
+			PixelData* pOldTarget = Render::SetRenderTarget( &m_playBuffer );
+			FlushDrawingQueue();
+			Render::SetRenderTarget( pOldTarget );
+		}
 
-namespace Play::Graphics
-{
-	// Internal (private) declarations
-	// 
-	// Flag to record whether the manager has been created
-	bool m_bCreated = false;
-	// Count of the total number of sprites loaded
-	int m_nTotalSprites{ 0 };
-	// Buffer pointers
-	PixelData m_playBuffer;
-	// A buffer for unpacking the debug font into 
-	uint8_t* m_pDebugFontBuffer{ nullptr };
+		if( m_vDrawCommands.empty() )
+			return;
 
-	// A vector of all the loaded sprites
-	std::vector< Sprite > m_vSpriteData;
-	// A vector of all the loaded backgrounds
-	std::vector< PixelData > m_vBackgroundData;
+		// The recorded drawing always goes into the display buffer
+		PixelData* pOldTarget = Render::SetRenderTarget( &m_playBuffer );
 
-	// Multiplies the sprite image by its own alpha transparency values to save repeating this calculation on every draw
-	// > A colour multiplication can also be applied at this stage, which affects all subseqent drawing operations on the sprite
-	void PreMultiplyAlpha( Pixel* source, Pixel* dest, int width, int height, int maxSkipWidth, float alphaMultiply, Pixel colourMultiply );
-	// Allocates a buffer for the debug font and copies the font pixel data to it
-	void DecompressDubugFont( void );
-	// Returns the pixel width of a string using the debug font
-	int GetDebugStringWidth( const std::string& s );
-	// Draws the offset points from the origin in all octants
-	void DrawCircleOctants( int posX, int posY, int offX, int offY, Pixel pix );
-	// Ends the current timing segment and calculates the duration
-	LARGE_INTEGER EndTimingSegment();
+		m_nextTile = 0;
+		{
+			std::lock_guard< std::mutex > lock( m_drawMutex );
+			m_nDrawThreadsBusy = static_cast<int>( m_vDrawThreads.size() );
+			m_drawGeneration++;
+		}
+		m_drawStart.notify_all();
 
-	struct TimingSegment
-	{
-		Pixel pix;
-		long long begin{ 0 };
-		long long end{ 0 };
-		float millisecs{ 0 };
-	};
+		DrawTiles();
 
-	// Vectors of timing data segments
-	std::vector<TimingSegment> m_vTimings;
-	std::vector<TimingSegment> m_vPrevTimings;
+		{
+			std::unique_lock< std::mutex > lock( m_drawMutex );
+			m_drawFinished.wait( lock, [] { return m_nDrawThreadsBusy == 0; } );
+		}
 
-	// The blend mode state
-	BlendMode blendMode{ BLEND_NORMAL };
+		Render::SetRenderTarget( pOldTarget );
 
-	bool CreateManager( int bufferWidth, int bufferHeight, const char* path )
+		m_vDrawCommands.clear();
+		for( std::vector< uint32_t >& commands : m_vTileCommands )
+			commands.clear();
+	}
+
+	bool CreateManager( int bufferWidth, int bufferHeight, const char* path, PixelFormat format )
 	{
 		PLAY_ASSERT_MSG( !m_bCreated, "Graphics Manager already initialised! Cannot call Graphics::CreateManager() more than once.");
+		PLAY_ASSERT_MSG( format == PIXEL_ARGB8888 || bufferWidth % 2 == 0, "A 16-bit display buffer needs an even width, so each row is a whole number of Pixels" );
 
 		m_bCreated = true;
 
 		// A working buffer for our display. Each pixel is stored as an unsigned 32-bit integer: alpha<<24 | red<<16 | green<<8 | blue
+		// > or, in a 16-bit buffer, as an unsigned 16-bit integer: red<<11 | green<<5 | blue
+		size_t bufferBytes = static_cast<size_t>( bufferWidth ) * bufferHeight * GetBytesPerPixel( format );
 		m_playBuffer.width = bufferWidth;
 		m_playBuffer.height = bufferHeight;
-		m_playBuffer.pPixels = new Pixel[static_cast<size_t>( bufferWidth ) * bufferHeight];
+		m_playBuffer.pPixels = new Pixel[bufferBytes / sizeof( Pixel )];
 		m_playBuffer.preMultiplied = false;
+		m_playBuffer.format = format;
 		PLAY_ASSERT( m_playBuffer.pPixels );
 
-		memset( m_playBuffer.pPixels, 0, sizeof( uint32_t ) * bufferWidth * bufferHeight );
+		memset( m_playBuffer.pPixels, 0, bufferBytes );
 
 		// Make the display buffer the render target for the blitter
 		Render::SetRenderTarget( &m_playBuffer );
@@ -3205,22 +7414,44 @@ namespace Play::Graphics
 	bool DestroyManager()
 	{
 		ASSERT_GRAPHICS;
+		SetDeferredDrawing( false );
+		ClearRotationCache();
+		ClearTextRunCache();
+		m_fonts.clear();
+
+		// Go back to the original render target before the pooled ones are freed
+		if( !m_vTargetStack.empty() )
+			Render::SetRenderTarget( m_vTargetStack.front().pPrevious );
+		m_vTargetStack.clear();
+		m_vTargetPool.clear();
 
 		for( Sprite& s : m_vSpriteData )
 		{
 			if( s.canvasBuffer.pPixels )
 				delete[] s.canvasBuffer.pPixels;
 
-			if( s.preMultAlpha.pPixels )
+			if( s.preMultAlpha.pPixels && !s.inAtlas )
 				delete[] s.preMultAlpha.pPixels;
+
+			if( s.multiplyFactors.pPixels )
+				delete[] s.multiplyFactors.pPixels;
 		}
 
+		m_vAtlasPages.clear();
+
 		for( PixelData& pBgBuffer : m_vBackgroundData )
 			delete[] pBgBuffer.pPixels;
 
 		if( m_pDebugFontBuffer )
 			delete[] m_pDebugFontBuffer;
 
+		for( Sprite* pSheet : { &m_debugFontGlyphs, &m_debugFontOutlines } )
+		{
+			delete[] pSheet->canvasBuffer.pPixels;
+			delete[] pSheet->preMultAlpha.pPixels;
+			*pSheet = Sprite();
+		}
+
 		delete[] m_playBuffer.pPixels;
 
 		m_bCreated = false;
@@ -3334,6 +7565,7 @@ namespace Play::Graphics
 		s.preMultAlpha.height = s.canvasBuffer.height;
 		memset( s.preMultAlpha.pPixels, 0, sizeof( uint32_t ) * s.canvasBuffer.width * s.canvasBuffer.height );
 		PreMultiplyAlpha( s.canvasBuffer.pPixels, s.preMultAlpha.pPixels, s.canvasBuffer.width, s.canvasBuffer.height, s.width, 1.0f, 0x00FFFFFF );
+		Render::BuildSpanTable( s.preMultAlpha, s.width, s.preMultSpans );
 		s.canvasBuffer.preMultiplied = true;
 
 		// Add the sprite to our vector
@@ -3353,8 +7585,22 @@ namespace Play::Graphics
 		{
 			if( s.name.find( spriteName ) != std::string::npos )
 			{
+				// Anything already recorded needs to be drawn with the old pixel data
+				FlushDrawing();
+
 				// delete the old premultiplied buffer
-				delete s.preMultAlpha.pPixels;
+				if( !s.inAtlas )
+					delete[] s.preMultAlpha.pPixels;
+				s.inAtlas = false;
+				FreeMultiplyFactors( s );
+				ForgetCachedFrames( s.id );
+				ForgetFontLayout( s.id );
+
+				// The new pixel data replaces any indexed copy of the old
+				s.indices.clear();
+				s.palette.clear();
+				s.preMultPalette.clear();
+				s.colour = 0x00FFFFFF;
 
 				s.hCount = hCount;
 				s.vCount = vCount;
@@ -3370,34 +7616,181 @@ namespace Play::Graphics
 				s.preMultAlpha.height = s.canvasBuffer.height;
 				memset( s.preMultAlpha.pPixels, 0, sizeof( uint32_t ) * s.canvasBuffer.width * s.canvasBuffer.height );
 				PreMultiplyAlpha( s.canvasBuffer.pPixels, s.preMultAlpha.pPixels, s.canvasBuffer.width, s.canvasBuffer.height, s.width, 1.0f, 0x00FFFFFF );
+				Render::BuildSpanTable( s.preMultAlpha, s.width, s.preMultSpans );
+				s.canvasBuffer.preMultiplied = true;
+
+				return s.id;
+			}
+		}
+		return -1;
+	}
+
+	int UpdateSprite( const std::string& name )
+	{
+		ASSERT_GRAPHICS;
+
+		// Switch everything to uppercase to avoid need to check case each time
+		std::string spriteName = name;
+		for( char& c : spriteName ) c = static_cast<char>(toupper( c ));
+
+		for( Sprite& s : m_vSpriteData )
+		{
+			if( s.name.find( spriteName ) != std::string::npos )
+			{
+				// Anything already recorded needs to be drawn with the old pixel data
+				FlushDrawing();
+				FreeMultiplyFactors( s );
+				ForgetCachedFrames( s.id );
+				ForgetFontLayout( s.id );
+				s.colour = 0x00FFFFFF;
+
+				if( !s.indices.empty() )
+				{
+					// Once the 32-bit pixels have been made they may have been changed through GetSpritePixelData, so they become the sprite's pixels
+					if( !s.canvasBuffer.pPixels )
+					{
+						PreMultiplyPalette( s );
+						return s.id;
+					}
+					s.indices.clear();
+					s.palette.clear();
+					s.preMultPalette.clear();
+				}
+
+				if( !s.preMultAlpha.pPixels )
+					s.preMultAlpha.pPixels = new Pixel[static_cast<size_t>( s.canvasBuffer.width ) * s.canvasBuffer.height];
+				memset( s.preMultAlpha.pPixels, 0, sizeof( uint32_t ) * s.canvasBuffer.width * s.canvasBuffer.height );
+				PreMultiplyAlpha( s.canvasBuffer.pPixels, s.preMultAlpha.pPixels, s.canvasBuffer.width, s.canvasBuffer.height, s.width, 1.0f, 0x00FFFFFF );
+				Render::BuildSpanTable( s.preMultAlpha, s.width, s.preMultSpans );
 				s.canvasBuffer.preMultiplied = true;
 
-				return s.id;
+				return s.id;
+			}
+		}
+		return -1;
+	}
+
+	int PackSpriteAtlas( size_t pageBytes )
+	{
+		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( pageBytes >= SPRITE_ATLAS_ALIGNMENT, "Sprite atlas pages need to be at least one cache line" );
+
+		// Anything already recorded needs to be drawn from the old pixels
+		FlushDrawing();
+
+		// The biggest sprites go in first (first fit decreasing), which leaves the gaps at the ends of the pages to the smallest
+		std::vector< Sprite* > vSprites;
+		for( Sprite& s : m_vSpriteData )
+		{
+			if( s.preMultAlpha.pPixels )
+				vSprites.push_back( &s );
+		}
+
+		auto getPixelCount = []( const Sprite* pSprite ) { return static_cast<size_t>( pSprite->preMultAlpha.width ) * pSprite->preMultAlpha.height; };
+		std::stable_sort( vSprites.begin(), vSprites.end(), [&]( const Sprite* pA, const Sprite* pB ) { return getPixelCount( pA ) > getPixelCount( pB ); } );
+
+		const size_t alignPixels = SPRITE_ATLAS_ALIGNMENT / sizeof( Pixel );
+		const size_t pagePixels = ( ( pageBytes / sizeof( Pixel ) ) / alignPixels ) * alignPixels;
+		std::vector< std::unique_ptr< AtlasPage > > vPages;
+
+		for( Sprite* pSprite : vSprites )
+		{
+			size_t pixelCount = getPixelCount( pSprite );
+			size_t paddedCount = ( ( pixelCount + alignPixels - 1 ) / alignPixels ) * alignPixels;
+
+			AtlasPage* pPage = nullptr;
+			for( std::unique_ptr< AtlasPage >& page : vPages )
+			{
+				if( page->capacity - page->used >= paddedCount )
+				{
+					pPage = page.get();
+					break;
+				}
+			}
+
+			if( !pPage )
+			{
+				vPages.push_back( std::make_unique< AtlasPage >() );
+				pPage = vPages.back().get();
+				pPage->capacity = std::max( pagePixels, paddedCount );
+				pPage->pPixels = static_cast<Pixel*>( ::operator new[]( pPage->capacity * sizeof( Pixel ), std::align_val_t( SPRITE_ATLAS_ALIGNMENT ) ) );
 			}
+
+			Pixel* pPacked = pPage->pPixels + pPage->used;
+			pPage->used += paddedCount;
+			std::copy( pSprite->preMultAlpha.pPixels, pSprite->preMultAlpha.pPixels + pixelCount, pPacked );
+
+			if( !pSprite->inAtlas )
+				delete[] pSprite->preMultAlpha.pPixels;
+			pSprite->preMultAlpha.pPixels = pPacked;
+			pSprite->inAtlas = true;
 		}
-		return -1;
+
+		// Frees the pages of any earlier packing, which have all been copied out of by now
+		m_vAtlasPages = std::move( vPages );
+		return static_cast<int>( m_vAtlasPages.size() );
 	}
 
-	int UpdateSprite( const std::string& name )
+	bool IndexSprite( int spriteId )
 	{
 		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( spriteId >= 0 && spriteId < m_nTotalSprites, "Trying to index invalid sprite id" );
 
-		// Switch everything to uppercase to avoid need to check case each time
-		std::string spriteName = name;
-		for( char& c : spriteName ) c = static_cast<char>(toupper( c ));
+		Sprite& s = m_vSpriteData[spriteId];
+		if( !s.indices.empty() )
+			return true;
+		if( !s.canvasBuffer.pPixels )
+			return false;
 
-		for( Sprite& s : m_vSpriteData )
+		// Colours are matched exactly, so a sprite with more than 256 (including every level of alpha) is left as it is
+		size_t pixelCount = static_cast<size_t>( s.canvasBuffer.width ) * s.canvasBuffer.height;
+		std::vector< uint8_t > indices( pixelCount );
+		std::vector< Pixel > palette;
+		std::unordered_map< uint32_t, uint8_t > colourIndex;
+
+		for( size_t i = 0; i < pixelCount; i++ )
 		{
-			if( s.name.find( spriteName ) != std::string::npos )
+			uint32_t colour = s.canvasBuffer.pPixels[i].bits;
+			auto it = colourIndex.find( colour );
+			if( it == colourIndex.end() )
 			{
-				memset( s.preMultAlpha.pPixels, 0, sizeof( uint32_t ) * s.canvasBuffer.width * s.canvasBuffer.height );
-				PreMultiplyAlpha( s.canvasBuffer.pPixels, s.preMultAlpha.pPixels, s.canvasBuffer.width, s.canvasBuffer.height, s.width, 1.0f, 0x00FFFFFF );
-				s.canvasBuffer.preMultiplied = true;
-
-				return s.id;
+				if( palette.size() == 256 )
+					return false;
+				it = colourIndex.emplace( colour, static_cast<uint8_t>( palette.size() ) ).first;
+				palette.push_back( colour );
 			}
+			indices[i] = it->second;
 		}
-		return -1;
+
+		// Anything already recorded needs to be drawn from the 32-bit pixels before they are freed
+		FlushDrawing();
+		ForgetCachedFrames( spriteId );
+
+		s.indices = std::move( indices );
+		s.palette = std::move( palette );
+		PreMultiplyPalette( s );
+
+		// The span table and frame sizes are kept as they are, as the pixels haven't changed
+		delete[] s.canvasBuffer.pPixels;
+		s.canvasBuffer.pPixels = nullptr;
+		if( !s.inAtlas )
+			delete[] s.preMultAlpha.pPixels;
+		s.preMultAlpha.pPixels = nullptr;
+		s.inAtlas = false;
+		FreeMultiplyFactors( s );
+		return true;
+	}
+
+	int IndexSprites()
+	{
+		ASSERT_GRAPHICS;
+		int indexed = 0;
+		for( int id = 0; id < m_nTotalSprites; id++ )
+		{
+			if( m_vSpriteData[id].indices.empty() && IndexSprite( id ) )
+				indexed++;
+		}
+		return indexed;
 	}
 
 
@@ -3563,6 +7956,7 @@ namespace Play::Graphics
 	const PixelData* GetSpritePixelData(int spriteId) 
 	{ 
 		ASSERT_GRAPHICS;
+		ExpandIndexedSprite( m_vSpriteData[spriteId] );
 		return &m_vSpriteData[spriteId].canvasBuffer; 
 	}
 
@@ -3570,72 +7964,391 @@ namespace Play::Graphics
 	// Drawing functions
 	//********************************************************************************************************************************
 
-	void DrawTransparent( int spriteId, Point2f pos, int frameIndex, BlendColour globalMultiply)
+	void DrawTransparent( int spriteId, Point2f pos, int frameIndex, BlendColour globalMultiply, int flip )
 	{
 		ASSERT_GRAPHICS;
 		const Sprite& spr = m_vSpriteData[spriteId];
-		int destx = static_cast<int>( pos.x + 0.5f ) - spr.originX;
-		int desty = static_cast<int>( pos.y + 0.5f ) + (spr.height - spr.originY);
-		frameIndex = frameIndex % spr.totalCount;
-		int frameX = frameIndex % spr.hCount;
-		int frameY = frameIndex / spr.hCount;
-		int pixelX = frameX * spr.width;
-		int pixelY = frameY * spr.height;
-		int frameOffset = pixelX + ( spr.canvasBuffer.width * pixelY );
+		SpriteCommand command;
+		command.spriteId = spriteId;
+		command.frameIndex = frameIndex % spr.totalCount;
+		command.globalMultiply = globalMultiply;
+		command.flip = flip;
+
+		// The origin stays in the same place when the sprite is flipped, so the sprite moves around it
+		int originX = ( flip & Render::FLIP_HORIZONTAL ) ? spr.width - spr.originX : spr.originX;
+		int originY = ( flip & Render::FLIP_VERTICAL ) ? spr.height - spr.originY : spr.originY;
+		command.destX = static_cast<int>( pos.x + 0.5f ) - originX;
+		command.destY = static_cast<int>( pos.y + 0.5f ) + (spr.height - originY);
+
+		if( IsQueueing() )
+			QueueDrawing( command, {}, nullptr );
+		else
+			DrawSpriteCommand( command );
+	};
+
+	//********************************************************************************************************************************
+	// Rotation cache functions
+	//********************************************************************************************************************************
+
+	void SetRotationCache( size_t memoryBudget, int angleSteps, float scaleStep )
+	{
+		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( angleSteps > 0 && scaleStep > 0.0f, "The rotation cache needs at least one angle step and a scale step above zero" );
 
-		switch (blendMode)
+		// Frames rendered with different steps can't be used any more
+		if( angleSteps != m_rotationCache.angleSteps || scaleStep != m_rotationCache.scaleStep )
+			ClearRotationCache();
+
+		m_rotationCache.budget = memoryBudget;
+		m_rotationCache.angleSteps = angleSteps;
+		m_rotationCache.scaleStep = scaleStep;
+
+		while( m_rotationCache.stats.bytesUsed > memoryBudget )
 		{
-			case BLEND_NORMAL:
-				Render::BlitPixels<Render::AlphaBlendPolicy>(spr.preMultAlpha, frameOffset, destx, desty, spr.width, spr.height, globalMultiply);
-				break;
-			case BLEND_ADD:
-				Render::BlitPixels<Render::AdditiveBlendPolicy>(spr.preMultAlpha, frameOffset, destx, desty, spr.width, spr.height, globalMultiply);
-				break;
-			case BLEND_MULTIPLY:
-				Render::BlitPixels<Render::MultiplyBlendPolicy>(spr.canvasBuffer, frameOffset, destx, desty, spr.width, spr.height, globalMultiply);
-				break;
-			default:
-				PLAY_ASSERT_MSG(false, "Unsupported blend mode in DrawTransparent")
-					break;
+			EvictCachedFrame( m_rotationCache.frames.find( m_rotationCache.recent.back() ) );
+			m_rotationCache.stats.evictions++;
 		}
+	}
 
-	};
+	void ClearRotationCache()
+	{
+		m_rotationCache.frames.clear();
+		m_rotationCache.recent.clear();
+		m_rotationCache.stats = RotationCacheStats();
+	}
+
+	RotationCacheStats GetRotationCacheStats()
+	{
+		return m_rotationCache.stats;
+	}
+
+	bool DrawRotatedCached( int spriteId, Point2f pos, int frameIndex, float angle, float scale, BlendColour globalMultiply, Render::SamplingMode samplingMode )
+	{
+		// Multiply blending doesn't use the pre-multiplied pixels
+		if( blendMode == BLEND_MULTIPLY )
+			return false;
 
-	void DrawRotated( int spriteId, Point2f pos, int frameIndex, float angle, float scale, BlendColour globalMultiply )
+		const Sprite& spr = m_vSpriteData[spriteId];
+		if( samplingMode == Render::SAMPLE_DEFAULT )
+			samplingMode = Render::GetSamplingMode();
+
+		// Round the angle and scale to whole steps (mirroring with a negative scale isn't cached)
+		int angleSteps = m_rotationCache.angleSteps;
+		int angleStep = static_cast<int>( std::fmod( std::floor( angle * angleSteps / ( 2.0f * PLAY_PI ) + 0.5f ), static_cast<float>( angleSteps ) ) );
+		if( angleStep < 0 ) angleStep += angleSteps;
+		int scaleStep = static_cast<int>( std::floor( scale / m_rotationCache.scaleStep + 0.5f ) );
+		if( scaleStep <= 0 )
+			return false;
+
+		CachedFrameKey key{ spriteId, frameIndex % spr.totalCount, angleStep, scaleStep, samplingMode, globalMultiply.alpha, globalMultiply.red, globalMultiply.green, globalMultiply.blue };
+		std::shared_ptr< CachedFrame > frame;
+
+		auto found = m_rotationCache.frames.find( key );
+		if( found != m_rotationCache.frames.end() )
+		{
+			if( found->second.first->originX == spr.originX && found->second.first->originY == spr.originY )
+			{
+				frame = found->second.first;
+				m_rotationCache.recent.splice( m_rotationCache.recent.begin(), m_rotationCache.recent, found->second.second );
+				m_rotationCache.stats.hits++;
+			}
+			else
+			{
+				EvictCachedFrame( found );
+			}
+		}
+
+		if( !frame )
+		{
+			m_rotationCache.stats.misses++;
+
+			Matrix2D trans = MatrixScale( scaleStep * m_rotationCache.scaleStep, scaleStep * m_rotationCache.scaleStep ) * MatrixRotation( angleStep * 2.0f * PLAY_PI / angleSteps );
+			Vector2f origin{ spr.originX, spr.height - spr.originY };
+
+			// Don't let one huge frame empty the whole cache
+			Render::ClipRect bounds = Render::GetTransformedBounds( spr.width, spr.height, origin, trans );
+			if( static_cast<size_t>( bounds.right - bounds.left ) * ( bounds.bottom - bounds.top ) * sizeof( Pixel ) > m_rotationCache.budget )
+				return false;
+
+			int frameX = key.frameIndex % spr.hCount;
+			int frameY = key.frameIndex / spr.hCount;
+			int frameOffset = ( frameX * spr.width ) + ( spr.canvasBuffer.width * frameY * spr.height );
+
+			// An indexed sprite only has the frame being cached looked up, and it is freed again straight away
+			std::shared_ptr< const ExpandedPixels > expanded;
+			if( !spr.indices.empty() )
+				expanded = ExpandIndexedPixels( spr, frameOffset, spr.width, spr.height, Expansion::PRE_MULTIPLIED );
+
+			frame = std::make_shared< CachedFrame >();
+			frame->originX = spr.originX;
+			frame->originY = spr.originY;
+			if( expanded )
+				Render::TransformToPixels( expanded->pixels, 0, spr.width, spr.height, origin, trans, globalMultiply, samplingMode, frame->pixels, frame->offsetX, frame->offsetY );
+			else
+				Render::TransformToPixels( spr.preMultAlpha, frameOffset, spr.width, spr.height, origin, trans, globalMultiply, samplingMode, frame->pixels, frame->offsetX, frame->offsetY );
+			if( !frame->pixels.pPixels )
+				return false;
+
+			Render::BuildSpanTable( frame->pixels, frame->pixels.width, frame->spans );
+			frame->bytes = sizeof( CachedFrame ) + ( static_cast<size_t>( frame->pixels.width ) * frame->pixels.height * sizeof( Pixel ) )
+				+ ( frame->spans.spans.size() * sizeof( Render::PixelSpan ) ) + ( frame->spans.rowIndex.size() * sizeof( uint32_t ) );
+
+			// Make room by throwing away the least recently used frames
+			while( !m_rotationCache.recent.empty() && m_rotationCache.stats.bytesUsed + frame->bytes > m_rotationCache.budget )
+			{
+				EvictCachedFrame( m_rotationCache.frames.find( m_rotationCache.recent.back() ) );
+				m_rotationCache.stats.evictions++;
+			}
+
+			m_rotationCache.recent.push_front( key );
+			m_rotationCache.frames[key] = { frame, m_rotationCache.recent.begin() };
+			m_rotationCache.stats.bytesUsed += frame->bytes;
+			m_rotationCache.stats.frames = m_rotationCache.frames.size();
+		}
+
+		// The cached pixels already include the global multiply
+		int destx = static_cast<int>( pos.x + 0.5f ) + frame->offsetX;
+		int desty = static_cast<int>( pos.y + 0.5f ) - frame->offsetY;
+		int width = frame->pixels.width;
+		int height = frame->pixels.height;
+
+		Render::ClipRect bounds{ destx, m_playBuffer.height - desty, destx + width, m_playBuffer.height - desty + height };
+		SubmitDrawing( bounds, [=]
+		{
+			switch( GetDrawingBlendMode() )
+			{
+				case BLEND_NORMAL:
+					Render::BlitPixels<Render::AlphaBlendPolicy>( frame->pixels, 0, destx, desty, width, height, { 1.0f, 1.0f, 1.0f, 1.0f }, &frame->spans, 0 );
+					break;
+				case BLEND_ADD:
+					Render::BlitPixels<Render::AdditiveBlendPolicy>( frame->pixels, 0, destx, desty, width, height, { 1.0f, 1.0f, 1.0f, 1.0f }, &frame->spans, 0 );
+					break;
+				case BLEND_PRECISE:
+					Render::BlitPixels<Render::PreciseAlphaBlendPolicy>( frame->pixels, 0, destx, desty, width, height, { 1.0f, 1.0f, 1.0f, 1.0f }, &frame->spans, 0 );
+					break;
+				case BLEND_SUBTRACT:
+					Render::BlitPixels<Render::SubtractBlendPolicy>( frame->pixels, 0, destx, desty, width, height, { 1.0f, 1.0f, 1.0f, 1.0f }, &frame->spans, 0 );
+					break;
+				case BLEND_DARKEN:
+					Render::BlitPixels<Render::DarkenBlendPolicy>( frame->pixels, 0, destx, desty, width, height, { 1.0f, 1.0f, 1.0f, 1.0f }, &frame->spans, 0 );
+					break;
+				case BLEND_LIGHTEN:
+					Render::BlitPixels<Render::LightenBlendPolicy>( frame->pixels, 0, destx, desty, width, height, { 1.0f, 1.0f, 1.0f, 1.0f }, &frame->spans, 0 );
+					break;
+				default:
+					PLAY_ASSERT_MSG( false, "Unsupported blend mode for a cached frame" )
+					break;
+			}
+		} );
+		return true;
+	}
+
+	void DrawRotated( int spriteId, Point2f pos, int frameIndex, float angle, float scale, BlendColour globalMultiply, Render::SamplingMode samplingMode )
 	{
 		ASSERT_GRAPHICS;
+		if( m_rotationCache.budget > 0 && DrawRotatedCached( spriteId, pos, frameIndex, angle, scale, globalMultiply, samplingMode ) )
+			return;
+
 		Matrix2D trans = MatrixScale( scale, scale ) * MatrixRotation( angle )  * MatrixTranslation( pos.x, pos.y );
-		DrawTransformed( spriteId, trans, frameIndex, globalMultiply);
+		DrawTransformed( spriteId, trans, frameIndex, globalMultiply, samplingMode );
 	}
 
-	void DrawTransformed( int spriteId, const Matrix2D& trans, int frameIndex, BlendColour globalMultiply)
+	void DrawTransformed( int spriteId, const Matrix2D& trans, int frameIndex, BlendColour globalMultiply, Render::SamplingMode samplingMode )
 	{
 		ASSERT_GRAPHICS;
 		const Sprite& spr = m_vSpriteData[spriteId];
-		frameIndex = frameIndex % spr.totalCount;
-		int frameX = frameIndex % spr.hCount;
-		int frameY = frameIndex / spr.hCount;
+		SpriteCommand command;
+		command.spriteId = spriteId;
+		command.frameIndex = frameIndex % spr.totalCount;
+		command.transformed = true;
+		command.transform = trans;
+		command.origin = { spr.originX, spr.height - spr.originY };
+		command.globalMultiply = globalMultiply;
+
+		if( samplingMode == Render::SAMPLE_DEFAULT )
+			samplingMode = Render::GetSamplingMode();
+
+		// Filtering isn't supported for multiply blending so it falls back to the nearest pixel
+		if( blendMode == BLEND_MULTIPLY && samplingMode == Render::SAMPLE_BILINEAR )
+			samplingMode = Render::SAMPLE_NEAREST;
+
+		command.samplingMode = samplingMode;
+
+		if( IsQueueing() )
+			QueueDrawing( command, {}, nullptr );
+		else
+			DrawSpriteCommand( command );
+	}
+
+	void DrawSpriteCommand( const SpriteCommand& command )
+	{
+		const Sprite& spr = m_vSpriteData[command.spriteId];
+		int spriteId = command.spriteId;
+		int frameX = command.frameIndex % spr.hCount;
+		int frameY = command.frameIndex / spr.hCount;
 		int pixelX = frameX * spr.width;
 		int pixelY = frameY * spr.height;
 		int frameOffset = pixelX + ( spr.canvasBuffer.width * pixelY );
+		BlendColour globalMultiply = command.globalMultiply;
 
-		Vector2f origin = { spr.originX, spr.height - spr.originY };
+		// Created here rather than when the drawing is replayed, as that can happen on several threads at once
+		if( blendMode == BLEND_MULTIPLY && spr.indices.empty() )
+			GetMultiplyFactors( m_vSpriteData[spriteId] );
 
-		switch (blendMode)
+		if( command.transformed )
 		{
-		case BLEND_NORMAL:
-			Render::TransformPixels<Render::AlphaBlendPolicy>(spr.preMultAlpha, frameOffset, spr.width, spr.height, origin, trans, globalMultiply);
-			break;
-		case BLEND_ADD:
-			Render::TransformPixels<Render::AdditiveBlendPolicy>(spr.preMultAlpha, frameOffset, spr.width, spr.height, origin, trans, globalMultiply);
-			break;
-		case BLEND_MULTIPLY:
-			Render::TransformPixels<Render::MultiplyBlendPolicy>(spr.preMultAlpha, frameOffset, spr.width, spr.height, origin, trans, globalMultiply);
-			break;
-		default:
-			PLAY_ASSERT_MSG(false, "Unsupported blend mode in DrawTransparent")
-				break;
+			// An indexed sprite has just this frame looked up, which the drawing holds on to until it is done
+			// > The multiply factors can only be used without a global multiply (ScalePixels can't draw the canvas buffer, which has no run lengths)
+			bool multiplyFactors = globalMultiply.alpha == 1.0f && globalMultiply.red == 1.0f && globalMultiply.green == 1.0f && globalMultiply.blue == 1.0f;
+			std::shared_ptr< const ExpandedPixels > expanded;
+			if( !spr.indices.empty() )
+			{
+				Expansion expansion = blendMode != BLEND_MULTIPLY ? Expansion::PRE_MULTIPLIED : multiplyFactors ? Expansion::MULTIPLY_FACTORS : Expansion::CANVAS;
+				expanded = ExpandIndexedPixels( spr, frameOffset, spr.width, spr.height, expansion );
+			}
+
+			Matrix2D trans = command.transform;
+			Vector2f origin = command.origin;
+			Render::SamplingMode samplingMode = command.samplingMode;
+
+			SubmitDrawing( Render::GetTransformedBounds( spr.width, spr.height, origin, trans ), [=]
+			{
+				const Sprite& sprite = m_vSpriteData[spriteId];
+				const PixelData& preMultAlpha = expanded ? expanded->pixels : sprite.preMultAlpha;
+				int offset = expanded ? 0 : frameOffset;
+				switch (GetDrawingBlendMode())
+				{
+				case BLEND_NORMAL:
+					DrawTransformedPixels<Render::AlphaBlendPolicy>( preMultAlpha, offset, sprite, origin, trans, globalMultiply, samplingMode );
+					break;
+				case BLEND_ADD:
+					DrawTransformedPixels<Render::AdditiveBlendPolicy>( preMultAlpha, offset, sprite, origin, trans, globalMultiply, samplingMode );
+					break;
+				case BLEND_MULTIPLY:
+					if( multiplyFactors )
+						DrawTransformedPixels<Render::MultiplyBlendPolicy>( expanded ? expanded->pixels : sprite.multiplyFactors, offset, sprite, origin, trans, globalMultiply, samplingMode );
+					else
+						Render::TransformPixels<Render::MultiplyBlendPolicy>(expanded ? expanded->pixels : sprite.canvasBuffer, offset, sprite.width, sprite.height, origin, trans, globalMultiply, samplingMode);
+					break;
+				case BLEND_PRECISE:
+					DrawTransformedPixels<Render::PreciseAlphaBlendPolicy>( preMultAlpha, offset, sprite, origin, trans, globalMultiply, samplingMode );
+					break;
+				case BLEND_SUBTRACT:
+					DrawTransformedPixels<Render::SubtractBlendPolicy>( preMultAlpha, offset, sprite, origin, trans, globalMultiply, samplingMode );
+					break;
+				case BLEND_DARKEN:
+					DrawTransformedPixels<Render::DarkenBlendPolicy>( preMultAlpha, offset, sprite, origin, trans, globalMultiply, samplingMode );
+					break;
+				case BLEND_LIGHTEN:
+					DrawTransformedPixels<Render::LightenBlendPolicy>( preMultAlpha, offset, sprite, origin, trans, globalMultiply, samplingMode );
+					break;
+				default:
+					PLAY_ASSERT_MSG(false, "Unsupported blend mode in DrawTransformed")
+						break;
+				}
+			} );
+			return;
+		}
+
+		int destx = command.destX;
+		int desty = command.destY;
+		int flip = command.flip;
+		int spanRow = frameX + ( spr.preMultSpans.framesPerRow * pixelY );
+
+		// BlitIndexedPixels can't multiply blend, so an indexed sprite has just this frame looked up, which the drawing holds on to until it is done
+		// > BlitPixels only applies a global multiply which is below 1, and the multiply factors can only be used without one
+		bool multiplyFactors = !( globalMultiply.alpha < 1.0f || globalMultiply.red < 1.0f || globalMultiply.green < 1.0f || globalMultiply.blue < 1.0f );
+		std::shared_ptr< const ExpandedPixels > expanded;
+		if( !spr.indices.empty() && blendMode == BLEND_MULTIPLY )
+			expanded = ExpandIndexedPixels( spr, frameOffset, spr.width, spr.height, multiplyFactors ? Expansion::MULTIPLY_FACTORS : Expansion::CANVAS );
+
+		Render::ClipRect bounds{ destx, m_playBuffer.height - desty, destx + spr.width, m_playBuffer.height - desty + spr.height };
+		SubmitDrawing( bounds, [=]
+		{
+			const Sprite& sprite = m_vSpriteData[spriteId];
+			if( !sprite.indices.empty() && GetDrawingBlendMode() != BLEND_MULTIPLY )
+			{
+				DrawWithBlendMode( [&]( auto policy, bool )
+				{
+					Render::BlitIndexedPixels< decltype( policy ) >( sprite.indices.data(), sprite.canvasBuffer.width, sprite.preMultPalette.data(), frameOffset, destx, desty, sprite.width, sprite.height, globalMultiply, sprite.preMultSpans, spanRow, flip );
+				} );
+				return;
+			}
+
+			switch (GetDrawingBlendMode())
+			{
+				case BLEND_NORMAL:
+					Render::BlitPixels<Render::AlphaBlendPolicy>(sprite.preMultAlpha, frameOffset, destx, desty, sprite.width, sprite.height, globalMultiply, &sprite.preMultSpans, spanRow, flip);
+					break;
+				case BLEND_ADD:
+					Render::BlitPixels<Render::AdditiveBlendPolicy>(sprite.preMultAlpha, frameOffset, destx, desty, sprite.width, sprite.height, globalMultiply, &sprite.preMultSpans, spanRow, flip);
+					break;
+				case BLEND_MULTIPLY:
+					if( !multiplyFactors )
+						Render::BlitPixels<Render::MultiplyBlendPolicy>(expanded ? expanded->pixels : sprite.canvasBuffer, expanded ? 0 : frameOffset, destx, desty, sprite.width, sprite.height, globalMultiply, nullptr, 0, flip);
+					else
+						Render::BlitPixels<Render::MultiplyBlendPolicy>(expanded ? expanded->pixels : sprite.multiplyFactors, expanded ? 0 : frameOffset, destx, desty, sprite.width, sprite.height, globalMultiply, &sprite.preMultSpans, spanRow, flip);
+					break;
+				case BLEND_PRECISE:
+					Render::BlitPixels<Render::PreciseAlphaBlendPolicy>(sprite.preMultAlpha, frameOffset, destx, desty, sprite.width, sprite.height, globalMultiply, &sprite.preMultSpans, spanRow, flip);
+					break;
+				case BLEND_SUBTRACT:
+					Render::BlitPixels<Render::SubtractBlendPolicy>(sprite.preMultAlpha, frameOffset, destx, desty, sprite.width, sprite.height, globalMultiply, &sprite.preMultSpans, spanRow, flip);
+					break;
+				case BLEND_DARKEN:
+					Render::BlitPixels<Render::DarkenBlendPolicy>(sprite.preMultAlpha, frameOffset, destx, desty, sprite.width, sprite.height, globalMultiply, &sprite.preMultSpans, spanRow, flip);
+					break;
+				case BLEND_LIGHTEN:
+					Render::BlitPixels<Render::LightenBlendPolicy>(sprite.preMultAlpha, frameOffset, destx, desty, sprite.width, sprite.height, globalMultiply, &sprite.preMultSpans, spanRow, flip);
+					break;
+				default:
+					PLAY_ASSERT_MSG(false, "Unsupported blend mode in DrawTransparent")
+						break;
+			}
+		} );
+	}
+
+	void FlushDrawingQueue()
+	{
+		// Sort an index into the queue rather than moving the queued operations around
+		m_vQueueOrder.resize( m_vDrawingQueue.size() );
+		for( size_t i = 0; i < m_vQueueOrder.size(); i++ )
+			m_vQueueOrder[i] = static_cast<uint32_t>( i );
+
+		bool sortByState = m_drawOrder == ORDER_LAYER_STATE;
+		std::stable_sort( m_vQueueOrder.begin(), m_vQueueOrder.end(), [sortByState]( uint32_t a, uint32_t b )
+		{
+			const QueuedDrawing& qa = m_vDrawingQueue[a];
+			const QueuedDrawing& qb = m_vDrawingQueue[b];
+			if( qa.layer != qb.layer )
+				return qa.layer < qb.layer;
+			if( !sortByState )
+				return false;
+			if( qa.sprite.spriteId != qb.sprite.spriteId )
+				return qa.sprite.spriteId < qb.sprite.spriteId;
+			return qa.blendMode < qb.blendMode;
+		} );
+
+		BlendMode oldBlendMode = blendMode;
+		Render::ClipRect oldClip = Render::GetClipRect();
+		m_bFlushingQueue = true;
+
+		for( uint32_t index : m_vQueueOrder )
+		{
+			QueuedDrawing& queued = m_vDrawingQueue[index];
+			blendMode = queued.blendMode;
+			Render::SetClipRect( queued.clip );
+
+			if( queued.draw )
+				SubmitDrawing( queued.bounds, std::move( queued.draw ) );
+			else
+				DrawSpriteCommand( queued.sprite );
 		}
+
+		m_bFlushingQueue = false;
+		Render::SetClipRect( oldClip );
+		blendMode = oldBlendMode;
+		m_vDrawingQueue.clear();
 	}
 
 	void DrawBackground( int backgroundId )
@@ -3643,7 +8356,23 @@ namespace Play::Graphics
 		ASSERT_GRAPHICS;
 		PLAY_ASSERT_MSG( m_playBuffer.pPixels, "Trying to draw background without initialising display!" );
 		PLAY_ASSERT_MSG( m_vBackgroundData.size() > static_cast<size_t>(backgroundId), "Background image out of range!" );
-		Render::BlitBackground( m_vBackgroundData[backgroundId] );
+		auto blit = [=] { Render::BlitBackground( m_vBackgroundData[backgroundId] ); };
+
+		if( IsQueueing() )
+		{
+			DrawQueueBarrier( [=] { DrawBackground( backgroundId ); } );
+			return;
+		}
+
+		if( CanClearDrawnTiles() && m_clearState == ClearState::BACKGROUND && m_clearBackground == backgroundId )
+		{
+			RestoreDrawnTiles( blit );
+			return;
+		}
+
+		SubmitDrawing( Render::ClipRect(), blit );
+		if( CanClearDrawnTiles() )
+			SetClearState( ClearState::BACKGROUND, 0, backgroundId );
 	}
 
 	void ColourSprite( int spriteId, int r, int g, int b )
@@ -3651,40 +8380,176 @@ namespace Play::Graphics
 		ASSERT_GRAPHICS;
 		PLAY_ASSERT_MSG( spriteId >= 0 && spriteId < m_nTotalSprites, "Trying to colour invalid sprite id" );
 
+		// Anything already recorded needs to be drawn with the old colours
+		FlushDrawing();
+
 		Sprite& s = m_vSpriteData[spriteId];
-		uint32_t col = ( ( r & 0xFF ) << 16 ) | ( ( g & 0xFF ) << 8 ) | ( b & 0xFF );
+		s.colour = ( ( r & 0xFF ) << 16 ) | ( ( g & 0xFF ) << 8 ) | ( b & 0xFF );
 
-		PreMultiplyAlpha( s.canvasBuffer.pPixels, s.preMultAlpha.pPixels, s.canvasBuffer.width, s.canvasBuffer.height, s.width, 1.0f, col );
+		// An indexed sprite only needs its palette recolouring, unless its 32-bit pixels have been made as well
+		if( !s.indices.empty() )
+			PreMultiplyPalette( s );
+		if( s.preMultAlpha.pPixels )
+			PreMultiplyAlpha( s.canvasBuffer.pPixels, s.preMultAlpha.pPixels, s.canvasBuffer.width, s.canvasBuffer.height, s.width, 1.0f, s.colour );
 		s.canvasBuffer.preMultiplied = true;
+		ForgetCachedFrames( spriteId );
 	}
 
-	int DrawString( int fontId, Point2f pos, std::string text )
+	//********************************************************************************************************************************
+	// Font functions
+	//********************************************************************************************************************************
+
+	const Font& GetFont( int fontId )
 	{
-		ASSERT_GRAPHICS;
-		PLAY_ASSERT_MSG( fontId >= 0 && fontId < m_nTotalSprites, "Trying to use invalid sprite id for font" );
+		auto it = m_fonts.find( fontId );
+		if( it != m_fonts.end() )
+			return it->second;
 
-		int width = 0;
+		// The width of each character is hidden in the blue channel of the bottom row of pixels, starting with a space
+		const Sprite& spr = m_vSpriteData[fontId];
+		const PixelData& canvas = spr.canvasBuffer;
+		size_t widthsOffset = static_cast<size_t>( canvas.width ) * ( canvas.height - 1 );
+
+		Font& font = m_fonts[fontId];
+		for( int c = 32; c < static_cast<int>( font.advance.size() ) && c - 32 < canvas.width; c++ )
+		{
+			size_t i = widthsOffset + ( c - 32 );
+			font.advance[c] = spr.indices.empty() ? canvas.pPixels[i].b : spr.palette[spr.indices[i]].b;
+		}
+		return font;
+	}
+
+	std::shared_ptr< const TextRun > GetTextRun( int fontId, std::string_view text )
+	{
+		auto it = m_textRunCache.runs.find( std::make_pair( fontId, text ) );
+		if( it != m_textRunCache.runs.end() )
+		{
+			m_textRunCache.recent.splice( m_textRunCache.recent.begin(), m_textRunCache.recent, it->second.second );
+			return it->second.first;
+		}
 
+		const Sprite& spr = m_vSpriteData[fontId];
+		const Font& font = GetFont( fontId );
+
+		std::shared_ptr< TextRun > pRun = std::make_shared< TextRun >();
+		pRun->glyphs.reserve( text.length() );
 		for( char c : text )
 		{
-			Draw( fontId, { pos.x + width, pos.y }, c - 32 );
-			width += GetFontCharWidth( fontId, c );
+			int index = static_cast<unsigned char>( c ) - 32;
+			if( index >= 0 && index < spr.totalCount )
+			{
+				int frameX = index % spr.hCount;
+				int pixelY = ( index / spr.hCount ) * spr.height;
+
+				TextGlyph& glyph = pRun->glyphs.emplace_back();
+				glyph.x = pRun->width;
+				glyph.frameOffset = ( frameX * spr.width ) + ( spr.canvasBuffer.width * pixelY );
+				glyph.spanRow = frameX + ( spr.preMultSpans.framesPerRow * pixelY );
+			}
+			pRun->width += font.advance[static_cast<unsigned char>( c )];
+		}
+
+		if( m_textRunCache.maxRuns == 0 )
+			return pRun;
+
+		m_textRunCache.recent.emplace_front( fontId, std::string( text ) );
+		m_textRunCache.runs.emplace( m_textRunCache.recent.front(), std::make_pair( pRun, m_textRunCache.recent.begin() ) );
+
+		while( static_cast<int>( m_textRunCache.runs.size() ) > m_textRunCache.maxRuns )
+		{
+			m_textRunCache.runs.erase( m_textRunCache.recent.back() );
+			m_textRunCache.recent.pop_back();
+		}
+		return pRun;
+	}
+
+	void ForgetFontLayout( int fontId )
+	{
+		m_fonts.erase( fontId );
+
+		for( auto it = m_textRunCache.runs.begin(); it != m_textRunCache.runs.end(); )
+		{
+			if( it->first.first == fontId )
+			{
+				m_textRunCache.recent.erase( it->second.second );
+				it = m_textRunCache.runs.erase( it );
+			}
+			else
+				it++;
 		}
-		return width;
 	}
 
-	int DrawStringCentred( int fontId, Point2f pos, std::string text )
+	void SetTextRunCache( int maxRuns )
 	{
 		ASSERT_GRAPHICS;
-		int totalWidth = 0;
+		PLAY_ASSERT_MSG( maxRuns >= 0, "The text run cache can't have a negative size" );
 
-		for( char c : text )
-			totalWidth += GetFontCharWidth( fontId, c );
+		m_textRunCache.maxRuns = maxRuns;
+		while( static_cast<int>( m_textRunCache.runs.size() ) > maxRuns )
+		{
+			m_textRunCache.runs.erase( m_textRunCache.recent.back() );
+			m_textRunCache.recent.pop_back();
+		}
+	}
+
+	void ClearTextRunCache()
+	{
+		m_textRunCache.runs.clear();
+		m_textRunCache.recent.clear();
+	}
+
+	int DrawString( int fontId, Point2f pos, std::string_view text )
+	{
+		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( fontId >= 0 && fontId < m_nTotalSprites, "Trying to use invalid sprite id for font" );
 
-		pos.x -= totalWidth / 2;
+		std::shared_ptr< const TextRun > pRun = GetTextRun( fontId, text );
+		if( pRun->glyphs.empty() )
+			return pRun->width;
+
+		// The same positions as drawing each character with Draw, which rounds them separately
+		const Sprite& spr = m_vSpriteData[fontId];
+		float posX = pos.x + 0.5f;
+		int originX = spr.originX;
+		int destX = static_cast<int>( posX ) - originX;
+		int destY = static_cast<int>( pos.y + 0.5f ) + ( spr.height - spr.originY );
+
+		// Created here rather than when the drawing is replayed, as that can happen on several threads at once
+		// > An indexed font has its multiply factors looked up for this string only (see DrawSpriteCommand)
+		std::shared_ptr< const ExpandedPixels > expanded;
+		if( blendMode == BLEND_MULTIPLY && !spr.indices.empty() )
+			expanded = ExpandIndexedPixels( spr, 0, spr.canvasBuffer.width, spr.canvasBuffer.height, Expansion::MULTIPLY_FACTORS );
+		else if( blendMode == BLEND_MULTIPLY )
+			GetMultiplyFactors( m_vSpriteData[fontId] );
+
+		int top = m_playBuffer.height - destY;
+		Render::ClipRect bounds{ destX - 1, top, destX + pRun->glyphs.back().x + spr.width + 1, top + spr.height };
+		SubmitDrawing( bounds, [=]
+		{
+			const Sprite& sprite = m_vSpriteData[fontId];
+			DrawWithBlendMode( [&]( auto policy, bool preMultiply )
+			{
+				// Without a global multiply, multiply blending uses the multiply factors (as in DrawSpriteCommand)
+				const PixelData& pixels = preMultiply ? sprite.preMultAlpha : expanded ? expanded->pixels : sprite.multiplyFactors;
+				bool indexed = preMultiply && !sprite.indices.empty();
+				for( const TextGlyph& glyph : pRun->glyphs )
+				{
+					int glyphX = static_cast<int>( posX + glyph.x ) - originX;
+					if( indexed )
+						Render::BlitIndexedPixels< decltype( policy ) >( sprite.indices.data(), sprite.canvasBuffer.width, sprite.preMultPalette.data(), glyph.frameOffset, glyphX, destY, sprite.width, sprite.height, { 1.0f, 1.0f, 1.0f, 1.0f }, sprite.preMultSpans, glyph.spanRow );
+					else
+						Render::BlitPixels< decltype( policy ) >( pixels, glyph.frameOffset, glyphX, destY, sprite.width, sprite.height, { 1.0f, 1.0f, 1.0f, 1.0f }, &sprite.preMultSpans, glyph.spanRow );
+				}
+			} );
+		} );
+		return pRun->width;
+	}
 
-		DrawString( fontId, pos, text );
-		return totalWidth;
+	int DrawStringCentred( int fontId, Point2f pos, std::string_view text )
+	{
+		ASSERT_GRAPHICS;
+		pos.x -= GetStringWidth( fontId, text ) / 2;
+		return DrawString( fontId, pos, text );
 	}
 
 	int DrawChar( int fontId, Point2f pos, char c )
@@ -3707,8 +8572,19 @@ namespace Play::Graphics
 	{
 		ASSERT_GRAPHICS;
 		PLAY_ASSERT_MSG( fontId >= 0 && fontId < m_nTotalSprites, "Trying to use invalid sprite id for font" );
-		int glyphWidthDataOffset = m_vSpriteData[ fontId ].canvasBuffer.width * (m_vSpriteData[ fontId ].canvasBuffer.height - 1);
-		return (m_vSpriteData[fontId].canvasBuffer.pPixels + glyphWidthDataOffset + ( c - 32 ))->b; // character width hidden in pixel data
+		return GetFont( fontId ).advance[static_cast<unsigned char>( c )];
+	}
+
+	int GetStringWidth( int fontId, std::string_view text )
+	{
+		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( fontId >= 0 && fontId < m_nTotalSprites, "Trying to use invalid sprite id for font" );
+		const Font& font = GetFont( fontId );
+
+		int width = 0;
+		for( char c : text )
+			width += font.advance[static_cast<unsigned char>( c )];
+		return width;
 	}
 
 	//********************************************************************************************************************************
@@ -3762,6 +8638,26 @@ namespace Play::Graphics
 		int b_pixel_y = b_frame_y * spr_b.height;
 		int b_frame_offset = b_pixel_x + (spr_b.canvasBuffer.width * b_pixel_y);
 
+		// Only the alpha of each pixel is tested. Indexed sprites have just the two frames looked up, which are freed again afterwards
+		std::shared_ptr< const ExpandedPixels > a_expanded, b_expanded;
+		const uint32_t* a_pixels = (uint32_t*)spr_a.preMultAlpha.pPixels + a_frame_offset;
+		int a_width = spr_a.canvasBuffer.width;
+		if( !spr_a.indices.empty() )
+		{
+			a_expanded = ExpandIndexedPixels( spr_a, a_frame_offset, spr_a.width, spr_a.height, Expansion::PRE_MULTIPLIED );
+			a_pixels = (uint32_t*)a_expanded->pixels.pPixels;
+			a_width = spr_a.width;
+		}
+
+		const uint32_t* b_pixels = (uint32_t*)spr_b.canvasBuffer.pPixels + b_frame_offset;
+		int b_width = spr_b.canvasBuffer.width;
+		if( !spr_b.indices.empty() )
+		{
+			b_expanded = ExpandIndexedPixels( spr_b, b_frame_offset, spr_b.width, spr_b.height, Expansion::CANVAS );
+			b_pixels = (uint32_t*)b_expanded->pixels.pPixels;
+			b_width = spr_b.width;
+		}
+
 		Vector2f a_origin = { spr_a.originX, spr_a.height - spr_a.originY };
 		Vector2f b_origin = { spr_b.originX, spr_b.height - spr_b.originY };
 
@@ -3779,14 +8675,51 @@ namespace Play::Graphics
 		float b_xresetx = b_xincx * spr_a.width; // This needs to be sprite a's width as that's the space we are iterating through
 		float b_xresety = b_xincy * spr_a.width; // This needs to be sprite a's width as that's the space we are iterating through
 
-		uint32_t* a_pixel = (uint32_t*)spr_a.preMultAlpha.pPixels + a_frame_offset;
-		uint32_t* a_pixel_end = a_pixel + (spr_a.height * spr_a.canvasBuffer.width);
+		if( Render::GetSamplingMode() == Render::SAMPLE_NEAREST )
+		{
+			// Step through sprite B's space in 16.16 fixed point so the result doesn't depend on the compiler (see Render::SetSamplingMode)
+			int64_t b_fix_posx = Render::ToFixed16( b_posx );
+			int64_t b_fix_posy = Render::ToFixed16( b_posy );
+			int64_t b_fix_xincx = Render::ToFixed16( b_xincx );
+			int64_t b_fix_xincy = Render::ToFixed16( b_xincy );
+			int64_t b_fix_yincx = Render::ToFixed16( b_yincx );
+			int64_t b_fix_yincy = Render::ToFixed16( b_yincy );
+
+			for( int a_y = 0; a_y < spr_a.height; a_y++ )
+			{
+				const uint32_t* a_row = a_pixels + ( a_y * a_width );
+				int64_t posx = b_fix_posx + ( a_y * b_fix_yincx );
+				int64_t posy = b_fix_posy + ( a_y * b_fix_yincy );
+
+				for( int a_x = 0; a_x < spr_a.width; a_x++, posx += b_fix_xincx, posy += b_fix_xincy )
+				{
+					if( a_row[ a_x ] >= 0xFF000000 )
+						continue;
+
+					// The origin of a pixel is in its centre
+					int64_t roundX = ( posx + 0x8000 ) >> 16;
+					int64_t roundY = ( posy + 0x8000 ) >> 16;
+
+					// Clip within the sprite boundaries
+					if( roundX >= 0 && roundY >= 0 && roundX < spr_b.width && roundY < spr_b.height )
+					{
+						const uint32_t* b_pixel = b_pixels + roundX + ( roundY * b_width );
+						if( *b_pixel & 0xFF000000 )
+							overlapping_pixels++;
+					}
+				}
+			}
+			return overlapping_pixels;
+		}
+
+		const uint32_t* a_pixel = a_pixels;
+		const uint32_t* a_pixel_end = a_pixel + (spr_a.height * a_width);
 
 		// Iterate sequentially through pixels within the render target buffer
 		while( a_pixel < a_pixel_end )
 		{
 			// For each row of pixels in turn
-			uint32_t* dst_row_end = a_pixel + spr_a.width;
+			const uint32_t* dst_row_end = a_pixel + spr_a.width;
 			while( a_pixel < dst_row_end )
 			{
 				if( *a_pixel < 0xFF000000 )
@@ -3798,8 +8731,8 @@ namespace Play::Graphics
 					// Clip within the sprite boundaries
 					if( roundX >= 0 && roundY >= 0 && roundX < spr_b.width && roundY < spr_b.height )
 					{
-						int b_pixel_index = roundX + (roundY * spr_b.canvasBuffer.width);
-						uint32_t* b_pixel = ((uint32_t*)spr_b.canvasBuffer.pPixels + b_pixel_index + b_frame_offset);
+						int b_pixel_index = roundX + (roundY * b_width);
+						const uint32_t* b_pixel = b_pixels + b_pixel_index;
 						if( *b_pixel & 0xFF000000 )
 							overlapping_pixels++; // Could also overwite to visualise: *b_pixel = 0xFFFFFFFF, but need to call UpdateSprite afterwards.	
 					}
@@ -3812,7 +8745,7 @@ namespace Play::Graphics
 			}
 
 			// Move render target pointer to the start of the next row
-			a_pixel += spr_a.canvasBuffer.width - spr_a.width;
+			a_pixel += a_width - spr_a.width;
 
 			// Move sprite buffer pointer back to the start of the current row
 			b_posx -= b_xresetx;
@@ -3880,6 +8813,50 @@ namespace Play::Graphics
 		}
 	}
 
+	void PreMultiplyFactors( Pixel* source, Pixel* dest, int width, int height, int maxSkipWidth )
+	{
+		ASSERT_GRAPHICS;
+
+		Pixel* pSourcePixels = source;
+		Pixel* pDestPixels = dest;
+
+		for( int bh = 0; bh < height; bh++ )
+		{
+			for( int bw = 0; bw < width; bw++ )
+			{
+				uint32_t src = pSourcePixels->bits;
+				uint32_t srcAlpha = src >> 24;
+
+				if( srcAlpha == 0x00 ) // Completely transparent pixel
+				{
+					int repeats = 0;
+					// We can only skip to the end of the row because the sprite frames are arranged on a continuous canvas
+					int maxSkip = maxSkipWidth - ( bw % maxSkipWidth );
+
+					for( int zw = 1; zw < maxSkip; zw++ )
+					{
+						if( ( pSourcePixels + zw )->bits >> 24 == 0x00 ) // Another transparent pixel
+							repeats++;
+						else
+							break;
+					}
+					pDestPixels->bits = 0xFF000000 | repeats;
+				}
+				else
+				{
+					// The multiply blend is dest * ( invSrcAlpha + src * srcAlpha ), so everything but the destination can be worked out here (as a fraction of 256)
+					uint32_t invSrcAlpha = ( 0xFF - srcAlpha ) * 0xFF;
+					uint32_t factorRed = ( invSrcAlpha + ( ( ( src >> 16 ) & 0xFF ) * srcAlpha ) + 0x80 ) >> 8;
+					uint32_t factorGreen = ( invSrcAlpha + ( ( ( src >> 8 ) & 0xFF ) * srcAlpha ) + 0x80 ) >> 8;
+					uint32_t factorBlue = ( invSrcAlpha + ( ( src & 0xFF ) * srcAlpha ) + 0x80 ) >> 8;
+					pDestPixels->bits = ( factorRed << 16 ) | ( factorGreen << 8 ) | factorBlue;
+				}
+				pDestPixels++;
+				pSourcePixels++;
+			}
+		}
+	}
+
 	//********************************************************************************************************************************
 	// Basic drawing functions
 	//********************************************************************************************************************************
@@ -3887,10 +8864,20 @@ namespace Play::Graphics
 	{
 		ASSERT_GRAPHICS;
 
+		// Checked up front as individual pixels are often drawn in large numbers
+		if( IsQueueing() || IsRecording() )
+		{
+			SubmitDrawing( GetDisplayBounds( pos, pos ), [=] { DrawPixel( pos, srcPix ); } );
+			return;
+		}
+
+		if( IsTracking() )
+			MarkDirty( GetDisplayBounds( pos, pos ) );
+
 		pos.y = Window::GetHeight() - pos.y; //// Flip the y-coordinate to be consistant with a Cartesian co-ordinate system
 
 		// Convert floating point co-ordinates to pixels
-		switch (blendMode)
+		switch (GetDrawingBlendMode())
 		{
 		case BLEND_NORMAL:
 			// Convert floating point co-ordinates to pixels
@@ -3904,6 +8891,22 @@ namespace Play::Graphics
 			// Convert floating point co-ordinates to pixels
 			Render::DrawPixel<Render::MultiplyBlendPolicy>(static_cast<int>(pos.x + 0.5f), static_cast<int>(pos.y + 0.5f), srcPix);
 			break;
+		case BLEND_PRECISE:
+			// Convert floating point co-ordinates to pixels
+			Render::DrawPixelPreMult<Render::PreciseAlphaBlendPolicy>(static_cast<int>(pos.x + 0.5f), static_cast<int>(pos.y + 0.5f), srcPix);
+			break;
+		case BLEND_SUBTRACT:
+			// Convert floating point co-ordinates to pixels
+			Render::DrawPixelPreMult<Render::SubtractBlendPolicy>(static_cast<int>(pos.x + 0.5f), static_cast<int>(pos.y + 0.5f), srcPix);
+			break;
+		case BLEND_DARKEN:
+			// Convert floating point co-ordinates to pixels
+			Render::DrawPixelPreMult<Render::DarkenBlendPolicy>(static_cast<int>(pos.x + 0.5f), static_cast<int>(pos.y + 0.5f), srcPix);
+			break;
+		case BLEND_LIGHTEN:
+			// Convert floating point co-ordinates to pixels
+			Render::DrawPixelPreMult<Render::LightenBlendPolicy>(static_cast<int>(pos.x + 0.5f), static_cast<int>(pos.y + 0.5f), srcPix);
+			break;
 		default:
 			PLAY_ASSERT_MSG(false, "Unsupported blend mode in PlayGraphics::DrawPixel")
 				break;
@@ -3919,7 +8922,38 @@ namespace Play::Graphics
 		int x2 = static_cast<int>( endPos.x + 0.5f );
 		int y2 = static_cast<int>( endPos.y + 0.5f );
 
-		Render::DrawLine( x1, y1, x2, y2, pix );
+		SubmitDrawing( GetDisplayBounds( { x1, y1 }, { x2, y2 } ), [=] { DrawCartesianLine( x1, y1, x2, y2, pix ); } );
+	}
+
+	void DrawLineAA( Point2f startPos, Point2f endPos, Pixel pix )
+	{
+		ASSERT_GRAPHICS;
+		SubmitDrawing( GetDisplayBounds( startPos, endPos ), [=]
+		{
+			float height = static_cast<float>( Render::m_pRenderTarget->height ); // Flip the y-coordinates to be consistant with a Cartesian co-ordinate system
+			DrawWithBlendMode( [=]( auto policy, bool preMultiply )
+			{
+				Render::DrawLineAA< decltype( policy ) >( startPos.x, height - startPos.y, endPos.x, height - endPos.y, pix, preMultiply );
+			} );
+		} );
+	}
+
+	void DrawThickLine( Point2f startPos, Point2f endPos, float thickness, Pixel pix, Render::LineCap cap )
+	{
+		ASSERT_GRAPHICS;
+		// The caps can reach half the thickness past the end points in any direction
+		float reach = thickness * 0.5f + 1.0f;
+		Point2f minPos = { std::min( startPos.x, endPos.x ) - reach, std::min( startPos.y, endPos.y ) - reach };
+		Point2f maxPos = { std::max( startPos.x, endPos.x ) + reach, std::max( startPos.y, endPos.y ) + reach };
+
+		SubmitDrawing( GetDisplayBounds( minPos, maxPos ), [=]
+		{
+			float height = static_cast<float>( Render::m_pRenderTarget->height ); // Flip the y-coordinates to be consistant with a Cartesian co-ordinate system
+			DrawWithBlendMode( [=]( auto policy, bool preMultiply )
+			{
+				Render::DrawThickLine< decltype( policy ) >( startPos.x, height - startPos.y, endPos.x, height - endPos.y, thickness, pix, cap, preMultiply );
+			} );
+		} );
 	}
 
 	void DrawRect( Point2f bottomLeft, Point2f topRight, Pixel pix, bool fill /*= false */ )
@@ -3931,21 +8965,25 @@ namespace Play::Graphics
 		int y1 = static_cast<int>( bottomLeft.y + 0.5f );
 		int y2 = static_cast<int>( topRight.y + 0.5f );
 
-		if( fill )
+		SubmitDrawing( GetDisplayBounds( { x1, y1 }, { x2, y2 } ), [=]
 		{
-			for( int x = x1; x < x2; x++ )
+			if( fill )
 			{
-				for( int y = y1; y < y2; y++ )
-					DrawPixel({ x, y }, pix);
+				// The same pixels as drawing each one with DrawPixel: rows y1 to y2 (exclusive) counting up from the bottom
+				int height = Render::m_pRenderTarget->height;
+				DrawWithBlendMode( [=]( auto policy, bool preMultiply )
+				{
+					Render::FillRect< decltype( policy ) >( x1, height - y2 + 1, x2, height - y1 + 1, pix, preMultiply );
+				} );
 			}
-		}
-		else
-		{
-			Render::DrawLine( x1, y1, x2, y1, pix );
-			Render::DrawLine( x2, y1, x2, y2, pix );
-			Render::DrawLine( x2, y2, x1, y2, pix );
-			Render::DrawLine( x1, y2, x1, y1, pix );
-		}
+			else
+			{
+				DrawCartesianLine( x1, y1, x2, y1, pix );
+				DrawCartesianLine( x2, y1, x2, y2, pix );
+				DrawCartesianLine( x2, y2, x1, y2, pix );
+				DrawCartesianLine( x1, y2, x1, y1, pix );
+			}
+		} );
 	}
 
 	// Private function called by DrawCircle
@@ -3962,46 +9000,245 @@ namespace Play::Graphics
 		DrawPixel( { posX + offY , posY + offX }, pix );
 	}
 
-	void DrawCircle( Point2f pos, int radius, Pixel pix )
+	void DrawCircle( Point2f pos, int radius, Pixel pix, bool fill )
 	{
 		ASSERT_GRAPHICS;
+		if( fill )
+		{
+			DrawEllipse( pos, radius, radius, pix, true );
+			return;
+		}
+
 		// Convert floating point co-ordinates to pixels
 		int x = static_cast<int>( pos.x + 0.5f );
 		int y = static_cast<int>( pos.y + 0.5f );
+		int r = abs( radius );
+
+		SubmitDrawing( GetDisplayBounds( { x - r, y - r }, { x + r, y + r } ), [=]
+		{
+			int dx = 0;
+			int dy = radius;
 
-		int dx = 0;
-		int dy = radius;
+			int d = 3 - 2 * radius;
+			DrawCircleOctants( x, y, dx, dy, pix );
 
-		int d = 3 - 2 * radius;
-		DrawCircleOctants( x, y, dx, dy, pix );
+			while( dy >= dx )
+			{
+				dx++;
+				if( d > 0 )
+				{
+					dy--;
+					d = static_cast<int>( d + 4 * ( dx - dy ) + 10 );
+				}
+				else
+				{
+					d = static_cast<int>( d + 4 * dx + 6 );
+				}
+				DrawCircleOctants( x, y, dx, dy, pix );
+			}
+		} );
+	};
+
+	void DrawEllipse( Point2f pos, int radiusX, int radiusY, Pixel pix, bool fill )
+	{
+		ASSERT_GRAPHICS;
+		// Convert floating point co-ordinates to pixels
+		int x = static_cast<int>( pos.x + 0.5f );
+		int y = static_cast<int>( pos.y + 0.5f );
+		int rx = abs( radiusX );
+		int ry = abs( radiusY );
 
-		while( dy >= dx )
+		SubmitDrawing( GetDisplayBounds( { x - rx, y - ry }, { x + rx, y + ry } ), [=]
 		{
-			dx++;
-			if( d > 0 )
+			int centreY = Render::m_pRenderTarget->height - y; // Flip the y-coordinate to be consistant with a Cartesian co-ordinate system
+			DrawWithBlendMode( [=]( auto policy, bool preMultiply )
+			{
+				Render::DrawEllipse< decltype( policy ) >( x, centreY, rx, ry, pix, fill, preMultiply );
+			} );
+		} );
+	}
+
+	void DrawPolygon( const std::vector< Point2f >& points, Pixel pix, bool fill )
+	{
+		ASSERT_GRAPHICS;
+		if( points.empty() )
+			return;
+
+		Point2f minPos = points[0];
+		Point2f maxPos = points[0];
+		for( const Point2f& p : points )
+		{
+			minPos = { std::min( minPos.x, p.x ), std::min( minPos.y, p.y ) };
+			maxPos = { std::max( maxPos.x, p.x ), std::max( maxPos.y, p.y ) };
+		}
+
+		SubmitDrawing( GetDisplayBounds( minPos, maxPos ), [=]
+		{
+			if( fill )
 			{
-				dy--;
-				d = static_cast<int>( d + 4 * ( dx - dy ) + 10 );
+				// Flip the y-coordinates to be consistant with a Cartesian co-ordinate system
+				int height = Render::m_pRenderTarget->height;
+				thread_local std::vector< Point2f > flipped;
+				flipped.clear();
+				for( const Point2f& p : points )
+					flipped.push_back( { p.x, height - p.y } );
+
+				DrawWithBlendMode( [&]( auto policy, bool preMultiply )
+				{
+					Render::FillPolygon< decltype( policy ) >( flipped.data(), static_cast<int>( flipped.size() ), pix, preMultiply );
+				} );
 			}
 			else
 			{
-				d = static_cast<int>( d + 4 * dx + 6 );
+				for( size_t i = 0, j = points.size() - 1; i < points.size(); j = i++ )
+				{
+					DrawCartesianLine( static_cast<int>( points[j].x + 0.5f ), static_cast<int>( points[j].y + 0.5f ), 
+						static_cast<int>( points[i].x + 0.5f ), static_cast<int>( points[i].y + 0.5f ), pix );
+				}
 			}
-			DrawCircleOctants( x, y, dx, dy, pix );
-		}
-	};
+		} );
+	}
 
 	void DrawPixelData( PixelData* pixelData, Point2f pos, float alpha )
 	{
 		ASSERT_GRAPHICS;
+		// The caller is free to change the pixel data afterwards, so this is never deferred
+		FlushDrawing();
 		if( !pixelData->preMultiplied )
 		{
 			PreMultiplyAlpha( pixelData->pPixels, pixelData->pPixels, pixelData->width, pixelData->height, pixelData->width );
 			pixelData->preMultiplied = true;
 		}
+		if( IsTracking() )
+		{
+			// BlitPixels flips pos.y, so the top row is counted down from the top of the display buffer
+			int x = static_cast<int>( pos.x );
+			int top = m_playBuffer.height - static_cast<int>( pos.y );
+			MarkDirty( { x, top, x + pixelData->width, top + pixelData->height } );
+		}
 		Render::BlitPixels<Render::AlphaBlendPolicy>(*pixelData, 0, static_cast<int>(pos.x), static_cast<int>(pos.y), pixelData->width, pixelData->height, { alpha, 1.0f, 1.0f, 1.0f });
 	}
 
+	//********************************************************************************************************************************
+	// Render target functions
+	//********************************************************************************************************************************
+
+	PixelData* AcquireRenderTarget( int width, int height )
+	{
+		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( width > 0 && height > 0, "Render targets need a width and height above zero" );
+		FlushDrawing();
+
+		size_t capacity = RENDER_TARGET_MIN_CAPACITY;
+		while( capacity < static_cast<size_t>( width ) * height )
+			capacity *= 2;
+
+		// Use the smallest free bucket which is big enough, so large allocations aren't taken up by small targets
+		PooledTarget* pTarget = nullptr;
+		for( std::unique_ptr< PooledTarget >& pooled : m_vTargetPool )
+		{
+			if( !pooled->inUse && pooled->capacity >= capacity && ( !pTarget || pooled->capacity < pTarget->capacity ) )
+				pTarget = pooled.get();
+		}
+
+		if( !pTarget )
+		{
+			m_vTargetPool.push_back( std::make_unique< PooledTarget >() );
+			pTarget = m_vTargetPool.back().get();
+			pTarget->capacity = capacity;
+			pTarget->pixels.pPixels = static_cast<Pixel*>( ::operator new[]( capacity * sizeof( Pixel ), std::align_val_t( RENDER_TARGET_ALIGNMENT ) ) );
+		}
+
+		pTarget->inUse = true;
+		pTarget->pixels.width = width;
+		pTarget->pixels.height = height;
+		pTarget->pixels.preMultiplied = false;
+		std::fill( pTarget->pixels.pPixels, pTarget->pixels.pPixels + ( width * height ), Pixel( 0x00000000 ) );
+		return &pTarget->pixels;
+	}
+
+	void ReleaseRenderTarget( PixelData* pRenderTarget )
+	{
+		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( pRenderTarget != Render::m_pRenderTarget, "Trying to release the render target which is being drawn into" );
+		for( std::unique_ptr< PooledTarget >& pooled : m_vTargetPool )
+		{
+			if( &pooled->pixels == pRenderTarget )
+			{
+				pooled->inUse = false;
+				return;
+			}
+		}
+		PLAY_ASSERT_MSG( false, "Trying to release a render target which didn't come from AcquireRenderTarget" );
+	}
+
+	void TrimRenderTargetPool()
+	{
+		ASSERT_GRAPHICS;
+		// Recorded drawing may still composite a released target
+		FlushDrawing();
+		m_vTargetPool.erase( std::remove_if( m_vTargetPool.begin(), m_vTargetPool.end(), []( const std::unique_ptr< PooledTarget >& pooled ) { return !pooled->inUse; } ), m_vTargetPool.end() );
+	}
+
+	void PushRenderTarget( PixelData* pRenderTarget )
+	{
+		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( pRenderTarget && pRenderTarget->pPixels, "Trying to push a render target without any pixels" );
+		FlushDrawing();
+		m_vTargetStack.push_back( { Render::SetRenderTarget( pRenderTarget ), Render::GetClipRect() } );
+		Render::ClearClipRect();
+	}
+
+	void PopRenderTarget()
+	{
+		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( !m_vTargetStack.empty(), "PopRenderTarget has been called more times than PushRenderTarget" );
+		FlushDrawing();
+		Render::SetRenderTarget( m_vTargetStack.back().pPrevious );
+		Render::SetClipRect( m_vTargetStack.back().clip );
+		m_vTargetStack.pop_back();
+	}
+
+	void DrawRenderTarget( const PixelData* pRenderTarget, Point2f pos, BlendColour globalMultiply )
+	{
+		ASSERT_GRAPHICS;
+		PLAY_ASSERT_MSG( pRenderTarget && pRenderTarget != Render::m_pRenderTarget, "A render target can't be drawn into itself" );
+		int destX = static_cast<int>( pos.x + 0.5f );
+		int destY = static_cast<int>( pos.y + 0.5f ) + pRenderTarget->height;
+		int top = Render::m_pRenderTarget->height - destY;
+
+		SubmitDrawing( { destX, top, destX + pRenderTarget->width, top + pRenderTarget->height }, [=]
+		{
+			switch( GetDrawingBlendMode() )
+			{
+				case BLEND_NORMAL:
+					Render::CompositePixels<Render::AlphaBlendPolicy>( *pRenderTarget, destX, destY, globalMultiply );
+					break;
+				case BLEND_ADD:
+					Render::CompositePixels<Render::AdditiveBlendPolicy>( *pRenderTarget, destX, destY, globalMultiply );
+					break;
+				case BLEND_MULTIPLY:
+					Render::CompositePixels<Render::MultiplyBlendPolicy>( *pRenderTarget, destX, destY, globalMultiply, false );
+					break;
+				case BLEND_PRECISE:
+					Render::CompositePixels<Render::PreciseAlphaBlendPolicy>( *pRenderTarget, destX, destY, globalMultiply );
+					break;
+				case BLEND_SUBTRACT:
+					Render::CompositePixels<Render::SubtractBlendPolicy>( *pRenderTarget, destX, destY, globalMultiply );
+					break;
+				case BLEND_DARKEN:
+					Render::CompositePixels<Render::DarkenBlendPolicy>( *pRenderTarget, destX, destY, globalMultiply );
+					break;
+				case BLEND_LIGHTEN:
+					Render::CompositePixels<Render::LightenBlendPolicy>( *pRenderTarget, destX, destY, globalMultiply );
+					break;
+				default:
+					PLAY_ASSERT_MSG( false, "Unsupported blend mode in DrawRenderTarget" )
+					break;
+			}
+		} );
+	}
+
 	//********************************************************************************************************************************
 	// Debug font functions
 	//********************************************************************************************************************************
@@ -4044,11 +9281,64 @@ namespace Play::Graphics
 					m_pDebugFontBuffer[( y * FONT_IMAGE_WIDTH ) + x] = 1; // not ARGB just 1 (a pixel)
 			}
 		}
+
+		CreateDebugFontSheet( m_debugFontGlyphs, false );
+		CreateDebugFontSheet( m_debugFontOutlines, true );
 	}
 
-	int DrawDebugCharacter( Point2f pos, char c, Pixel pix )
+	void CreateDebugFontSheet( Sprite& sheet, bool outlined )
+	{
+		int border = outlined ? 1 : 0;
+		sheet.width = FONT_CHAR_WIDTH + ( border * 2 );
+		sheet.height = FONT_CHAR_HEIGHT + ( border * 2 );
+		sheet.hCount = FONT_IMAGE_WIDTH / FONT_CHAR_WIDTH;
+		sheet.vCount = FONT_IMAGE_HEIGHT / FONT_CHAR_HEIGHT;
+		sheet.totalCount = sheet.hCount * sheet.vCount;
+
+		PixelData& canvas = sheet.canvasBuffer;
+		canvas.width = sheet.width * sheet.hCount;
+		canvas.height = sheet.height * sheet.vCount;
+		canvas.pPixels = new Pixel[static_cast<size_t>( canvas.width ) * canvas.height];
+		std::fill( canvas.pPixels, canvas.pPixels + ( canvas.width * canvas.height ), Pixel( 0x00000000 ) );
+
+		for( int glyph = 0; glyph < sheet.totalCount; glyph++ )
+		{
+			int sourceX = ( glyph % sheet.hCount ) * FONT_CHAR_WIDTH;
+			int sourceY = ( glyph / sheet.hCount ) * FONT_CHAR_HEIGHT;
+			int destX = ( ( glyph % sheet.hCount ) * sheet.width ) + border;
+			int destY = ( ( glyph / sheet.hCount ) * sheet.height ) + border;
+
+			for( int y = 0; y < FONT_CHAR_HEIGHT; y++ )
+			{
+				for( int x = 0; x < FONT_CHAR_WIDTH; x++ )
+				{
+					if( m_pDebugFontBuffer[( ( sourceY + y ) * FONT_IMAGE_WIDTH ) + ( sourceX + x )] == 0 )
+						continue;
+
+					if( !outlined )
+					{
+						canvas.pPixels[( ( destY + y ) * canvas.width ) + destX + x] = 0xFFFFFFFF;
+						continue;
+					}
+
+					for( int offsetY : { -1, 1 } )
+					{
+						for( int offsetX : { -1, 1 } )
+							canvas.pPixels[( ( destY + y + offsetY ) * canvas.width ) + destX + x + offsetX] = 0xFFFFFFFF;
+					}
+				}
+			}
+		}
+
+		sheet.preMultAlpha.pPixels = new Pixel[static_cast<size_t>( canvas.width ) * canvas.height];
+		sheet.preMultAlpha.width = canvas.width;
+		sheet.preMultAlpha.height = canvas.height;
+		PreMultiplyAlpha( canvas.pPixels, sheet.preMultAlpha.pPixels, canvas.width, canvas.height, sheet.width, 1.0f, 0x00FFFFFF );
+		Render::BuildSpanTable( sheet.preMultAlpha, sheet.width, sheet.preMultSpans );
+	}
+
+	int GetDebugGlyph( char c )
 	{
-		ASSERT_GRAPHICS;
 		// Limited character set in the font (0x30-0x5F) so includes translation of useful chars outside that range
 		switch( c )
 		{
@@ -4060,20 +9350,73 @@ namespace Play::Graphics
 		}
 
 		if( c < 0x30 || c > 0x5F )
-			return FONT_CHAR_WIDTH;
+			return -1;
+		return c - 0x30;
+	}
+
+	void DrawDebugGlyphs( Sprite& sheet, int border, Point2f pos, const std::string& s, Pixel pix )
+	{
+		// The same pixels as the font buffer drawn with DrawPixel, which puts the bottom row of a character at pos
+		int destX = static_cast<int>( std::floor( pos.x + 0.5f ) ) - border;
+		int destY = static_cast<int>( std::floor( pos.y + 0.5f ) ) + FONT_CHAR_HEIGHT - 1 + border;
+		BlendColour tint{ pix.a / 255.0f, pix.r / 255.0f, pix.g / 255.0f, pix.b / 255.0f };
 
-		int sourceX = ( ( c - 0x30 ) % 16 ) * FONT_CHAR_WIDTH;
-		int sourceY = ( ( c - 0x30 ) / 16 ) * FONT_CHAR_HEIGHT;
+		int top = m_playBuffer.height - destY;
+		Render::ClipRect bounds{ destX, top, destX + ( static_cast<int>( s.length() ) * ( FONT_CHAR_WIDTH + 1 ) ) + ( border * 2 ), top + sheet.height };
+		const Sprite* pSheet = &sheet;
 
-		// Loop over the bounding box of the glyph
-		for( int x = 0; x < FONT_CHAR_WIDTH; x++ )
+		SubmitDrawing( bounds, [=]
 		{
-			for( int y = 0; y < FONT_CHAR_HEIGHT; y++ )
+			int height = Render::m_pRenderTarget->height;
+			DrawWithBlendMode( [&]( auto policy, bool preMultiply )
 			{
-				if( m_pDebugFontBuffer[( ( sourceY + y ) * FONT_IMAGE_WIDTH ) + ( sourceX + x )] > 0 )
-					DrawPixel( { pos.x + x, pos.y + (FONT_CHAR_HEIGHT - y - 1) }, pix ); 
-			}
-		}
+				int x = destX;
+				for( char c : s )
+				{
+					int glyph = GetDebugGlyph( c );
+					int frameX = glyph % pSheet->hCount;
+					int pixelY = ( glyph / pSheet->hCount ) * pSheet->height;
+
+					if( glyph >= 0 && preMultiply )
+					{
+						const PixelData& pixels = pSheet->preMultAlpha;
+						int frameOffset = ( frameX * pSheet->width ) + ( pixels.width * pixelY );
+						int spanRow = frameX + ( pSheet->preMultSpans.framesPerRow * pixelY );
+						Render::BlitPixels< decltype( policy ) >( pixels, frameOffset, x, destY, pSheet->width, pSheet->height, tint, &pSheet->preMultSpans, spanRow );
+					}
+					else if( glyph >= 0 )
+					{
+						// A colour only tints the parts of a sprite which multiply blending leaves uncovered, so the solid runs of
+						// > each row are filled with the text colour instead (the same as drawing each pixel with DrawPixel)
+						const PixelData& canvas = pSheet->canvasBuffer;
+						for( int row = 0; row < pSheet->height; row++ )
+						{
+							const Pixel* pRow = &canvas.pPixels[( ( pixelY + row ) * canvas.width ) + ( frameX * pSheet->width )];
+							for( int start = 0; start < pSheet->width; )
+							{
+								if( pRow[start].a == 0 ) { start++; continue; }
+								int end = start;
+								while( end < pSheet->width && pRow[end].a > 0 )
+									end++;
+								Render::FillSpan< decltype( policy ) >( height - destY + row, x + start, x + end, pix, false );
+								start = end;
+							}
+						}
+					}
+					x += FONT_CHAR_WIDTH + 1;
+				}
+			} );
+		} );
+	}
+
+	int DrawDebugCharacter( Point2f pos, char c, Pixel pix )
+	{
+		ASSERT_GRAPHICS;
+		if( m_pDebugFontBuffer == nullptr )
+			DecompressDubugFont();
+
+		if( GetDebugGlyph( c ) >= 0 )
+			DrawDebugGlyphs( m_debugFontGlyphs, 0, pos, std::string( 1, c ), pix );
 		return FONT_CHAR_WIDTH;
 	}
 
@@ -4089,11 +9432,32 @@ namespace Play::Graphics
 
 		pos.y -= 6; // half the height of the debug font
 
-		for( char c : s )
-			pos.x += DrawDebugCharacter( pos, static_cast<char>( toupper( c ) ), pix ) + 1;
+		std::string upper = s;
+		std::transform( upper.begin(), upper.end(), upper.begin(), []( char c ) { return static_cast<char>( toupper( c ) ); } );
+		DrawDebugGlyphs( m_debugFontGlyphs, 0, pos, upper, pix );
 
 		// Return horizontal position at the end of the string so strings can be concatenated easily
-		return static_cast<int>( pos.x );
+		return static_cast<int>( pos.x ) + GetDebugStringWidth( s );
+	}
+
+	int DrawDebugStringOutlined( Point2f pos, const std::string& s, Pixel pix, Pixel outlinePix, bool centred )
+	{
+		ASSERT_GRAPHICS;
+
+		if( m_pDebugFontBuffer == nullptr )
+			DecompressDubugFont();
+
+		if( centred )
+			pos.x -= GetDebugStringWidth( s ) / 2;
+
+		pos.y -= 6; // half the height of the debug font
+
+		std::string upper = s;
+		std::transform( upper.begin(), upper.end(), upper.begin(), []( char c ) { return static_cast<char>( toupper( c ) ); } );
+		DrawDebugGlyphs( m_debugFontOutlines, 1, pos, upper, outlinePix );
+		DrawDebugGlyphs( m_debugFontGlyphs, 0, pos, upper, pix );
+
+		return static_cast<int>( pos.x ) + GetDebugStringWidth( s );
 	}
 
 	int GetDebugStringWidth( const std::string& s )
@@ -4108,9 +9472,39 @@ namespace Play::Graphics
 	PixelData* GetDrawingBuffer(void) 
 	{ 
 		ASSERT_GRAPHICS;
+		FlushDrawing();
+
+		// The caller could write anywhere in the buffer
+		if( m_bDirtyTracking )
+		{
+			for( uint8_t& tile : m_vDirtyTiles )
+				tile |= DIRTY_DRAWN | DIRTY_CHANGED;
+		}
 		return &m_playBuffer; 
 	}
 
+	void ClearBuffer( Pixel colour )
+	{
+		ASSERT_GRAPHICS;
+		auto clear = [=] { Render::ClearRenderTarget( colour ); };
+
+		if( IsQueueing() )
+		{
+			DrawQueueBarrier( [=] { ClearBuffer( colour ); } );
+			return;
+		}
+
+		if( CanClearDrawnTiles() && m_clearState == ClearState::COLOUR && m_clearColour.bits == colour.bits )
+		{
+			RestoreDrawnTiles( clear );
+			return;
+		}
+
+		SubmitDrawing( Render::ClipRect(), clear );
+		if( CanClearDrawnTiles() )
+			SetClearState( ClearState::COLOUR, colour, -1 );
+	}
+
 	LARGE_INTEGER EndTimingSegment()
 	{
 		ASSERT_GRAPHICS;
@@ -4673,9 +10067,9 @@ namespace Play
 	// Manager creation and deletion
 	//**************************************************************************************************
 
-	void CreateManager( int displayWidth, int displayHeight, int displayScale )
+	void CreateManager( int displayWidth, int displayHeight, int displayScale, PixelFormat format )
 	{
-		Play::Graphics::CreateManager( displayWidth, displayHeight, "Data\\Sprites\\" );
+		Play::Graphics::CreateManager( displayWidth, displayHeight, "Data\\Sprites\\", format );
 		Play::Window::CreateManager( Play::Graphics::GetDrawingBuffer(), displayScale );
 		Play::Window::RegisterMouse( Play::Input::CreateManager() );
 		Play::Audio::CreateManager( "Data\\Audio\\" );
@@ -4726,11 +10120,7 @@ namespace Play
 			int textX = 10;
 			int textY = 10;
 			std::string s = "PlayBuffer Version:" + std::string( PLAY_VERSION );
-			Play::Graphics::DrawDebugString( { textX - 1, textY - 1 }, s, PIX_BLACK, false );
-			Play::Graphics::DrawDebugString( { textX + 1, textY + 1 }, s, PIX_BLACK, false );
-			Play::Graphics::DrawDebugString( { textX + 1, textY - 1 }, s, PIX_BLACK, false );
-			Play::Graphics::DrawDebugString( { textX - 1, textY + 1 }, s, PIX_BLACK, false );
-			Play::Graphics::DrawDebugString( { textX, textY }, s, PIX_YELLOW, false );
+			Play::Graphics::DrawDebugStringOutlined( { textX, textY }, s, PIX_YELLOW, PIX_BLACK, false );
 
 			drawSpace = DrawingSpace::WORLD;
 
@@ -4739,7 +10129,21 @@ namespace Play
 #endif
 		}
 
-		Play::Window::Present();
+		Play::Graphics::FlushDrawing();
+		if( Play::Graphics::IsDirtyTracking() )
+		{
+			static std::vector< Play::Render::ClipRect > vChanged;
+			static std::vector< RECT > vRects;
+			Play::Graphics::GetChangedRects( vChanged );
+			vRects.clear();
+			for( const Play::Render::ClipRect& r : vChanged )
+				vRects.push_back( { r.left, r.top, r.right, r.bottom } );
+			Play::Window::PresentRects( vRects.data(), static_cast<int>( vRects.size() ) );
+		}
+		else
+		{
+			Play::Window::Present();
+		}
 		frameCount++;
 
 		drawSpace = originalDrawSpace;
@@ -4803,14 +10207,14 @@ namespace Play
 		Play::Graphics::SetSpriteOrigin( spriteId, { xOrigin, yOrigin } ); 
 	}
 	
-	void DrawSpriteTransparent(const char* spriteName, Point2D pos, int frameIndex, float opacity, Colour colour)
+	void DrawSpriteTransparent(const char* spriteName, Point2D pos, int frameIndex, float opacity, Colour colour, int flip)
 	{
-		Graphics::DrawTransparent(Graphics::GetSpriteId(spriteName), TRANSFORM_SPACE(pos), frameIndex, { opacity, colour.red / 100.0f, colour.green / 100.0f, colour.blue / 100.0f });
+		Graphics::DrawTransparent(Graphics::GetSpriteId(spriteName), TRANSFORM_SPACE(pos), frameIndex, { opacity, colour.red / 100.0f, colour.green / 100.0f, colour.blue / 100.0f }, flip);
 	}
 
-	void DrawSpriteTransparent(int spriteID, Point2D pos, int frameIndex, float opacity, Colour colour)
+	void DrawSpriteTransparent(int spriteID, Point2D pos, int frameIndex, float opacity, Colour colour, int flip)
 	{
-		Graphics::DrawTransparent(spriteID, TRANSFORM_SPACE(pos), frameIndex, { opacity, colour.red / 100.0f, colour.green / 100.0f, colour.blue / 100.0f } );
+		Graphics::DrawTransparent(spriteID, TRANSFORM_SPACE(pos), frameIndex, { opacity, colour.red / 100.0f, colour.green / 100.0f, colour.blue / 100.0f }, flip );
 	}
 
 	void DrawSpriteRotated( const char* spriteName, Point2D pos, int frameIndex, float angle, float scale, float opacity, Colour colour)
@@ -4833,9 +10237,14 @@ namespace Play
 		return Play::Graphics::DrawLine( TRANSFORM_SPACE( start), TRANSFORM_SPACE( end ), { c.red * 2.55f, c.green * 2.55f, c.blue * 2.55f }  );
 	}
 
-	void DrawCircle( Point2D pos, int radius, Colour c )
+	void DrawThickLine( Point2D start, Point2D end, float thickness, Colour c )
+	{
+		Play::Graphics::DrawThickLine( TRANSFORM_SPACE( start ), TRANSFORM_SPACE( end ), thickness, { c.red * 2.55f, c.green * 2.55f, c.blue * 2.55f } );
+	}
+
+	void DrawCircle( Point2D pos, int radius, Colour c, bool fill )
 	{
-		Play::Graphics::DrawCircle( TRANSFORM_SPACE( pos ), radius, { c.red * 2.55f, c.green * 2.55f, c.blue * 2.55f } );
+		Play::Graphics::DrawCircle( TRANSFORM_SPACE( pos ), radius, { c.red * 2.55f, c.green * 2.55f, c.blue * 2.55f }, fill );
 	}
 
 	void DrawRect(  Point2D bottomLeft, Point2D topRight, Colour c, bool fill )
@@ -4929,14 +10338,11 @@ namespace Play
 		}
 	};
 
-	void DrawFontText( const char* fontId, std::string text, Point2D pos, Align justify )
+	void DrawFontText( const char* fontId, std::string_view text, Point2D pos, Align justify )
 	{
 		int font = Play::Graphics::GetSpriteId( fontId );
 
-		int totalWidth{ 0 };
-
-		for( char c : text )
-			totalWidth += Play::Graphics::GetFontCharWidth( font, c );
+		int totalWidth = Play::Graphics::GetStringWidth( font, text );
 
 		switch( justify )
 		{